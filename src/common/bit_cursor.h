@@ -17,14 +17,21 @@
 
 #include "common/common_pch.h"
 
+#include "common/bswap.h"
 #include "common/mm_io_x.h"
 
+// The reader keeps up to 64 bits in a cache whose most significant
+// bit is the next bit in the stream. The cache is refilled with
+// whole bytes, eight of them at once while enough data is left. Bits
+// below the valid ones may contain the following stream bits already
+// and are simply OR'ed again on the next refill.
 class bit_reader_c {
 private:
   const unsigned char *m_end_of_data;
-  const unsigned char *m_byte_position;
+  const unsigned char *m_next_byte;
   const unsigned char *m_start_of_data;
-  std::size_t m_bits_valid;
+  uint64_t m_cache;
+  std::size_t m_cache_bits;
   bool m_out_of_data;
 
 public:
@@ -34,10 +41,11 @@ public:
 
   void init(const unsigned char *data, std::size_t len) {
     m_end_of_data   = data + len;
-    m_byte_position = data;
+    m_next_byte     = data;
     m_start_of_data = data;
-    m_bits_valid    = len ? 8 : 0;
-    m_out_of_data   = m_byte_position >= m_end_of_data;
+    m_cache         = 0;
+    m_cache_bits    = 0;
+    m_out_of_data   = !len;
   }
 
   bool eof() {
@@ -45,35 +53,15 @@ public:
   }
 
   uint64_t get_bits(std::size_t n) {
-    uint64_t r = 0;
-
-    while (n > 0) {
-      if (m_byte_position >= m_end_of_data) {
-        m_out_of_data = true;
-        throw mtx::mm_io::end_of_file_x();
-      }
-
-      std::size_t b = 8; // number of bits to extract from the current byte
-      if (b > n)
-        b = n;
-      if (b > m_bits_valid)
-        b = m_bits_valid;
-
-      std::size_t rshift = m_bits_valid - b;
-
-      r <<= b;
-      r  |= ((*m_byte_position) >> rshift) & (0xff >> (8 - b));
-
-      m_bits_valid -= b;
-      if (0 == m_bits_valid) {
-        m_bits_valid     = 8;
-        m_byte_position += 1;
-      }
-
-      n -= b;
+    if (n > 56) {
+      auto upper = get_bits(n - 32);
+      return (upper << 32) | get_bits(32);
     }
 
-    return r;
+    if (!ensure_bits(n))
+      throw_end_of_file();
+
+    return consume_bits(n);
   }
 
   inline int get_bit() {
@@ -97,14 +85,17 @@ public:
   }
 
   inline int get_unsigned_golomb() {
-    int n = 0, bit;
+    // A code with n leading zeros is 2n + 1 bits long. Codes that fit
+    // into the cache are decoded with a single count of leading zeros.
+    ensure_bits(32);
 
-    while ((bit = get_bit()) == 0)
-      ++n;
+    auto leading_zeros = count_leading_zeros(m_cache);
+    auto code_length   = 2 * leading_zeros + 1;
 
-    bit = get_bits(n);
+    if (code_length <= m_cache_bits)
+      return consume_bits(code_length) - 1;
 
-    return (1 << n) - 1 + bit;
+    return get_unsigned_golomb_bitwise();
   }
 
   inline int get_signed_golomb() {
@@ -113,78 +104,94 @@ public:
   }
 
   uint64_t peek_bits(std::size_t n) {
-    uint64_t r                             = 0;
-    const unsigned char *tmp_byte_position = m_byte_position;
-    std::size_t tmp_bits_valid                  = m_bits_valid;
+    if (n > 56) {
+      auto cache = m_cache, cache_bits = m_cache_bits;
+      auto next_byte   = m_next_byte;
+      auto out_of_data = m_out_of_data;
 
-    while (0 < n) {
-      if (tmp_byte_position >= m_end_of_data)
-        throw mtx::mm_io::end_of_file_x();
+      try {
+        auto value = get_bits(n);
 
-      std::size_t b = 8; // number of bits to extract from the current byte
-      if (b > n)
-        b = n;
-      if (b > tmp_bits_valid)
-        b = tmp_bits_valid;
+        m_cache       = cache;
+        m_cache_bits  = cache_bits;
+        m_next_byte   = next_byte;
+        m_out_of_data = out_of_data;
 
-      std::size_t rshift = tmp_bits_valid - b;
+        return value;
 
-      r <<= b;
-      r  |= ((*tmp_byte_position) >> rshift) & (0xff >> (8 - b));
+      } catch (mtx::mm_io::end_of_file_x &) {
+        m_cache       = cache;
+        m_cache_bits  = cache_bits;
+        m_next_byte   = next_byte;
+        m_out_of_data = out_of_data;
 
-      tmp_bits_valid -= b;
-      if (0 == tmp_bits_valid) {
-        tmp_bits_valid     = 8;
-        tmp_byte_position += 1;
+        throw;
       }
-
-      n -= b;
     }
 
-    return r;
+    if (!ensure_bits(n))
+      throw mtx::mm_io::end_of_file_x();
+
+    return n ? m_cache >> (64 - n) : 0;
   }
 
   void get_bytes(unsigned char *buf, std::size_t n) {
-    if (8 == m_bits_valid) {
-      get_bytes_byte_aligned(buf, n);
+    if (m_cache_bits % 8) {
+      for (auto idx = 0u; idx < n; ++idx)
+        buf[idx] = get_bits(8);
       return;
     }
 
-    for (auto idx = 0u; idx < n; ++idx)
-      buf[idx] = get_bits(8);
+    while (n && m_cache_bits) {
+      *buf++ = consume_bits(8);
+      --n;
+    }
+
+    if (n)
+      get_bytes_byte_aligned(buf, n);
   }
 
   void byte_align() {
-    if (8 != m_bits_valid)
-      skip_bits(m_bits_valid);
+    skip_cached_bits(m_cache_bits % 8);
   }
 
   void set_bit_position(std::size_t pos) {
     if (pos > (static_cast<std::size_t>(m_end_of_data - m_start_of_data) * 8)) {
-      m_byte_position = m_end_of_data;
-      m_out_of_data   = true;
+      m_next_byte   = m_end_of_data;
+      m_cache       = 0;
+      m_cache_bits  = 0;
+      m_out_of_data = true;
 
       throw mtx::mm_io::end_of_file_x();
     }
 
-    m_byte_position = m_start_of_data + (pos / 8);
-    m_bits_valid    = 8 - (pos % 8);
+    m_next_byte  = m_start_of_data + (pos / 8);
+    m_cache      = 0;
+    m_cache_bits = 0;
+
+    if (pos % 8) {
+      refill();
+      skip_cached_bits(pos % 8);
+    }
   }
 
   int get_bit_position() const {
-    return (m_byte_position - m_start_of_data) * 8 + 8 - m_bits_valid;
+    return (m_next_byte - m_start_of_data) * 8 - m_cache_bits;
   }
 
   int get_remaining_bits() const {
-    return (m_end_of_data - m_byte_position) * 8 - 8 + m_bits_valid;
+    return (m_end_of_data - m_next_byte) * 8 + m_cache_bits;
   }
 
   void skip_bits(std::size_t num) {
-    set_bit_position(get_bit_position() + num);
+    if (num < m_cache_bits)
+      skip_cached_bits(num);
+    else
+      set_bit_position(get_bit_position() + num);
   }
 
   void skip_bit() {
-    set_bit_position(get_bit_position() + 1);
+    skip_bits(1);
   }
 
   uint64_t skip_get_bits(std::size_t to_skip,
@@ -194,11 +201,99 @@ public:
   }
 
 protected:
+  void refill() {
+    if ((m_end_of_data - m_next_byte) >= 8) {
+      uint64_t value;
+      std::memcpy(&value, m_next_byte, sizeof(value));
+#if defined(ARCH_LITTLEENDIAN) && defined(__GNUC__)
+      value = __builtin_bswap64(value);
+#elif defined(ARCH_LITTLEENDIAN)
+      value = mtx::bswap_64(value);
+#endif
+
+      m_cache      |= value >> m_cache_bits;
+      m_next_byte  += (63 - m_cache_bits) / 8;
+      m_cache_bits |= 56;
+
+      return;
+    }
+
+    while ((m_cache_bits <= 56) && (m_next_byte < m_end_of_data)) {
+      m_cache      |= static_cast<uint64_t>(*m_next_byte) << (56 - m_cache_bits);
+      m_next_byte  += 1;
+      m_cache_bits += 8;
+    }
+  }
+
+  // Returns whether or not at least n <= 56 bits are available.
+  bool ensure_bits(std::size_t n) {
+    if (m_cache_bits < n)
+      refill();
+
+    return m_cache_bits >= n;
+  }
+
+  uint64_t consume_bits(std::size_t n) {
+    if (!n)
+      return 0;
+
+    auto value    = m_cache >> (64 - n);
+    m_cache     <<= n;
+    m_cache_bits -= n;
+
+    return value;
+  }
+
+  void skip_cached_bits(std::size_t n) {
+    if (!n)
+      return;
+
+    m_cache     <<= n;
+    m_cache_bits -= n;
+  }
+
+  int get_unsigned_golomb_bitwise() {
+    int n = 0, bit;
+
+    while ((bit = get_bit()) == 0)
+      ++n;
+
+    bit = get_bits(n);
+
+    return (1 << n) - 1 + bit;
+  }
+
+  void throw_end_of_file() {
+    m_next_byte   = m_end_of_data;
+    m_cache       = 0;
+    m_cache_bits  = 0;
+    m_out_of_data = true;
+
+    throw mtx::mm_io::end_of_file_x();
+  }
+
+  static std::size_t count_leading_zeros(uint64_t value) {
+    if (!value)
+      return 64;
+
+#if defined(__GNUC__)
+    return __builtin_clzll(value);
+#else
+    std::size_t num = 0;
+    while (!(value & 0x8000000000000000ull)) {
+      value <<= 1;
+      ++num;
+    }
+    return num;
+#endif
+  }
+
   void get_bytes_byte_aligned(unsigned char *buf, std::size_t n) {
-    auto bytes_to_copy = std::min<std::size_t>(n, m_end_of_data - m_byte_position);
-    std::memcpy(buf, m_byte_position, bytes_to_copy);
+    auto bytes_to_copy = std::min<std::size_t>(n, m_end_of_data - m_next_byte);
+    std::memcpy(buf, m_next_byte, bytes_to_copy);
 
-    m_byte_position += bytes_to_copy;
+    m_next_byte += bytes_to_copy;
+    m_cache      = 0;
 
     if (bytes_to_copy < n) {
       m_out_of_data = true;
@@ -16,12 +16,155 @@
 
 #include "common/common_pch.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define MTX_CRC32_PCLMUL
+# include <immintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+# define MTX_CRC32_ARMV8
+# include <arm_acle.h>
+#endif
+
 #include "common/bswap.h"
 #include "common/checksums/crc.h"
 #include "common/endian.h"
 
 namespace mtx { namespace checksum {
 
+namespace {
+
+inline uint32_t
+load_uint32_le(unsigned char const *buffer) {
+  uint32_t value;
+  std::memcpy(&value, buffer, sizeof(value));
+
+#if defined(ARCH_BIGENDIAN)
+  return mtx::bswap_32(value);
+#else
+  return value;
+#endif
+}
+
+#if defined(MTX_CRC32_PCLMUL)
+
+bool
+pclmul_available() {
+  static bool const s_available = []() -> bool {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+  }();
+
+  return s_available;
+}
+
+__attribute__((target("pclmul,sse4.1")))
+inline __m128i
+load_m128i(unsigned char const *buffer) {
+  return _mm_loadu_si128(reinterpret_cast<__m128i const *>(buffer));
+}
+
+// Folds the 128 bits in 'x' onto 'next' with the constants in 'k'.
+__attribute__((target("pclmul,sse4.1")))
+inline __m128i
+fold_m128i(__m128i x,
+           __m128i next,
+           __m128i k) {
+  return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x11), next), _mm_clmulepi64_si128(x, k, 0x00));
+}
+
+// Folds 64 bytes at a time with carry-less multiplications, then
+// reduces the result to 32 bits with Barrett's method. See Intel's
+// white paper "Fast CRC Computation for Generic Polynomials Using
+// PCLMULQDQ Instruction". The constants are the ones for the
+// bit-reflected IEEE polynomial. 'size' must be a multiple of 16 and
+// at least 64.
+__attribute__((target("pclmul,sse4.1")))
+uint32_t
+crc32_ieee_le_pclmul(uint32_t crc,
+                     unsigned char const *buffer,
+                     size_t size) {
+  alignas(16) static uint64_t const s_k1k2[] = { 0x0154442bd4, 0x01c6e41596 };
+  alignas(16) static uint64_t const s_k3k4[] = { 0x01751997d0, 0x00ccaa009e };
+  alignas(16) static uint64_t const s_k5k0[] = { 0x0163cd6124, 0x0000000000 };
+  alignas(16) static uint64_t const s_poly[] = { 0x01db710641, 0x01f7011641 };
+
+  auto x1   = _mm_xor_si128(load_m128i(buffer), _mm_cvtsi32_si128(crc));
+  auto x2   = load_m128i(buffer + 0x10);
+  auto x3   = load_m128i(buffer + 0x20);
+  auto x4   = load_m128i(buffer + 0x30);
+  auto x0   = _mm_load_si128(reinterpret_cast<__m128i const *>(s_k1k2));
+
+  buffer   += 64;
+  size     -= 64;
+
+  // Fold four 128-bit lanes in parallel.
+  while (size >= 64) {
+    x1      = fold_m128i(x1, load_m128i(buffer + 0x00), x0);
+    x2      = fold_m128i(x2, load_m128i(buffer + 0x10), x0);
+    x3      = fold_m128i(x3, load_m128i(buffer + 0x20), x0);
+    x4      = fold_m128i(x4, load_m128i(buffer + 0x30), x0);
+
+    buffer += 64;
+    size   -= 64;
+  }
+
+  // Fold the four lanes into one, then the remaining 16-byte blocks.
+  x0 = _mm_load_si128(reinterpret_cast<__m128i const *>(s_k3k4));
+
+  x1 = fold_m128i(x1, x2, x0);
+  x1 = fold_m128i(x1, x3, x0);
+  x1 = fold_m128i(x1, x4, x0);
+
+  while (size >= 16) {
+    x1      = fold_m128i(x1, load_m128i(buffer), x0);
+    buffer += 16;
+    size   -= 16;
+  }
+
+  // Fold 128 bits to 64 bits.
+  x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+  x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+  x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+  x0 = _mm_loadl_epi64(reinterpret_cast<__m128i const *>(s_k5k0));
+  x2 = _mm_srli_si128(x1, 4);
+  x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, x3), x0, 0x00), x2);
+
+  // Barrett reduction to 32 bits.
+  x0 = _mm_load_si128(reinterpret_cast<__m128i const *>(s_poly));
+  x2 = _mm_and_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, x3), x0, 0x10), x3);
+  x1 = _mm_xor_si128(x1, _mm_clmulepi64_si128(x2, x0, 0x00));
+
+  return _mm_extract_epi32(x1, 1);
+}
+
+#elif defined(MTX_CRC32_ARMV8)
+
+// The ARMv8 CRC32 instructions implement the bit-reflected IEEE
+// polynomial without pre- or post-inversion, just like the table
+// based code.
+uint32_t
+crc32_ieee_le_armv8(uint32_t crc,
+                    unsigned char const *buffer,
+                    size_t size) {
+  for (; size && (reinterpret_cast<uintptr_t>(buffer) & 7); --size)
+    crc = __crc32b(crc, *buffer++);
+
+  for (; size >= 8; size -= 8, buffer += 8) {
+    uint64_t value;
+    std::memcpy(&value, buffer, sizeof(value));
+    crc = __crc32d(crc, value);
+  }
+
+  for (; size; --size)
+    crc = __crc32b(crc, *buffer++);
+
+  return crc;
+}
+
+#endif
+
+} // anonymous namespace
+
 crc_base_c::table_parameters_t const crc_base_c::ms_table_parameters[5] = {
   { 0,  8,       0x07 },
   { 0, 16,     0x8005 },
@@ -31,16 +174,13 @@ crc_base_c::table_parameters_t const crc_base_c::ms_table_parameters[5] = {
 };
 
 crc_base_c::crc_base_c(type_e type,
-                       table_t &table,
                        uint32_t crc)
   : m_type{type}
-  , m_table(table)              // No initializer-list syntax here due to gcc bug 50025.
+  , m_table(get_table(type))    // No initializer-list syntax here due to gcc bug 50025.
   , m_crc{crc}
   , m_xor_result{}
   , m_result_in_le{}
 {
-  if (m_table.empty())
-    init_table();
 }
 
 crc_base_c::~crc_base_c() {
@@ -50,33 +190,55 @@ crc_base_c::~crc_base_c() {
 #pragma warning(disable:4146)	//unary minus operator applied to unsigned type, result still unsigned
 #endif
 
-void
-crc_base_c::init_table() {
-  auto &parameters = ms_table_parameters[m_type];
+crc_base_c::table_t const &
+crc_base_c::get_table(type_e type) {
+  // Function-local statics are initialized thread-safely, and only the
+  // tables for types actually used are created.
+  switch (type) {
+    case crc_8_atm:      { static auto const s_table = create_table(crc_8_atm);      return s_table; }
+    case crc_16_ansi:    { static auto const s_table = create_table(crc_16_ansi);    return s_table; }
+    case crc_16_ccitt:   { static auto const s_table = create_table(crc_16_ccitt);   return s_table; }
+    case crc_32_ieee:    { static auto const s_table = create_table(crc_32_ieee);    return s_table; }
+    default:             { static auto const s_table = create_table(crc_32_ieee_le); return s_table; }
+  }
+}
+
+crc_base_c::table_t
+crc_base_c::create_table(type_e type) {
+  auto &parameters = ms_table_parameters[type];
 
   if ((parameters.bits < 8) || (parameters.bits > 32) || (parameters.poly >= (1LL<<parameters.bits)))
     throw std::domain_error{"Invalid CRC parameters"};
 
-  m_table.resize(256);
+  table_t table(256 * ms_num_slices);
 
   for (auto i = 0u; i < 256u; i++) {
     if (parameters.le) {
       uint32_t c = i;
       for (auto j = 0u; j < 8u; j++)
         c = (c >> 1) ^ (parameters.poly & (-(c & 1)));
-      m_table[i] = c;
+      table[i] = c;
 
     } else {
       uint32_t c = i << 24;
       for (auto j = 0u; j < 8u; j++)
         c = (c << 1) ^ ((parameters.poly << (32 - parameters.bits)) & (static_cast<int32_t>(c) >> 31));
-      m_table[i] = mtx::bswap_32(c);
+      table[i] = mtx::bswap_32(c);
     }
   }
 
+  // Table n contains the CRC for a byte followed by n zero bytes.
+  for (auto slice = 1u; slice < ms_num_slices; ++slice)
+    for (auto i = 0u; i < 256u; i++) {
+      auto previous          = table[(slice - 1) * 256 + i];
+      table[slice * 256 + i] = (previous >> 8) ^ table[previous & 0xff];
+    }
+
   // for (auto row = 0u; row < (256u / 4); ++row)
   //   mxinfo(boost::format("0x%|1$08x| 0x%|2$08x| 0x%|3$08x| 0x%|4$08x|\n")
-  //          % m_table[row * 4 + 0] % m_table[row * 4 + 1] % m_table[row * 4 + 2] % m_table[row * 4 + 3]);
+  //          % table[row * 4 + 0] % table[row * 4 + 1] % table[row * 4 + 2] % table[row * 4 + 3]);
+
+  return table;
 }
 
 memory_cptr
@@ -124,23 +286,45 @@ crc_base_c::set_result_in_le(bool result_in_le) {
   m_result_in_le = result_in_le;
 }
 
+// Processes 16 bytes per iteration with one table lookup per byte
+// ("slice-by-16"). This works for all CRC widths as the CRC is kept
+// in a byte-reflected representation.
 void
 crc_base_c::add_impl(unsigned char const *buffer,
                      size_t size) {
-  auto end = buffer + size;
+  auto t   = m_table.data();
+  auto crc = m_crc;
+
+  for (; size >= 16; size -= 16, buffer += 16) {
+    auto w0 = load_uint32_le(buffer) ^ crc;
+    auto w1 = load_uint32_le(buffer +  4);
+    auto w2 = load_uint32_le(buffer +  8);
+    auto w3 = load_uint32_le(buffer + 12);
+
+    crc     = t[15 * 256 + (w0 & 0xff)] ^ t[14 * 256 + ((w0 >> 8) & 0xff)] ^ t[13 * 256 + ((w0 >> 16) & 0xff)] ^ t[12 * 256 + (w0 >> 24)]
+            ^ t[11 * 256 + (w1 & 0xff)] ^ t[10 * 256 + ((w1 >> 8) & 0xff)] ^ t[ 9 * 256 + ((w1 >> 16) & 0xff)] ^ t[ 8 * 256 + (w1 >> 24)]
+            ^ t[ 7 * 256 + (w2 & 0xff)] ^ t[ 6 * 256 + ((w2 >> 8) & 0xff)] ^ t[ 5 * 256 + ((w2 >> 16) & 0xff)] ^ t[ 4 * 256 + (w2 >> 24)]
+            ^ t[ 3 * 256 + (w3 & 0xff)] ^ t[ 2 * 256 + ((w3 >> 8) & 0xff)] ^ t[ 1 * 256 + ((w3 >> 16) & 0xff)] ^ t[ 0 * 256 + (w3 >> 24)];
+  }
+
+  for (; size >= 8; size -= 8, buffer += 8) {
+    auto w0 = load_uint32_le(buffer) ^ crc;
+    auto w1 = load_uint32_le(buffer + 4);
 
-  while (buffer < end) {
-    m_crc = m_table[(m_crc & 0xff) ^ *buffer] ^ (m_crc >> 8);
-    ++buffer;
+    crc     = t[ 7 * 256 + (w0 & 0xff)] ^ t[ 6 * 256 + ((w0 >> 8) & 0xff)] ^ t[ 5 * 256 + ((w0 >> 16) & 0xff)] ^ t[ 4 * 256 + (w0 >> 24)]
+            ^ t[ 3 * 256 + (w1 & 0xff)] ^ t[ 2 * 256 + ((w1 >> 8) & 0xff)] ^ t[ 1 * 256 + ((w1 >> 16) & 0xff)] ^ t[ 0 * 256 + (w1 >> 24)];
   }
+
+  for (; size; --size, ++buffer)
+    crc = t[(crc & 0xff) ^ *buffer] ^ (crc >> 8);
+
+  m_crc = crc;
 }
 
 // ----------------------------------------------------------------------
 
-crc_base_c::table_t crc8_atm_c::ms_table;
-
 crc8_atm_c::crc8_atm_c(uint32_t initial_value)
-  : crc_base_c{crc_8_atm, ms_table, initial_value}
+  : crc_base_c{crc_8_atm, initial_value}
 {
 }
 
@@ -149,10 +333,8 @@ crc8_atm_c::~crc8_atm_c() {
 
 // ----------------------------------------------------------------------
 
-crc_base_c::table_t crc16_ansi_c::ms_table;
-
 crc16_ansi_c::crc16_ansi_c(uint32_t initial_value)
-  : crc_base_c{crc_16_ansi, ms_table, initial_value}
+  : crc_base_c{crc_16_ansi, initial_value}
 {
 }
 
@@ -161,10 +343,8 @@ crc16_ansi_c::~crc16_ansi_c() {
 
 // ----------------------------------------------------------------------
 
-crc_base_c::table_t crc16_ccitt_c::ms_table;
-
 crc16_ccitt_c::crc16_ccitt_c(uint32_t initial_value)
-  : crc_base_c{crc_16_ccitt, ms_table, initial_value}
+  : crc_base_c{crc_16_ccitt, initial_value}
 {
 }
 
@@ -173,10 +353,8 @@ crc16_ccitt_c::~crc16_ccitt_c() {
 
 // ----------------------------------------------------------------------
 
-crc_base_c::table_t crc32_ieee_c::ms_table;
-
 crc32_ieee_c::crc32_ieee_c(uint32_t initial_value)
-  : crc_base_c{crc_32_ieee, ms_table, initial_value}
+  : crc_base_c{crc_32_ieee, initial_value}
 {
 }
 
@@ -185,14 +363,31 @@ crc32_ieee_c::~crc32_ieee_c() {
 
 // ----------------------------------------------------------------------
 
-crc_base_c::table_t crc32_ieee_le_c::ms_table;
-
 crc32_ieee_le_c::crc32_ieee_le_c(uint32_t initial_value)
-  : crc_base_c{crc_32_ieee_le, ms_table, initial_value}
+  : crc_base_c{crc_32_ieee_le, initial_value}
 {
 }
 
 crc32_ieee_le_c::~crc32_ieee_le_c() {
 }
 
+void
+crc32_ieee_le_c::add_impl(unsigned char const *buffer,
+                          size_t size) {
+#if defined(MTX_CRC32_PCLMUL)
+  if ((size >= 64) && pclmul_available()) {
+    auto to_fold = size & ~static_cast<size_t>(15);
+    m_crc        = crc32_ieee_le_pclmul(m_crc, buffer, to_fold);
+    buffer      += to_fold;
+    size        -= to_fold;
+  }
+
+#elif defined(MTX_CRC32_ARMV8)
+  m_crc = crc32_ieee_le_armv8(m_crc, buffer, size);
+  return;
+#endif
+
+  crc_base_c::add_impl(buffer, size);
+}
+
 }} // namespace mtx { namespace checksum {
@@ -30,8 +30,12 @@ protected:
     crc_32_ieee_le = 4,
   };
 
+  // Slice-by-16 tables: 16 tables with 256 entries each. The first
+  // one is the classic byte-at-a-time table.
   using table_t = std::vector<uint32_t>;
 
+  static size_t const ms_num_slices = 16;
+
   struct table_parameters_t {
     uint8_t  le;
     uint8_t  bits;
@@ -42,15 +46,16 @@ protected:
 
 protected:
   type_e m_type;
-  table_t &m_table;
+  table_t const &m_table;
   uint32_t m_crc;
   uint64_t m_xor_result;
   bool m_result_in_le;
 
 protected:
-  crc_base_c(type_e type, table_t &table, uint32_t crc);
+  crc_base_c(type_e type, uint32_t crc);
 
-  void init_table();
+  static table_t const &get_table(type_e type);
+  static table_t create_table(type_e type);
 
 public:
   virtual ~crc_base_c();
@@ -69,48 +74,36 @@ protected:
 };
 
 class crc8_atm_c: public crc_base_c {
-protected:
-  static table_t ms_table;
-
 public:
   crc8_atm_c(uint32_t initial_value = 0);
   virtual ~crc8_atm_c();
 };
 
 class crc16_ansi_c: public crc_base_c {
-protected:
-  static table_t ms_table;
-
 public:
   crc16_ansi_c(uint32_t initial_value = 0);
   virtual ~crc16_ansi_c();
 };
 
 class crc16_ccitt_c: public crc_base_c {
-protected:
-  static table_t ms_table;
-
 public:
   crc16_ccitt_c(uint32_t initial_value = 0);
   virtual ~crc16_ccitt_c();
 };
 
 class crc32_ieee_c: public crc_base_c {
-protected:
-  static table_t ms_table;
-
 public:
   crc32_ieee_c(uint32_t initial_value = 0);
   virtual ~crc32_ieee_c();
 };
 
 class crc32_ieee_le_c: public crc_base_c {
-protected:
-  static table_t ms_table;
-
 public:
   crc32_ieee_le_c(uint32_t initial_value = 0);
   virtual ~crc32_ieee_le_c();
+
+protected:
+  virtual void add_impl(unsigned char const *buffer, size_t size);
 };
 
 }} // namespace mtx { namespace checksum {
@@ -13,6 +13,8 @@
 
 #include "common/common_pch.h"
 
+#include <mutex>
+
 #include "common/codec.h"
 #include "common/mp4.h"
 
@@ -21,6 +23,10 @@ codec_c::specialization_map_t codec_c::ms_specialization_descriptions;
 
 void
 codec_c::initialize() {
+  // Identification in batch mode looks up codecs from several threads.
+  static std::mutex s_mutex;
+  std::lock_guard<std::mutex> lock{s_mutex};
+
   if (!ms_codecs.empty())
     return;
   ms_codecs.emplace_back("Bitfields",               type_e::V_BITFIELDS,    track_video,    "", fourcc_c{0x03000000u});
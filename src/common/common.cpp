@@ -168,7 +168,7 @@ set_process_priority(int priority) {
 void
 mtx_common_init(std::string const &program_name,
                 char const *argv0) {
-  g_cc_local_utf8 = charset_converter_c::init("");
+  init_local_charset_converter();
 
   init_common_output(true);
 
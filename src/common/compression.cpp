@@ -57,11 +57,16 @@ compressor_c::set_track_headers(KaxContentEncoding &c_encoding) {
 }
 
 compressor_ptr
-compressor_c::create(compression_method_e method) {
+compressor_c::create(compression_method_e method,
+                     int level) {
   if ((COMPRESSION_UNSPECIFIED >= method) || (COMPRESSION_NUM < method))
     return compressor_ptr();
 
-  return create(compression_methods[method]);
+  auto compressor = create(compression_methods[method]);
+  if (compressor && (0 <= level))
+    compressor->set_compression_level(level);
+
+  return compressor;
 }
 
 compressor_ptr
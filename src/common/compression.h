@@ -80,8 +80,10 @@ public:
   virtual std::string decompress(std::string const &buffer);
 
   virtual void set_track_headers(KaxContentEncoding &c_encoding);
+  virtual void set_compression_level(int) {
+  }
 
-  static compressor_ptr create(compression_method_e method);
+  static compressor_ptr create(compression_method_e method, int level = -1);
   static compressor_ptr create(const char *method);
   static compressor_ptr create_from_file_name(std::string const &file_name);
 
@@ -15,45 +15,79 @@
 
 #include "common/compression/zlib.h"
 
-zlib_compressor_c::zlib_compressor_c()
+zlib_compressor_c::zlib_compressor_c(int level)
   : compressor_c(COMPRESSION_ZLIB)
+  , m_c_stream_initialized{}
+  , m_d_stream_initialized{}
+  , m_level{level}
 {
+  std::memset(&m_c_stream, 0, sizeof(m_c_stream));
+  std::memset(&m_d_stream, 0, sizeof(m_d_stream));
 }
 
 zlib_compressor_c::~zlib_compressor_c() {
+  if (m_c_stream_initialized)
+    deflateEnd(&m_c_stream);
+
+  if (m_d_stream_initialized)
+    inflateEnd(&m_d_stream);
+}
+
+void
+zlib_compressor_c::set_compression_level(int level) {
+  if (level == m_level)
+    return;
+
+  m_level = level;
+
+  if (m_c_stream_initialized) {
+    deflateEnd(&m_c_stream);
+    m_c_stream_initialized = false;
+  }
 }
 
 memory_cptr
 zlib_compressor_c::do_decompress(memory_cptr const &buffer) {
-  z_stream d_stream;
+  int result;
+
+  if (!m_d_stream_initialized) {
+    result = inflateInit2(&m_d_stream, 15 + 32); // 15: window size; 32: look for zlib/gzip headers automatically
+
+    if (Z_OK != result)
+      mxerror(boost::format(Y("inflateInit() failed. Result: %1%\n")) % result);
 
-  d_stream.zalloc = (alloc_func)0;
-  d_stream.zfree  = (free_func)0;
-  d_stream.opaque = (voidpf)0;
-  int result      = inflateInit2(&d_stream, 15 + 32); // 15: window size; 32: look for zlib/gzip headers automatically
+    m_d_stream_initialized = true;
 
-  if (Z_OK != result)
-    mxerror(boost::format(Y("inflateInit() failed. Result: %1%\n")) % result);
+  } else
+    inflateReset(&m_d_stream);
 
-  d_stream.next_in   = reinterpret_cast<Bytef *>(buffer->get_buffer());
-  d_stream.avail_in  = buffer->get_size();
-  int n              = 0;
-  memory_cptr dst    = memory_c::alloc(0);
+  m_d_stream.next_in  = reinterpret_cast<Bytef *>(buffer->get_buffer());
+  m_d_stream.avail_in = buffer->get_size();
+  auto dst            = memory_c::alloc(std::max<size_t>(buffer->get_size() * 4, 4096));
+  auto first_call     = true;
 
   do {
-    n++;
-    dst->resize(n * 4000);
-    d_stream.next_out  = reinterpret_cast<Bytef *>(dst->get_buffer() + (n - 1) * 4000);
-    d_stream.avail_out = 4000;
-    result             = inflate(&d_stream, Z_NO_FLUSH);
+    if (m_d_stream.total_out == dst->get_size())
+      dst->resize(dst->get_size() * 2);
+
+    m_d_stream.next_out  = reinterpret_cast<Bytef *>(dst->get_buffer() + m_d_stream.total_out);
+    m_d_stream.avail_out = dst->get_size() - m_d_stream.total_out;
+    result               = inflate(&m_d_stream, Z_NO_FLUSH);
+
+    // Z_BUF_ERROR after the first call means that the input has been
+    // used up without reaching the stream's end. Return what has been
+    // decompressed so far in that case.
+    if ((Z_BUF_ERROR == result) && !first_call)
+      break;
 
     if ((Z_OK != result) && (Z_STREAM_END != result))
       throw mtx::compression_x(boost::format(Y("Zlib decompression failed. Result: %1%\n")) % result);
 
-  } while ((0 == d_stream.avail_out) && (0 != d_stream.avail_in) && (Z_STREAM_END != result));
+    first_call = false;
+
+  } while ((Z_OK == result) && (0 == m_d_stream.avail_out));
 
-  dst->resize(d_stream.total_out);
-  inflateEnd(&d_stream);
+  dst->resize(m_d_stream.total_out);
 
   mxverb(3, boost::format("zlib_compressor_c: Decompression from %1% to %2%, %3%%%\n") % buffer->get_size() % dst->get_size() % (dst->get_size() * 100 / buffer->get_size()));
 
@@ -62,35 +96,33 @@ zlib_compressor_c::do_decompress(memory_cptr const &buffer) {
 
 memory_cptr
 zlib_compressor_c::do_compress(memory_cptr const &buffer) {
-  z_stream c_stream;
+  int result;
 
-  c_stream.zalloc = (alloc_func)0;
-  c_stream.zfree  = (free_func)0;
-  c_stream.opaque = (voidpf)0;
-  int result      = deflateInit(&c_stream, 9);
+  if (!m_c_stream_initialized) {
+    result = deflateInit(&m_c_stream, m_level);
 
-  if (Z_OK != result)
-    mxerror(boost::format(Y("deflateInit() failed. Result: %1%\n")) % result);
+    if (Z_OK != result)
+      mxerror(boost::format(Y("deflateInit() failed. Result: %1%\n")) % result);
 
-  c_stream.next_in   = (Bytef *)buffer->get_buffer();
-  c_stream.avail_in  = buffer->get_size();
-  int n              = 0;
-  memory_cptr dst    = memory_c::alloc(0);
+    m_c_stream_initialized = true;
 
-  do {
-    n++;
-    dst->resize(n * 4000);
-    c_stream.next_out  = reinterpret_cast<Bytef *>(dst->get_buffer() + (n - 1) * 4000);
-    c_stream.avail_out = 4000;
-    result             = deflate(&c_stream, Z_FINISH);
+  } else
+    deflateReset(&m_c_stream);
 
-    if ((Z_OK != result) && (Z_STREAM_END != result))
-      mxerror(boost::format(Y("Zlib decompression failed. Result: %1%\n")) % result);
+  // deflateBound() returns an upper limit for the compressed size. One
+  // call with Z_FINISH is therefore enough.
+  auto dst             = memory_c::alloc(deflateBound(&m_c_stream, buffer->get_size()));
+
+  m_c_stream.next_in   = reinterpret_cast<Bytef *>(buffer->get_buffer());
+  m_c_stream.avail_in  = buffer->get_size();
+  m_c_stream.next_out  = reinterpret_cast<Bytef *>(dst->get_buffer());
+  m_c_stream.avail_out = dst->get_size();
+  result               = deflate(&m_c_stream, Z_FINISH);
 
-  } while ((c_stream.avail_out == 0) && (result != Z_STREAM_END));
+  if (Z_STREAM_END != result)
+    mxerror(boost::format(Y("Zlib decompression failed. Result: %1%\n")) % result);
 
-  dst->resize(c_stream.total_out);
-  deflateEnd(&c_stream);
+  dst->resize(m_c_stream.total_out);
 
   mxverb(3, boost::format("zlib_compressor_c: Compression from %1% to %2%, %3%%%\n") % buffer->get_size() % dst->get_size() % (dst->get_size() * 100 / buffer->get_size()));
 
@@ -21,10 +21,18 @@
 #include "common/compression.h"
 
 class zlib_compressor_c: public compressor_c {
+protected:
+  // The streams are only initialized once and reset for each frame.
+  z_stream m_c_stream, m_d_stream;
+  bool m_c_stream_initialized, m_d_stream_initialized;
+  int m_level;
+
 public:
-  zlib_compressor_c();
+  zlib_compressor_c(int level = Z_BEST_COMPRESSION);
   virtual ~zlib_compressor_c();
 
+  virtual void set_compression_level(int level);
+
 protected:
   virtual memory_cptr do_decompress(memory_cptr const &buffer);
   virtual memory_cptr do_compress(memory_cptr const &buffer);
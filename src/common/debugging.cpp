@@ -140,23 +140,38 @@ debugging_c::hexdump(const void *buffer_to_dump,
 
 // ------------------------------------------------------------
 
-std::vector<debugging_option_c::option_c> debugging_option_c::ms_registered_options;
+std::deque<debugging_option_c::option_c> &
+debugging_option_c::registered_options() {
+  static std::deque<option_c> s_registered_options;
+  return s_registered_options;
+}
+
+std::mutex &
+debugging_option_c::registry_mutex() {
+  static std::mutex s_mutex;
+  return s_mutex;
+}
 
-size_t
+debugging_option_c::option_c *
 debugging_option_c::register_option(std::string const &option) {
-  auto itr = brng::find_if(ms_registered_options, [&option](option_c const &opt) { return opt.m_option == option; });
-  if (itr != ms_registered_options.end())
-    return std::distance(ms_registered_options.begin(), itr);
+  std::lock_guard<std::mutex> lock{registry_mutex()};
 
-  ms_registered_options.emplace_back(option);
+  auto &options = registered_options();
+  auto itr      = brng::find_if(options, [&option](option_c const &opt) { return opt.m_option == option; });
+  if (itr != options.end())
+    return &*itr;
 
-  return ms_registered_options.size() - 1;
+  options.emplace_back(option);
+
+  return &options.back();
 }
 
 void
 debugging_option_c::invalidate_cache() {
-  for (auto &opt : ms_registered_options)
-    opt.m_requested = boost::logic::indeterminate;
+  std::lock_guard<std::mutex> lock{registry_mutex()};
+
+  for (auto &opt : registered_options())
+    opt.m_requested.store(option_c::s_unknown, std::memory_order_relaxed);
 }
 
 // ------------------------------------------------------------
@@ -16,6 +16,8 @@
 
 #include "common/common_pch.h"
 
+#include <atomic>
+#include <mutex>
 #include <sstream>
 #include <unordered_map>
 
@@ -43,47 +45,56 @@ public:
 
 class debugging_option_c {
   struct option_c {
-    boost::tribool m_requested;
+    static int const s_unknown = -1;
+
+    // Atomic as options are queried from reader threads while
+    // invalidate_cache() may reset them.
+    std::atomic<int> m_requested;
     std::string m_option;
 
     option_c(std::string const &option)
-      : m_requested{boost::logic::indeterminate}
+      : m_requested{s_unknown}
       , m_option{option}
     {
     }
 
     bool get() {
-      if (boost::logic::indeterminate(m_requested))
-        m_requested = debugging_c::requested(m_option);
+      auto requested = m_requested.load(std::memory_order_relaxed);
+      if (s_unknown == requested) {
+        requested = debugging_c::requested(m_option) ? 1 : 0;
+        m_requested.store(requested, std::memory_order_relaxed);
+      }
 
-      return m_requested;
+      return !!requested;
     }
   };
 
 protected:
-  mutable size_t m_registered_idx;
-  std::string m_option;
-
-private:
-  static std::vector<option_c> ms_registered_options;
+  option_c *m_registered_option;
 
 public:
+  // Registering right away means that the pointer never changes
+  // afterwards and can be read from several threads without locking.
   debugging_option_c(std::string const &option)
-    : m_registered_idx{std::numeric_limits<size_t>::max()}
-    , m_option{option}
+    : m_registered_option{register_option(option)}
   {
   }
 
   operator bool() const {
-    if (m_registered_idx == std::numeric_limits<size_t>::max())
-      m_registered_idx = register_option(m_option);
-
-    return ms_registered_options.at(m_registered_idx).get();
+    return m_registered_option->get();
   }
 
 public:
-  static size_t register_option(std::string const &option);
+  static option_c *register_option(std::string const &option);
   static void invalidate_cache();
+
+private:
+  // Function-local statics so that debugging_option_c instances with
+  // static storage duration in other translation units can be
+  // registered during static initialization. A deque is used so that
+  // pointers to already registered options stay valid.
+  static std::deque<option_c> &registered_options();
+  static std::mutex &registry_mutex();
 };
 
 #define mxdebug(msg) debugging_c::output((boost::format("Debug> %1%:%2%: %3%") % __FILE__ % __LINE__ % (msg)).str())
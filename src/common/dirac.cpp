@@ -17,6 +17,7 @@
 #include "common/bit_cursor.h"
 #include "common/dirac.h"
 #include "common/endian.h"
+#include "common/mpeg.h"
 
 #define MAX_STANDARD_VIDEO_FORMAT 23
 
@@ -224,67 +225,72 @@ dirac::es_parser_c::~es_parser_c() {
 void
 dirac::es_parser_c::add_bytes(unsigned char *buffer,
                               size_t size) {
-  memory_slice_cursor_c cursor;
-
   bool previous_found         = false;
-  size_t previous_pos         = 0;
+  int64_t previous_pos        = 0;
   int64_t previous_stream_pos = m_stream_pos;
 
-  if (m_unparsed_buffer && (0 != m_unparsed_buffer->get_size()))
-    cursor.add_slice(m_unparsed_buffer);
-  cursor.add_slice(buffer, size);
-
-  if (3 <= cursor.get_remaining_size()) {
-    uint32_t marker = (1 << 24) | ((unsigned int)cursor.get_char() << 16) | ((unsigned int)cursor.get_char() << 8) | (unsigned int)cursor.get_char();
-
-    while (1) {
-      if (DIRAC_SYNC_WORD == marker) {
-        if (!previous_found) {
-          previous_found = true;
-          previous_pos   = cursor.get_position() - 4;
-          m_stream_pos   = previous_stream_pos + previous_pos;
-
-          if (!cursor.char_available())
-            break;
+  // The unparsed buffer starts with the last accepted sync word (if
+  // any). Sync words following it in the unparsed buffer have been
+  // rejected before and would be rejected again as their positions
+  // relative to it haven't changed.
+  auto unparsed_size = m_unparsed_buffer ? m_unparsed_buffer->get_size() : 0;
+  auto resume_pos    = std::max<int64_t>(static_cast<int64_t>(unparsed_size) - 3, 0);
+
+  memory_cptr combined;
+  auto data         = buffer;
+  int64_t data_size = size;
+
+  if (unparsed_size) {
+    combined  = memory_c::alloc(unparsed_size + size);
+    data      = combined->get_buffer();
+    data_size = unparsed_size + size;
+    memcpy(data,                 m_unparsed_buffer->get_buffer(), unparsed_size);
+    memcpy(data + unparsed_size, buffer,                          size);
+  }
 
-          marker <<= 8;
-          marker  |= (unsigned int)cursor.get_char();
+  auto end  = data + data_size;
+  auto scan = static_cast<unsigned char const *>(data);
 
-          continue;
-        }
+  while (true) {
+    auto sync_word = mtx::mpeg::find_byte_sequence(scan, end, 'B', 'B', 'C');
+    if ((end - sync_word) < 4)
+      break;
 
-        unsigned char offset_buffer[4];
-        cursor.copy(offset_buffer, previous_pos + 4 + 1, 4);
-        uint32_t next_offset = get_uint32_be(offset_buffer);
+    scan = sync_word + 1;
+    if (DIRAC_SYNC_WORD != get_uint32_be(sync_word))
+      continue;
 
-        if ((0 == next_offset) || ((previous_pos + next_offset) <= (cursor.get_position() - 4))) {
-          int new_size = cursor.get_position() - 4 - previous_pos;
+    int64_t sync_word_pos = sync_word - data;
 
-          memory_cptr packet = memory_c::alloc(new_size);
-          cursor.copy(packet->get_buffer(), previous_pos, new_size);
+    if (!previous_found) {
+      previous_found = true;
+      previous_pos   = sync_word_pos;
+      m_stream_pos   = previous_stream_pos + previous_pos;
+      scan           = std::max(sync_word + 4, static_cast<unsigned char const *>(data) + resume_pos);
 
-          handle_unit(packet);
+      continue;
+    }
 
-          previous_pos = cursor.get_position() - 4;
-          m_stream_pos = previous_stream_pos + previous_pos;
-        }
-      }
+    uint32_t next_offset = get_uint32_be(data + previous_pos + 4 + 1);
 
-      if (!cursor.char_available())
-        break;
+    if ((0 == next_offset) || ((previous_pos + next_offset) <= sync_word_pos)) {
+      handle_unit(memory_c::clone(data + previous_pos, sync_word_pos - previous_pos));
 
-      marker <<= 8;
-      marker  |= (unsigned int)cursor.get_char();
+      previous_pos = sync_word_pos;
+      m_stream_pos = previous_stream_pos + previous_pos;
     }
+
+    scan = sync_word + 4;
   }
 
-  unsigned int new_size = cursor.get_size() - previous_pos;
-  if (0 != new_size) {
-    memory_cptr new_unparsed_buffer = memory_c::alloc(new_size);
-    cursor.copy(new_unparsed_buffer->get_buffer(), previous_pos, new_size);
-    m_unparsed_buffer = new_unparsed_buffer;
+  auto new_size = data_size - previous_pos;
+  if ((0 == previous_pos) && combined)
+    m_unparsed_buffer = combined;
 
-  } else
+  else if (0 != new_size)
+    m_unparsed_buffer = memory_c::clone(data + previous_pos, new_size);
+
+  else
     m_unparsed_buffer.reset();
 }
 
@@ -13,6 +13,7 @@
 
 #include "common/common_pch.h"
 
+#include <ebml/EbmlCrc32.h>
 #include <ebml/EbmlFloat.h>
 #include <ebml/EbmlSInteger.h>
 #include <ebml/EbmlString.h>
@@ -26,7 +27,9 @@
 #include <matroska/KaxTrackVideo.h>
 
 #include "common/chapters/chapters.h"
+#include "common/checksums/crc.h"
 #include "common/ebml.h"
+#include "common/endian.h"
 #include "common/memory.h"
 #include "common/segmentinfo.h"
 #include "common/segment_tracks.h"
@@ -355,3 +358,63 @@ write_ebml_element_head(mm_io_c &out,
 
   return out.write(buffer, id_size + coded_size);
 }
+
+// The checksum of EbmlCrc32 elements: CRC-32 IEEE in little endian
+// byte order with an initial value of 0xffffffff and the result
+// XORed with 0xffffffff.
+uint32_t
+calculate_ebml_crc32(unsigned char const *buffer,
+                     size_t size) {
+  mtx::checksum::crc32_ieee_le_c crc{0xffffffffu};
+  crc.set_xor_result(0xffffffffu);
+  crc.add(buffer, size);
+  crc.finish();
+
+  return crc.get_result_as_uint();
+}
+
+// Writes an EbmlCrc32 element covering 'content' followed by
+// 'content' itself. 'content' must have been positioned right after
+// the CRC element.
+void
+write_ebml_crc32_and_content(mm_io_c &out,
+                             mm_positioned_mem_io_c &content) {
+  assert(content.get_position() == (out.getFilePointer() + ebml_crc32_element_size));
+
+  unsigned char crc[4];
+  put_uint32_le(crc, calculate_ebml_crc32(content.get_buffer(), content.get_content_size()));
+
+  write_ebml_element_head(out, EBML_ID(EbmlCrc32), 4);
+  out.write(crc, 4);
+  out.write(content.get_buffer(), content.get_content_size());
+}
+
+// Renders 'master' with an EbmlCrc32 element as its first child. The
+// element is rendered into memory first so that the checksum can be
+// filled in before it is written to 'out'. Contrary to libebml's own
+// checksum support the children's positions are the ones in 'out'.
+void
+render_ebml_master_with_crc32(mm_io_c &out,
+                              EbmlMaster &master,
+                              std::function<void(IOCallback &)> const &render,
+                              size_t size_hint) {
+  auto crc = FindChild<EbmlCrc32>(master);
+  if (!crc) {
+    crc = new EbmlCrc32;
+    master.InsertElement(*crc, 0);
+  }
+
+  mm_positioned_mem_io_c buffer{out.getFilePointer(), size_hint};
+  render(buffer);
+
+  auto content_start = crc->GetElementPosition() + ebml_crc32_element_size - buffer.get_position();
+  assert(content_start <= buffer.get_content_size());
+
+  auto content       = buffer.get_buffer();
+  auto value         = calculate_ebml_crc32(content + content_start, buffer.get_content_size() - content_start);
+
+  crc->ForceCrc32(value);
+  put_uint32_le(content + content_start - 4, value);
+
+  out.write(content, buffer.get_content_size());
+}
@@ -21,6 +21,8 @@
 
 #include <matroska/KaxTracks.h>
 
+#include "common/mm_io.h"
+
 using namespace libebml;
 using namespace libmatroska;
 
@@ -43,6 +45,14 @@ int kt_get_v_pixel_height(KaxTrackEntry &track);
 
 int write_ebml_element_head(mm_io_c &out, EbmlId const &id, int64_t content_size);
 
+// An EbmlCrc32 element: two bytes of ID and size followed by the
+// checksum in little endian byte order.
+static const uint64_t ebml_crc32_element_size = 6;
+
+uint32_t calculate_ebml_crc32(unsigned char const *buffer, size_t size);
+void write_ebml_crc32_and_content(mm_io_c &out, mm_positioned_mem_io_c &content);
+void render_ebml_master_with_crc32(mm_io_c &out, EbmlMaster &master, std::function<void(IOCallback &)> const &render, size_t size_hint = 0);
+
 #if !defined(EBML_INFO)
 #define EBML_INFO(ref)  ref::ClassInfos
 #endif
@@ -156,3 +156,18 @@ put_uint64_be(void *buf,
               uint64_t value) {
   put_uint_be(buf, value, 8);
 }
+
+// The byte-wise expression is recognized by the compiler and turned
+// into (vectorized) byte swap instructions.
+void
+get_uint32_be_array(uint32_t *dst,
+                    const void *src,
+                    size_t count) {
+  auto tmp = static_cast<unsigned char const *>(src);
+
+  for (size_t idx = 0; idx < count; ++idx, tmp += 4)
+    dst[idx] = (static_cast<uint32_t>(tmp[0]) << 24)
+             | (static_cast<uint32_t>(tmp[1]) << 16)
+             | (static_cast<uint32_t>(tmp[2]) <<  8)
+             |  static_cast<uint32_t>(tmp[3]);
+}
@@ -38,4 +38,6 @@ void put_uint24_be(void *buf, uint32_t value);
 void put_uint32_be(void *buf, uint32_t value);
 void put_uint64_be(void *buf, uint64_t value);
 
+void get_uint32_be_array(uint32_t *dst, const void *src, size_t count);
+
 #endif  // MTX_COMMON_ENDIAN_H
@@ -13,12 +13,17 @@
 
 #include "common/common_pch.h"
 
+#include <mutex>
+
 #include "common/file_types.h"
 
 static std::vector<file_type_t> s_supported_file_types;
 
 std::vector<file_type_t> &
 file_type_t::get_supported() {
+  static std::mutex s_mutex;
+  std::lock_guard<std::mutex> lock{s_mutex};
+
   if (!s_supported_file_types.empty())
     return s_supported_file_types;
 
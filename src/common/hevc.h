@@ -457,6 +457,7 @@ protected:
   uint64_t m_stream_position, m_parsed_position;
 
   frame_t m_incomplete_frame;
+  std::vector<memory_cptr> m_incomplete_frame_nalus, m_incomplete_frame_extra_data;
   bool m_have_incomplete_frame;
   std::deque<memory_cptr> m_unhandled_nalus;
 
@@ -592,6 +593,8 @@ protected:
   void cleanup();
   void flush_incomplete_frame();
   void flush_unhandled_nalus();
+  void start_incomplete_frame_data(memory_cptr const &nalu);
+  void assemble_incomplete_frame_data();
   memory_cptr create_nalu_with_size(const memory_cptr &src, bool add_extra_data = false);
   static void init_nalu_names();
 };
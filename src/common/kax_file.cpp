@@ -18,6 +18,7 @@
 #include <ebml/EbmlCrc32.h>
 #include <ebml/EbmlStream.h>
 #include <ebml/EbmlVoid.h>
+#include <matroska/KaxBlock.h>
 
 #include "common/ebml.h"
 #include "common/fs_sys_helpers.h"
@@ -33,9 +34,11 @@ kax_file_c::kax_file_c(mm_io_c &in)
   , m_segment_end{}
   , m_timecode_scale{TIMECODE_SCALE}
   , m_last_timecode{-1}
+  , m_last_skipped_block_timecode{-1}
   , m_es{new EbmlStream{m_in}}
   , m_debug_read_next{"kax_file|kax_file_read_next"}
   , m_debug_resync{   "kax_file|kax_file_resync"}
+  , m_debug_skip_blocks{"kax_file|kax_file_skip_blocks"}
 {
 }
 
@@ -297,6 +300,151 @@ kax_file_c::read_next_cluster() {
   return static_cast<KaxCluster *>(read_next_level1_element(EBML_ID_VALUE(EBML_ID(KaxCluster))));
 }
 
+// Reads the next cluster but only parses the blocks of tracks for
+// which 'is_track_wanted' returns true. The blocks of all other tracks
+// are skipped after having read their headers, without their content
+// ever being read. Falls back to reading the whole cluster if its
+// structure isn't what is expected, e.g. for clusters of unknown size.
+KaxCluster *
+kax_file_c::read_next_cluster(std::function<bool(uint64_t)> const &is_track_wanted) {
+  auto cluster_start = m_in.getFilePointer();
+
+  m_last_skipped_block_timecode = -1;
+
+  try {
+    auto cluster = read_cluster_skipping_blocks(is_track_wanted);
+    if (cluster)
+      return cluster;
+
+  } catch (...) {
+    mxdebug_if(m_debug_skip_blocks, boost::format("kax_file::read_next_cluster(): exception while reading the cluster at %1%; falling back to reading it fully\n") % cluster_start);
+  }
+
+  m_in.setFilePointer(cluster_start, seek_beginning);
+
+  return read_next_cluster();
+}
+
+KaxCluster *
+kax_file_c::read_cluster_skipping_blocks(std::function<bool(uint64_t)> const &is_track_wanted) {
+  if (m_segment_end && (m_in.getFilePointer() >= m_segment_end))
+    return nullptr;
+
+  m_resynced         = false;
+  m_resync_start_pos = 0;
+
+  auto cluster_id = vint_c::read_ebml_id(m_in);
+  if (!cluster_id.is_valid() || (EBML_ID_VALUE(EBML_ID(KaxCluster)) != cluster_id.m_value))
+    return nullptr;
+
+  auto cluster_size = vint_c::read(m_in);
+  if (!cluster_size.is_valid() || cluster_size.is_unknown())
+    return nullptr;
+
+  auto cluster_end = m_in.getFilePointer() + cluster_size.m_value;
+  if (cluster_end > m_file_size)
+    return nullptr;
+
+  auto cluster = std::unique_ptr<KaxCluster>(new KaxCluster);
+
+  // Get rid of the mandatory elements created by the constructor,
+  // e.g. KaxClusterTimecode.
+  for (auto child : *cluster)
+    delete child;
+  cluster->RemoveAll();
+
+  auto num_skipped      = 0u;
+  auto bytes_skipped    = uint64_t{};
+  auto cluster_timecode = boost::optional<uint64_t>{};
+
+  while (m_in.getFilePointer() < cluster_end) {
+    auto child_start = m_in.getFilePointer();
+    auto child_id    = vint_c::read_ebml_id(m_in);
+    auto child_size  = vint_c::read(m_in);
+
+    if (!child_id.is_valid() || !child_size.is_valid() || child_size.is_unknown())
+      return nullptr;
+
+    auto data_start = m_in.getFilePointer();
+    auto child_end  = data_start + child_size.m_value;
+    if (child_end > cluster_end)
+      return nullptr;
+
+    auto block_start = uint64_t{};
+
+    if (EBML_ID_VALUE(EBML_ID(KaxSimpleBlock)) == child_id.m_value)
+      block_start = data_start;
+
+    else if (EBML_ID_VALUE(EBML_ID(KaxBlockGroup)) == child_id.m_value) {
+      // The Block is usually the first child of the BlockGroup.
+      auto block_id   = vint_c::read_ebml_id(m_in);
+      auto block_size = vint_c::read(m_in);
+
+      if (   block_id.is_valid() && block_size.is_valid() && !block_size.is_unknown()
+          && (EBML_ID_VALUE(EBML_ID(KaxBlock)) == block_id.m_value))
+        block_start = m_in.getFilePointer();
+    }
+
+    if (block_start && (block_start < child_end)) {
+      m_in.setFilePointer(block_start, seek_beginning);
+      auto track_number = vint_c::read(m_in);
+
+      if (track_number.is_valid() && !track_number.is_unknown() && !is_track_wanted(track_number.m_value)) {
+        // Skipped blocks still count for the progress and for the
+        // timestamp reported after errors.
+        if (cluster_timecode && ((m_in.getFilePointer() + 2) <= child_end)) {
+          auto relative_timecode        = static_cast<int16_t>(m_in.read_uint16_be());
+          m_last_skipped_block_timecode = (static_cast<int64_t>(*cluster_timecode) + relative_timecode) * m_timecode_scale;
+          m_last_timecode               = m_last_skipped_block_timecode;
+        }
+
+        ++num_skipped;
+        bytes_skipped += child_end - child_start;
+        m_in.setFilePointer(child_end, seek_beginning);
+        continue;
+      }
+    }
+
+    m_in.setFilePointer(child_start, seek_beginning);
+
+    auto child = read_one_cluster_child(child_end);
+    if (!child)
+      return nullptr;
+
+    if (Is<KaxClusterTimecode>(child))
+      cluster_timecode = static_cast<KaxClusterTimecode *>(child)->GetValue();
+
+    cluster->PushElement(*child);
+  }
+
+  mxdebug_if(m_debug_skip_blocks, boost::format("kax_file::read_next_cluster(): cluster at %1% size %2%: skipped %3% blocks with %4% bytes\n")
+             % (cluster_end - cluster_size.m_value - cluster_size.m_coded_size - cluster_id.m_coded_size) % cluster_size.m_value % num_skipped % bytes_skipped);
+
+  return cluster.release();
+}
+
+EbmlElement *
+kax_file_c::read_one_cluster_child(uint64_t child_end) {
+  auto upper_lvl_el = 0;
+  auto child        = m_es->FindNextElement(EBML_CLASS_CONTEXT(KaxCluster), upper_lvl_el, 0xFFFFFFFFL, true);
+
+  if (!child)
+    return nullptr;
+
+  auto l3 = static_cast<EbmlElement *>(nullptr);
+  try {
+    child->Read(*m_es.get(), EBML_CONTEXT(child), upper_lvl_el, l3, true);
+
+  } catch (std::runtime_error &) {
+    delete child;
+    return nullptr;
+  }
+
+  m_in.setFilePointer(child_end, seek_beginning);
+
+  return child;
+}
+
 bool
 kax_file_c::was_resynced() const {
   return m_resynced;
@@ -331,6 +479,18 @@ kax_file_c::set_last_timecode(int64_t last_timecode) {
   m_last_timecode = last_timecode;
 }
 
+int64_t
+kax_file_c::get_last_timecode()
+  const {
+  return m_last_timecode;
+}
+
+int64_t
+kax_file_c::get_last_skipped_block_timecode()
+  const {
+  return m_last_skipped_block_timecode;
+}
+
 void
 kax_file_c::set_segment_end(EbmlElement const &segment) {
   m_segment_end = segment.IsFiniteSize() ? segment.GetElementPosition() + segment.HeadSize() + segment.GetSize() : m_in.get_size();
@@ -29,10 +29,10 @@ protected:
   mm_io_c &m_in;
   bool m_resynced, m_reporting_enabled{true};
   uint64_t m_resync_start_pos, m_file_size, m_segment_end;
-  int64_t m_timecode_scale, m_last_timecode;
+  int64_t m_timecode_scale, m_last_timecode, m_last_skipped_block_timecode;
   std::shared_ptr<EbmlStream> m_es;
 
-  debugging_option_c m_debug_read_next, m_debug_resync;
+  debugging_option_c m_debug_read_next, m_debug_resync, m_debug_skip_blocks;
 
 public:
   kax_file_c(mm_io_c &in);
@@ -45,6 +45,7 @@ public:
 
   virtual EbmlElement *read_next_level1_element(uint32_t wanted_id = 0, bool report_cluster_timecode = false);
   virtual KaxCluster *read_next_cluster();
+  virtual KaxCluster *read_next_cluster(std::function<bool(uint64_t)> const &is_track_wanted);
 
   virtual EbmlElement *resync_to_level1_element(uint32_t wanted_id = 0);
   virtual KaxCluster *resync_to_cluster();
@@ -53,6 +54,8 @@ public:
 
   virtual void set_timecode_scale(int64_t timecode_scale);
   virtual void set_last_timecode(int64_t last_timecode);
+  virtual int64_t get_last_timecode() const;
+  virtual int64_t get_last_skipped_block_timecode() const;
   virtual void set_segment_end(EbmlElement const &segment);
   virtual uint64_t get_segment_end() const;
 
@@ -60,6 +63,8 @@ public:
 
 protected:
   virtual EbmlElement *read_one_element();
+  virtual EbmlElement *read_one_cluster_child(uint64_t child_end);
+  virtual KaxCluster *read_cluster_skipping_blocks(std::function<bool(uint64_t)> const &is_track_wanted);
 
   virtual EbmlElement *read_next_level1_element_internal(uint32_t wanted_id = 0);
   virtual EbmlElement *resync_to_level1_element_internal(uint32_t wanted_id = 0);
@@ -32,7 +32,12 @@
 # include "common/strings/formatting.h"
 #endif
 
-charset_converter_cptr g_cc_local_utf8;
+// iconv's conversion state must not be shared between threads. Each
+// thread therefore gets its own converter for the local charset. The
+// charset itself is determined once by the main thread as that
+// involves changing the locale.
+static std::string s_local_charset;
+thread_local charset_converter_cptr g_cc_local_utf8 = s_local_charset.empty() ? charset_converter_cptr{} : charset_converter_c::init(s_local_charset);
 
 std::map<std::string, charset_converter_cptr> charset_converter_c::s_converters;
 
@@ -309,6 +314,12 @@ get_local_charset() {
   return lc_charset;
 }
 
+void
+init_local_charset_converter() {
+  s_local_charset = get_local_charset();
+  g_cc_local_utf8 = charset_converter_c::init(s_local_charset);
+}
+
 std::string
 get_local_console_charset() {
 #if defined(SYS_WINDOWS)
@@ -90,8 +90,9 @@ private:                        // Static functions
 };
 #endif
 
-extern charset_converter_cptr g_cc_local_utf8;
+extern thread_local charset_converter_cptr g_cc_local_utf8;
 
+void init_local_charset_converter();
 std::string get_local_charset();
 std::string get_local_console_charset();
 
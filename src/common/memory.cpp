@@ -26,16 +26,26 @@ memory_c::resize(size_t new_size)
   if (new_size == its_counter->size)
     return;
 
-  if (its_counter->is_free) {
+  if (its_counter->is_free && its_counter->capacity && ((new_size + its_counter->offset) <= its_counter->capacity))
+    // Still fits into the block taken from the pool.
+    its_counter->size = new_size + its_counter->offset;
+
+  else if (its_counter->is_free && !its_counter->capacity) {
     its_counter->ptr  = (unsigned char *)saferealloc(its_counter->ptr, new_size + its_counter->offset);
     its_counter->size = new_size + its_counter->offset;
 
   } else {
-    auto tmp = (unsigned char *)safemalloc(new_size);
+    auto tmp = static_cast<unsigned char *>(mtx::mem::pool::allocate(new_size));
     memcpy(tmp, its_counter->ptr + its_counter->offset, std::min(new_size, its_counter->size - its_counter->offset));
-    its_counter->ptr     = tmp;
-    its_counter->is_free = true;
-    its_counter->size    = new_size;
+
+    if (its_counter->is_free)
+      mtx::mem::pool::release(its_counter->ptr, its_counter->capacity);
+
+    its_counter->ptr      = tmp;
+    its_counter->is_free  = true;
+    its_counter->size     = new_size;
+    its_counter->offset   = 0;
+    its_counter->capacity = mtx::mem::pool::capacity_for(new_size);
   }
 }
 
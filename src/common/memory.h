@@ -18,6 +18,8 @@
 
 #include <deque>
 
+#include "common/memory_pool.h"
+
 namespace mtx {
   namespace mem {
     class exception: public mtx::exception {
@@ -93,8 +95,9 @@ public:
   }
 
   explicit memory_c(size_t s)
-    : its_counter(new counter(static_cast<unsigned char *>(safemalloc(s)), s, true))
+    : its_counter(new counter(static_cast<unsigned char *>(mtx::mem::pool::allocate(s)), s, true))
   {
+    its_counter->capacity = mtx::mem::pool::capacity_for(s);
   }
 
   ~memory_c() {
@@ -152,15 +155,24 @@ public:
     if (!its_counter || its_counter->is_free)
       return;
 
-    its_counter->ptr      = static_cast<unsigned char *>(safememdup(get_buffer(), get_size()));
+    auto size             = get_size();
+    its_counter->ptr      = static_cast<unsigned char *>(::memcpy(mtx::mem::pool::allocate(size), get_buffer(), size));
+    its_counter->capacity = mtx::mem::pool::capacity_for(size);
     its_counter->is_free  = true;
-    its_counter->size    -= its_counter->offset;
+    its_counter->size     = size;
     its_counter->offset   = 0;
   }
 
+  // Hands the ownership of the buffer over to the caller who has to
+  // free() it.
   void lock() {
-    if (its_counter)
-      its_counter->is_free = false;
+    if (its_counter) {
+      if (its_counter->is_free && its_counter->capacity)
+        mtx::mem::pool::hand_over(its_counter->ptr, its_counter->capacity);
+
+      its_counter->is_free  = false;
+      its_counter->capacity = 0;
+    }
   }
 
   void resize(size_t new_size) throw();
@@ -202,15 +214,28 @@ public:
   }
 
 public:
+  static void *operator new(size_t size) {
+    return mtx::mem::pool::allocate(size);
+  }
+
+  static void operator delete(void *ptr, size_t size) {
+    mtx::mem::pool::release(ptr, size);
+  }
+
   static memory_cptr
   alloc(size_t size) {
-    return memory_cptr(new memory_c(static_cast<unsigned char *>(safemalloc(size)), size, true));
+    return memory_cptr(new memory_c(size), std::default_delete<memory_c>{}, mtx::mem::pool::allocator_c<memory_c>{});
   };
 
   static inline memory_cptr
   clone(const void *buffer,
         size_t size) {
-    return memory_cptr(new memory_c(static_cast<unsigned char *>(safememdup(buffer, size)), size, true));
+    if (!buffer)
+      return memory_cptr(new memory_c(nullptr, size, true));
+
+    auto mem = alloc(size);
+    ::memcpy(mem->get_buffer(), buffer, size);
+    return mem;
   }
 
   static inline memory_cptr
@@ -218,6 +243,18 @@ public:
     return clone(buffer.c_str(), buffer.length());
   }
 
+  // Refers to a part of another buffer without copying it. The other
+  // buffer is kept alive as long as the view exists. Only the view's
+  // shared pointer does that, not copies of the memory_c object
+  // itself. Resizing or grabbing the view copies the data.
+  static inline memory_cptr
+  view(memory_cptr const &backing,
+       size_t offset,
+       size_t size) {
+    assert((offset + size) <= backing->get_size());
+    return memory_cptr(new memory_c(backing->get_buffer() + offset, size, false), [backing](memory_c *mem) { delete mem; });
+  }
+
   static inline memory_cptr
   point_to(std::string &buffer) {
     return std::make_shared<memory_c>(reinterpret_cast<unsigned char *>(&buffer[0]), buffer.length(), false);
@@ -230,6 +267,7 @@ private:
     bool is_free;
     unsigned count;
     size_t offset;
+    size_t capacity;            // only set if ptr has been allocated from the pool
 
     counter(unsigned char *p = nullptr,
             size_t s = 0,
@@ -240,7 +278,16 @@ private:
       , is_free(f)
       , count(c)
       , offset(0)
+      , capacity(0)
     { }
+
+    static void *operator new(size_t size) {
+      return mtx::mem::pool::allocate(size);
+    }
+
+    static void operator delete(void *ptr, size_t size) {
+      mtx::mem::pool::release(ptr, size);
+    }
   } *its_counter;
 
   void acquire(counter *c) throw() { // increment the count
@@ -252,7 +299,9 @@ private:
   void release() { // decrement the count, delete if it is 0
     if (its_counter) {
       if (--its_counter->count == 0) {
-        if (its_counter->is_free)
+        if (its_counter->is_free && its_counter->capacity)
+          mtx::mem::pool::release(its_counter->ptr, its_counter->capacity);
+        else if (its_counter->is_free)
           free(its_counter->ptr);
         delete its_counter;
       }
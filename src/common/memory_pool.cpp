@@ -0,0 +1,247 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   size class buffer pool
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <atomic>
+#include <mutex>
+
+#include "common/memory_pool.h"
+
+namespace mtx { namespace mem { namespace pool {
+
+namespace {
+
+size_t const s_min_class_size    = 32;
+unsigned int const s_max_bits    = 22; // Classes up to 4 MB.
+unsigned int const s_num_classes = 1 + (s_max_bits - 5) * 4;
+
+// Don't keep more than this many bytes around per size class after
+// the blocks have been released -- but at least a couple of blocks.
+size_t const s_max_retained_bytes  = 32 * 1024 * 1024;
+size_t const s_min_retained_blocks = 16;
+
+// Limit for the bytes kept on the free lists of all size classes
+// together.
+int64_t const s_max_total_retained_bytes = 128 * 1024 * 1024;
+
+struct size_class_t {
+  std::mutex mutex;
+  std::vector<void *> free_blocks;
+  size_t size;
+  uint64_t num_requests, num_hits, num_in_use, peak_in_use;
+
+  size_class_t()
+    : size{}
+    , num_requests{}
+    , num_hits{}
+    , num_in_use{}
+    , peak_in_use{}
+  {
+  }
+};
+
+class pool_c {
+public:
+  size_class_t classes[s_num_classes];
+  std::atomic<uint64_t> num_unpooled, num_handed_over;
+  std::atomic<int64_t> bytes_in_use, peak_bytes_in_use, retained_bytes;
+
+  pool_c()
+    : num_unpooled{}
+    , num_handed_over{}
+    , bytes_in_use{}
+    , peak_bytes_in_use{}
+    , retained_bytes{}
+  {
+    classes[0].size = s_min_class_size;
+
+    for (auto bits = 5u; bits < s_max_bits; ++bits)
+      for (auto step = 0u; step < 4; ++step)
+        classes[1 + (bits - 5) * 4 + step].size = static_cast<size_t>(5 + step) << (bits - 2);
+  }
+};
+
+// The pool is never destroyed as buffers may still be released by
+// destructors of other static objects at program exit.
+pool_c &
+get_pool() {
+  static auto s_pool = new pool_c;
+  return *s_pool;
+}
+
+// Maps a size to its class: four classes per power of two, each a
+// quarter of that power apart.
+int
+class_index(size_t size) {
+  if (size <= s_min_class_size)
+    return 0;
+
+  auto value = size - 1;
+  auto bits  = 0u;
+  while (value >> (bits + 1))
+    ++bits;
+
+  if (bits >= s_max_bits)
+    return -1;
+
+  return 1 + (bits - 5) * 4 + ((value >> (bits - 2)) & 3);
+}
+
+void
+account_bytes(pool_c &pool,
+              int64_t num_bytes) {
+  auto in_use = pool.bytes_in_use.fetch_add(num_bytes) + num_bytes;
+  auto peak   = pool.peak_bytes_in_use.load();
+
+  while ((in_use > peak) && !pool.peak_bytes_in_use.compare_exchange_weak(peak, in_use))
+    ;
+}
+
+}
+
+size_t
+capacity_for(size_t size) {
+  auto idx = class_index(size);
+  return 0 <= idx ? get_pool().classes[idx].size : 0;
+}
+
+void *
+allocate(size_t size) {
+  auto &pool = get_pool();
+  auto idx   = class_index(size);
+
+  if (0 > idx) {
+    ++pool.num_unpooled;
+    return safemalloc(size);
+  }
+
+  auto &size_class = pool.classes[idx];
+  void *block      = nullptr;
+
+  {
+    std::lock_guard<std::mutex> lock{size_class.mutex};
+
+    ++size_class.num_requests;
+    ++size_class.num_in_use;
+    size_class.peak_in_use = std::max(size_class.peak_in_use, size_class.num_in_use);
+
+    if (!size_class.free_blocks.empty()) {
+      block = size_class.free_blocks.back();
+      size_class.free_blocks.pop_back();
+      ++size_class.num_hits;
+    }
+  }
+
+  if (block)
+    pool.retained_bytes -= size_class.size;
+
+  account_bytes(pool, size_class.size);
+
+  return block ? block : safemalloc(size_class.size);
+}
+
+void
+release(void *ptr,
+        size_t size) {
+  if (!ptr)
+    return;
+
+  auto &pool = get_pool();
+  auto idx   = class_index(size);
+
+  if (0 > idx) {
+    free(ptr);
+    return;
+  }
+
+  auto &size_class = pool.classes[idx];
+  auto max_blocks  = std::max(s_min_retained_blocks, s_max_retained_bytes / size_class.size);
+
+  account_bytes(pool, -static_cast<int64_t>(size_class.size));
+
+  {
+    std::lock_guard<std::mutex> lock{size_class.mutex};
+
+    --size_class.num_in_use;
+
+    if (size_class.free_blocks.size() < max_blocks) {
+      auto retained = pool.retained_bytes.fetch_add(size_class.size) + static_cast<int64_t>(size_class.size);
+
+      if (retained <= s_max_total_retained_bytes) {
+        size_class.free_blocks.push_back(ptr);
+        return;
+      }
+
+      pool.retained_bytes -= size_class.size;
+    }
+  }
+
+  free(ptr);
+}
+
+void
+hand_over(void *ptr,
+          size_t size) {
+  if (!ptr)
+    return;
+
+  auto &pool = get_pool();
+  auto idx   = class_index(size);
+
+  if (0 > idx)
+    return;
+
+  auto &size_class = pool.classes[idx];
+
+  ++pool.num_handed_over;
+  account_bytes(pool, -static_cast<int64_t>(size_class.size));
+
+  std::lock_guard<std::mutex> lock{size_class.mutex};
+  --size_class.num_in_use;
+}
+
+int64_t
+get_bytes_in_use() {
+  return get_pool().bytes_in_use.load();
+}
+
+void
+report() {
+  if (!debugging_c::requested("memory_pool"))
+    return;
+
+  auto &pool         = get_pool();
+  auto num_requests  = uint64_t{};
+  auto num_hits      = uint64_t{};
+
+  mxdebug(boost::format("memory pool: size class, requests, hit rate, peak blocks in use\n"));
+
+  for (auto &size_class : pool.classes) {
+    std::lock_guard<std::mutex> lock{size_class.mutex};
+
+    if (!size_class.num_requests)
+      continue;
+
+    num_requests += size_class.num_requests;
+    num_hits     += size_class.num_hits;
+
+    mxdebug(boost::format("memory pool:   %1% %2% %3%%% %4%\n")
+            % size_class.size % size_class.num_requests % (size_class.num_hits * 100 / size_class.num_requests) % size_class.peak_in_use);
+  }
+
+  mxdebug(boost::format("memory pool: total requests %1% hit rate %2%%% unpooled %3% handed over %4% peak bytes in use %5% bytes retained %6%\n")
+          % num_requests % (num_requests ? num_hits * 100 / num_requests : 0) % pool.num_unpooled.load() % pool.num_handed_over.load() % pool.peak_bytes_in_use.load() % pool.retained_bytes.load());
+}
+
+}}}
@@ -0,0 +1,96 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   definitions for the size class buffer pool
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_COMMON_MEMORY_POOL_H
+#define MTX_COMMON_MEMORY_POOL_H
+
+#include "common/common_pch.h"
+
+/* Blocks are rounded up to one of a fixed set of size classes (four
+   per power of two between 32 bytes and 4 MB). Released blocks are
+   kept on a free list per size class and handed out again instead of
+   going through malloc() and free() for each frame. The number of
+   bytes kept on all free lists together is capped. Larger requests
+   are passed through to malloc() directly.
+
+   Each block is allocated with malloc() individually so that the
+   owner of a block may still take it over and release it with free()
+   itself, e.g. when handing it over to libebml. */
+
+namespace mtx { namespace mem { namespace pool {
+
+// Returns the size actually allocated for a request of 'size' bytes
+// or 0 if such a request isn't served from the pool.
+size_t capacity_for(size_t size);
+
+void *allocate(size_t size);
+// 'size' must be the size passed to allocate() or the capacity
+// reported for it.
+void release(void *ptr, size_t size);
+// Removes a block from the pool's accounting when its ownership is
+// handed over to someone who will release it with free().
+void hand_over(void *ptr, size_t size);
+
+// Number of bytes currently allocated from the size classes.
+int64_t get_bytes_in_use();
+
+// Outputs hit rates and peak usage if '--debug memory_pool' is used.
+void report();
+
+// An allocator for shared pointer control blocks and containers.
+template<typename T>
+class allocator_c {
+public:
+  using value_type = T;
+
+  allocator_c() {
+  }
+
+  template<typename U>
+  allocator_c(allocator_c<U> const &) {
+  }
+
+  T *
+  allocate(size_t n) {
+    return static_cast<T *>(pool::allocate(n * sizeof(T)));
+  }
+
+  void
+  deallocate(T *ptr,
+             size_t n) {
+    pool::release(ptr, n * sizeof(T));
+  }
+
+  template<typename U>
+  struct rebind {
+    using other = allocator_c<U>;
+  };
+
+  template<typename U>
+  bool
+  operator ==(allocator_c<U> const &)
+    const {
+    return true;
+  }
+
+  template<typename U>
+  bool
+  operator !=(allocator_c<U> const &)
+    const {
+    return false;
+  }
+};
+
+}}}
+
+#endif  // MTX_COMMON_MEMORY_POOL_H
@@ -15,6 +15,7 @@
 #include "common/common_pch.h"
 
 #include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #ifdef HAVE_UNISTD_H
@@ -135,6 +136,19 @@ mm_file_io_c::truncate(int64_t pos) {
   return ftruncate(fileno((FILE *)m_file), pos);
 }
 
+// Reserves disk space for 'size' bytes without changing the file's
+// size. Space reserved beyond the end of the file is released when
+// the file is truncated.
+bool
+mm_file_io_c::preallocate(int64_t size) {
+#if defined(FALLOC_FL_KEEP_SIZE)
+  return 0 == fallocate(fileno((FILE *)m_file), FALLOC_FL_KEEP_SIZE, 0, size);
+#else
+  (void)size;
+  return false;
+#endif
+}
+
 /** \brief OS and kernel dependant setup
 */
 void
@@ -864,6 +878,24 @@ mm_mem_io_c::get_content()
   return std::string(source, m_mem_size);
 }
 
+mm_positioned_mem_io_c::mm_positioned_mem_io_c(uint64_t position,
+                                               size_t size_hint)
+  : mm_mem_io_c{nullptr, 0, static_cast<int>(std::max<size_t>(size_hint, 64 * 1024))}
+  , m_position{position}
+{
+}
+
+uint64
+mm_positioned_mem_io_c::getFilePointer() {
+  return m_position + mm_mem_io_c::getFilePointer();
+}
+
+void
+mm_positioned_mem_io_c::setFilePointer(int64 offset,
+                                       seek_mode mode) {
+  mm_mem_io_c::setFilePointer(seek_beginning == mode ? offset - static_cast<int64_t>(m_position) : offset, mode);
+}
+
 /*
    Class for handling UTF-8/UTF-16/UTF-32 text files.
 */
@@ -149,6 +149,7 @@ public:
   }
 
   virtual int truncate(int64_t pos);
+  virtual bool preallocate(int64_t size);
 
   static void setup();
   static void cleanup();
@@ -260,6 +261,28 @@ protected:
 
 using mm_mem_io_cptr = std::shared_ptr<mm_mem_io_c>;
 
+/* A memory buffer for data that will be written to another file at
+   'position' afterwards. File positions are reported as they will be
+   in that file so that elements rendered into it by libebml remember
+   their final positions. */
+class mm_positioned_mem_io_c: public mm_mem_io_c {
+protected:
+  uint64_t m_position;
+
+public:
+  mm_positioned_mem_io_c(uint64_t position, size_t size_hint = 0);
+
+  virtual uint64 getFilePointer();
+  virtual void setFilePointer(int64 offset, seek_mode mode = seek_beginning);
+
+  virtual uint64_t get_position() const {
+    return m_position;
+  }
+  virtual size_t get_content_size() const {
+    return m_mem_size;
+  }
+};
+
 enum byte_order_e {BO_UTF8, BO_UTF16_LE, BO_UTF16_BE, BO_UTF32_LE, BO_UTF32_BE, BO_NONE};
 
 class mm_text_io_c: public mm_proxy_io_c {
@@ -183,6 +183,11 @@ mm_file_io_c::clear_eof() {
   m_eof = false;
 }
 
+bool
+mm_file_io_c::preallocate(int64_t) {
+  return false;
+}
+
 int
 mm_file_io_c::truncate(int64_t pos) {
   m_cached_size = -1;
@@ -0,0 +1,324 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   IO callback class implementation for memory-mapped input files
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#if defined(SYS_WINDOWS)
+# include <windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <sys/types.h>
+# include <unistd.h>
+#endif
+
+#include "common/mm_io_x.h"
+#include "common/mm_mmap_io.h"
+#include "common/mm_read_buffer_io.h"
+#if defined(SYS_WINDOWS)
+# include "common/strings/utf8.h"
+#endif
+
+// 32-bit systems lack the address space for mapping large files
+// completely. Only a window of this size is mapped there.
+static uint64_t const s_max_window_size = sizeof(void *) >= 8 ? std::numeric_limits<uint64_t>::max() : 64 * 1024 * 1024;
+
+// Amount of data the OS is asked to read ahead after seeking.
+static size_t const s_will_need_size    = 4 * 1024 * 1024;
+
+static debugging_option_c s_debug{"mm_mmap_io"};
+
+static uint64_t
+allocation_granularity() {
+#if defined(SYS_WINDOWS)
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwAllocationGranularity;
+#else
+  return sysconf(_SC_PAGESIZE);
+#endif
+}
+
+mm_mmap_io_c::mm_mmap_io_c(std::string const &file_name)
+  : m_file_name{file_name}
+  , m_file_size{}
+  , m_pos{}
+  , m_eof{}
+  , m_window{}
+  , m_window_offset{}
+  , m_window_size{}
+#if defined(SYS_WINDOWS)
+  , m_file{}
+  , m_mapping{}
+#else
+  , m_file{-1}
+#endif
+{
+#if defined(SYS_WINDOWS)
+  auto w_path = to_wide(file_name);
+  auto file   = CreateFileW(w_path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (INVALID_HANDLE_VALUE == file)
+    throw mtx::mm_io::open_x{mtx::mm_io::make_error_code()};
+
+  m_file = static_cast<void *>(file);
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    auto error_code = mtx::mm_io::make_error_code();
+    close();
+    throw mtx::mm_io::open_x{error_code};
+  }
+
+  m_file_size          = size.QuadPart;
+  m_dos_style_newlines = true;
+
+  if (m_file_size) {
+    m_mapping = static_cast<void *>(CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr));
+    if (!m_mapping) {
+      auto error_code = mtx::mm_io::make_error_code();
+      close();
+      throw mtx::mm_io::open_x{error_code};
+    }
+  }
+
+#else
+  auto local_path = g_cc_local_utf8->native(file_name);
+
+  m_file = ::open(local_path.c_str(), O_RDONLY);
+  if (-1 == m_file)
+    throw mtx::mm_io::open_x{mtx::mm_io::make_error_code()};
+
+  // Only regular files can be mapped.
+  struct stat st;
+  if ((0 != fstat(m_file, &st)) || !S_ISREG(st.st_mode)) {
+    auto error_code = mtx::mm_io::make_error_code();
+    close();
+    throw mtx::mm_io::open_x{error_code};
+  }
+
+  m_file_size = st.st_size;
+#endif
+
+  if (m_file_size && !map_window(0, 0)) {
+    auto error_code = mtx::mm_io::make_error_code();
+    close();
+    throw mtx::mm_io::open_x{error_code};
+  }
+
+  advise_will_need(0, s_will_need_size);
+}
+
+mm_mmap_io_c::~mm_mmap_io_c() {
+  close();
+}
+
+mm_io_cptr
+mm_mmap_io_c::open(std::string const &file_name,
+                   size_t fallback_buffer_size) {
+  try {
+    return mm_io_cptr{new mm_mmap_io_c{file_name}};
+
+  } catch (mtx::mm_io::exception &ex) {
+    mxdebug_if(s_debug, boost::format("mm_mmap_io_c::open: mapping %1% failed (%2%); falling back to regular file I/O\n") % file_name % ex.error());
+  }
+
+  return mm_io_cptr{new mm_read_buffer_io_c{new mm_file_io_c{file_name}, fallback_buffer_size}};
+}
+
+bool
+mm_mmap_io_c::map_window(uint64_t offset,
+                         size_t min_size) {
+  auto aligned_offset = offset - (offset % allocation_granularity());
+  auto size           = std::min(m_file_size - aligned_offset, s_max_window_size);
+
+  if ((offset - aligned_offset + min_size) > size)
+    return false;
+
+  if (m_window && (aligned_offset == m_window_offset) && (size == m_window_size))
+    return true;
+
+  unmap_window();
+
+#if defined(SYS_WINDOWS)
+  auto mem = MapViewOfFile(static_cast<HANDLE>(m_mapping), FILE_MAP_READ, aligned_offset >> 32, aligned_offset & 0xffffffff, size);
+  if (!mem)
+    return false;
+
+#else
+  auto mem = mmap(nullptr, size, PROT_READ, MAP_SHARED, m_file, aligned_offset);
+  if (MAP_FAILED == mem)
+    return false;
+
+# if defined(MADV_SEQUENTIAL)
+  madvise(mem, size, MADV_SEQUENTIAL);
+# endif
+#endif
+
+  m_window        = static_cast<unsigned char *>(mem);
+  m_window_offset = aligned_offset;
+  m_window_size   = size;
+
+  mxdebug_if(s_debug, boost::format("mm_mmap_io_c::map_window: %1%: mapped %2% bytes at %3%\n") % m_file_name % m_window_size % m_window_offset);
+
+  return true;
+}
+
+void
+mm_mmap_io_c::unmap_window() {
+  if (!m_window)
+    return;
+
+#if defined(SYS_WINDOWS)
+  UnmapViewOfFile(m_window);
+#else
+  munmap(m_window, m_window_size);
+#endif
+
+  m_window        = nullptr;
+  m_window_offset = 0;
+  m_window_size   = 0;
+}
+
+void
+mm_mmap_io_c::advise_will_need(uint64_t offset,
+                               size_t size) {
+#if defined(MADV_WILLNEED)
+  if (!m_window || (offset < m_window_offset) || (offset >= (m_window_offset + m_window_size)))
+    return;
+
+  auto start = offset - (offset % allocation_granularity());
+  size       = std::min<uint64_t>(size + offset - start, m_window_offset + m_window_size - start);
+
+  madvise(m_window + (start - m_window_offset), size, MADV_WILLNEED);
+
+#else
+  (void)offset;
+  (void)size;
+#endif
+}
+
+unsigned char const *
+mm_mmap_io_c::get_direct_pointer(size_t size) {
+  if ((m_pos >= m_file_size) || (size > (m_file_size - m_pos)))
+    return nullptr;
+
+  auto covered = m_window && (m_pos >= m_window_offset) && ((m_pos + size) <= (m_window_offset + m_window_size));
+  if (!covered && !map_window(m_pos, size))
+    return nullptr;
+
+  return m_window + (m_pos - m_window_offset);
+}
+
+unsigned char const *
+mm_mmap_io_c::read_direct(size_t &size) {
+  size = std::min<uint64_t>(size, m_pos < m_file_size ? m_file_size - m_pos : 0);
+  if (!size)
+    return nullptr;
+
+  auto data = get_direct_pointer(size);
+  if (data)
+    m_pos += size;
+
+  return data;
+}
+
+uint32
+mm_mmap_io_c::_read(void *buffer,
+                    size_t size) {
+  auto dest     = static_cast<unsigned char *>(buffer);
+  auto num_read = size_t{};
+
+  while ((num_read < size) && (m_pos < m_file_size)) {
+    auto covered = m_window && (m_pos >= m_window_offset) && (m_pos < (m_window_offset + m_window_size));
+    if (!covered && !map_window(m_pos, 1))
+      throw mtx::mm_io::read_write_x{mtx::mm_io::make_error_code()};
+
+    auto available = std::min<uint64_t>(m_window_offset + m_window_size - m_pos, size - num_read);
+
+    std::memcpy(dest + num_read, m_window + (m_pos - m_window_offset), available);
+    num_read += available;
+    m_pos    += available;
+  }
+
+  if (num_read < size)
+    m_eof = true;
+
+  return num_read;
+}
+
+size_t
+mm_mmap_io_c::_write(const void *,
+                     size_t) {
+  throw mtx::mm_io::wrong_read_write_access_x();
+}
+
+uint64
+mm_mmap_io_c::getFilePointer() {
+  return m_pos;
+}
+
+void
+mm_mmap_io_c::setFilePointer(int64 offset,
+                             seek_mode mode) {
+  int64_t new_pos = seek_beginning == mode ? offset
+                  : seek_end       == mode ? static_cast<int64_t>(m_file_size) + offset
+                  :                          static_cast<int64_t>(m_pos)       + offset;
+
+  if (0 > new_pos)
+    throw mtx::mm_io::seek_x{std::make_error_code(std::errc::invalid_argument)};
+
+  // Only give the OS a hint when leaving the area it is already
+  // reading ahead anyway.
+  if ((static_cast<uint64_t>(new_pos) < m_pos) || (static_cast<uint64_t>(new_pos) > (m_pos + s_will_need_size)))
+    advise_will_need(new_pos, s_will_need_size);
+
+  m_pos = new_pos;
+  m_eof = false;
+}
+
+int64_t
+mm_mmap_io_c::get_size() {
+  return m_file_size;
+}
+
+bool
+mm_mmap_io_c::eof() {
+  return m_eof;
+}
+
+void
+mm_mmap_io_c::clear_eof() {
+  m_eof = false;
+}
+
+void
+mm_mmap_io_c::close() {
+  unmap_window();
+
+#if defined(SYS_WINDOWS)
+  if (m_mapping)
+    CloseHandle(static_cast<HANDLE>(m_mapping));
+  if (m_file)
+    CloseHandle(static_cast<HANDLE>(m_file));
+
+  m_mapping = nullptr;
+  m_file    = nullptr;
+
+#else
+  if (-1 != m_file)
+    ::close(m_file);
+
+  m_file = -1;
+#endif
+}
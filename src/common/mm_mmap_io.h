@@ -0,0 +1,88 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   IO callback class definitions for memory-mapped input files
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_COMMON_MM_MMAP_IO_H
+#define MTX_COMMON_MM_MMAP_IO_H
+
+#include "common/common_pch.h"
+
+#include "common/mm_io.h"
+
+/* Read-only access to a local file via a memory mapping. On 64-bit
+   systems the whole file is mapped at once. On 32-bit systems only a
+   window of the file is mapped which is moved around as needed.
+
+   Readers can use get_direct_pointer() or read_direct() in order to
+   access the file's content without copying it. Mapped memory is
+   read-only and must not be written to. */
+class mm_mmap_io_c: public mm_io_c {
+protected:
+  std::string m_file_name;
+  uint64_t m_file_size, m_pos;
+  bool m_eof;
+
+  unsigned char *m_window;
+  uint64_t m_window_offset;
+  size_t m_window_size;
+
+#if defined(SYS_WINDOWS)
+  void *m_file, *m_mapping;
+#else
+  int m_file;
+#endif
+
+public:
+  mm_mmap_io_c(std::string const &file_name);
+  virtual ~mm_mmap_io_c();
+
+  virtual uint64 getFilePointer();
+  virtual void setFilePointer(int64 offset, seek_mode mode = seek_beginning);
+  virtual int64_t get_size();
+  virtual void close();
+  virtual bool eof();
+  virtual void clear_eof();
+
+  virtual std::string get_file_name() const {
+    return m_file_name;
+  }
+
+  // Returns a pointer to the next 'size' bytes starting at the current
+  // position without advancing it, or nullptr if fewer than 'size'
+  // bytes are left or if they cannot be mapped at once. If the whole
+  // file is mapped the pointer stays valid until the file is closed;
+  // otherwise only until the next read or call to this function.
+  unsigned char const *get_direct_pointer(size_t size);
+
+  // Same as get_direct_pointer() but advances the position. If fewer
+  // than 'size' bytes are left then 'size' is reduced accordingly.
+  // Returns nullptr without changing the position if nothing is left
+  // or if the data cannot be mapped; callers should fall back to
+  // read() in that case.
+  unsigned char const *read_direct(size_t &size);
+
+  // Tries to map the file and falls back to an mm_file_io_c with a
+  // read buffer if that fails.
+  static mm_io_cptr open(std::string const &file_name, size_t fallback_buffer_size = 1 << 17);
+
+protected:
+  virtual uint32 _read(void *buffer, size_t size);
+  virtual size_t _write(const void *buffer, size_t size);
+
+  bool map_window(uint64_t offset, size_t min_size);
+  void unmap_window();
+  void advise_will_need(uint64_t offset, size_t size);
+};
+
+using mm_mmap_io_cptr = std::shared_ptr<mm_mmap_io_c>;
+
+#endif // MTX_COMMON_MM_MMAP_IO_H
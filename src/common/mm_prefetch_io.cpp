@@ -0,0 +1,290 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   IO callback class implementation for reading ahead in a background thread
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "common/mm_io_x.h"
+#include "common/mm_prefetch_io.h"
+
+mm_prefetch_io_c::mm_prefetch_io_c(mm_io_c *in,
+                                   size_t buffer_size,
+                                   unsigned int num_buffers,
+                                   bool delete_in)
+  : mm_proxy_io_c(in, delete_in)
+  , m_buffer_size{buffer_size}
+  , m_num_buffers{std::max(num_buffers, 1u)}
+  , m_size{in->get_size()}
+  , m_pos{}
+  , m_eof{}
+  , m_current{}
+  , m_next_offset{}
+  , m_generation{}
+  , m_num_wanted{1}
+  , m_end_reached{}
+  , m_stop_requested{}
+  , m_num_blocks_read{}
+  , m_num_stalls{}
+  , m_num_restarts{}
+  , m_debug{"prefetch_io"}
+{
+  m_thread = std::thread{[this]() { run(); }};
+}
+
+mm_prefetch_io_c::~mm_prefetch_io_c() {
+  close();
+}
+
+void
+mm_prefetch_io_c::close() {
+  stop();
+
+  mxdebug_if(m_debug && m_proxy_io,
+             boost::format("mm_prefetch_io_c: %1%: %2% blocks read, %3% stalls, %4% restarts\n")
+             % get_file_name() % m_num_blocks_read % m_num_stalls % m_num_restarts);
+
+  mm_proxy_io_c::close();
+}
+
+void
+mm_prefetch_io_c::stop() {
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_stop_requested = true;
+  }
+
+  m_cond_worker.notify_all();
+
+  if (m_thread.joinable())
+    m_thread.join();
+}
+
+void
+mm_prefetch_io_c::run() {
+  while (true) {
+    memory_cptr buffer;
+    int64_t offset;
+    unsigned int generation;
+
+    {
+      std::unique_lock<std::mutex> lock{m_mutex};
+
+      m_cond_worker.wait(lock, [this]() {
+        return m_stop_requested || (!m_end_reached && !m_exception && (m_ready_blocks.size() < m_num_wanted));
+      });
+
+      if (m_stop_requested)
+        return;
+
+      offset     = m_next_offset;
+      generation = m_generation;
+
+      if (!m_free_buffers.empty()) {
+        buffer = m_free_buffers.back();
+        m_free_buffers.pop_back();
+
+      } else
+        buffer = memory_c::alloc(m_buffer_size);
+    }
+
+    auto fill      = size_t{};
+    auto exception = std::exception_ptr{};
+
+    try {
+      if (offset < m_size) {
+        if (static_cast<int64_t>(m_proxy_io->getFilePointer()) != offset)
+          m_proxy_io->setFilePointer(offset, seek_beginning);
+
+        fill = m_proxy_io->read(buffer->get_buffer(), std::min<int64_t>(m_buffer_size, m_size - offset));
+      }
+
+    } catch (...) {
+      exception = std::current_exception();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+
+      if (generation != m_generation)
+        // The reader has seeked elsewhere in the meantime.
+        m_free_buffers.push_back(buffer);
+
+      else if (exception) {
+        m_exception = exception;
+        m_free_buffers.push_back(buffer);
+
+      } else {
+        if (fill)
+          m_ready_blocks.push_back(block_t{offset, buffer, fill});
+        else
+          m_free_buffers.push_back(buffer);
+
+        m_next_offset += fill;
+        m_end_reached  = (fill < m_buffer_size) || (m_next_offset >= m_size);
+        ++m_num_blocks_read;
+      }
+    }
+
+    m_cond_reader.notify_all();
+  }
+}
+
+void
+mm_prefetch_io_c::recycle(block_t &block) {
+  if (block.data)
+    m_free_buffers.push_back(block.data);
+
+  block = block_t{};
+}
+
+void
+mm_prefetch_io_c::restart_at(int64_t offset) {
+  for (auto &block : m_ready_blocks)
+    recycle(block);
+
+  m_ready_blocks.clear();
+  m_exception   = nullptr;
+  m_next_offset = offset;
+  m_end_reached = false;
+  m_num_wanted  = 1;
+  ++m_generation;
+  ++m_num_restarts;
+
+  m_cond_worker.notify_all();
+}
+
+bool
+mm_prefetch_io_c::fetch_next_block() {
+  std::unique_lock<std::mutex> lock{m_mutex};
+
+  // Only read further ahead once the caller has read a whole buffer
+  // sequentially.
+  auto sequential = m_current.data && ((m_current.offset + static_cast<int64_t>(m_current.fill)) == m_pos);
+
+  recycle(m_current);
+
+  while (true) {
+    while (!m_ready_blocks.empty() && ((m_ready_blocks.front().offset + static_cast<int64_t>(m_ready_blocks.front().fill)) <= m_pos)) {
+      recycle(m_ready_blocks.front());
+      m_ready_blocks.pop_front();
+    }
+
+    if (!m_ready_blocks.empty() && (m_ready_blocks.front().offset > m_pos))
+      restart_at(m_pos);
+
+    if (!m_ready_blocks.empty()) {
+      m_current = m_ready_blocks.front();
+      m_ready_blocks.pop_front();
+
+      if (sequential)
+        m_num_wanted = std::min(m_num_wanted * 2, m_num_buffers);
+
+      m_cond_worker.notify_all();
+
+      return true;
+    }
+
+    if (m_exception)
+      std::rethrow_exception(m_exception);
+
+    if (m_next_offset != m_pos)
+      restart_at(m_pos);
+
+    else if (m_end_reached)
+      return false;
+
+    ++m_num_stalls;
+    m_cond_reader.wait(lock);
+  }
+}
+
+uint64
+mm_prefetch_io_c::getFilePointer() {
+  return m_pos;
+}
+
+void
+mm_prefetch_io_c::setFilePointer(int64 offset,
+                                 seek_mode mode) {
+  int64_t new_pos = seek_beginning == mode ? offset
+                  : seek_end       == mode ? m_size + offset // offsets from the end are negative already
+                  :                          m_pos  + offset;
+
+  if (0 > new_pos)
+    throw mtx::mm_io::seek_x{std::make_error_code(std::errc::invalid_argument)};
+
+  m_pos = new_pos;
+  m_eof = false;
+
+  // Still within or right after the current buffer?
+  if (m_current.data && (new_pos >= m_current.offset) && (new_pos <= (m_current.offset + static_cast<int64_t>(m_current.fill))))
+    return;
+
+  std::lock_guard<std::mutex> lock{m_mutex};
+
+  // Within one of the buffers already read ahead?
+  for (auto const &block : m_ready_blocks)
+    if ((new_pos >= block.offset) && (new_pos < (block.offset + static_cast<int64_t>(block.fill))))
+      return;
+
+  // Where the background thread is about to continue anyway?
+  if (m_ready_blocks.empty() && (new_pos == m_next_offset))
+    return;
+
+  restart_at(new_pos);
+}
+
+int64_t
+mm_prefetch_io_c::get_size() {
+  return m_size;
+}
+
+bool
+mm_prefetch_io_c::eof() {
+  return m_eof;
+}
+
+void
+mm_prefetch_io_c::clear_eof() {
+  m_eof = false;
+}
+
+uint32
+mm_prefetch_io_c::_read(void *buffer,
+                        size_t size) {
+  auto dest     = static_cast<unsigned char *>(buffer);
+  auto num_read = size_t{};
+
+  while (num_read < size) {
+    auto in_current = m_current.data && (m_pos >= m_current.offset) && (m_pos < (m_current.offset + static_cast<int64_t>(m_current.fill)));
+
+    if (!in_current && !fetch_next_block()) {
+      m_eof = true;
+      break;
+    }
+
+    auto offset_in_block = static_cast<size_t>(m_pos - m_current.offset);
+    auto available       = std::min(m_current.fill - offset_in_block, size - num_read);
+
+    std::memcpy(dest + num_read, m_current.data->get_buffer() + offset_in_block, available);
+    num_read += available;
+    m_pos    += available;
+  }
+
+  return num_read;
+}
+
+size_t
+mm_prefetch_io_c::_write(const void *,
+                         size_t) {
+  throw mtx::mm_io::wrong_read_write_access_x();
+}
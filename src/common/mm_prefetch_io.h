@@ -0,0 +1,91 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   IO callback class definitions for reading ahead in a background thread
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_COMMON_MM_PREFETCH_IO_H
+#define MTX_COMMON_MM_PREFETCH_IO_H
+
+#include "common/common_pch.h"
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include "common/mm_io.h"
+
+/* A read-only proxy that keeps up to a number of large buffers filled
+   by a background thread ahead of the current file position. Only the
+   background thread accesses the proxied object once the constructor
+   has finished.
+
+   Seeking to a position that is neither inside the buffer currently
+   being read from nor inside one of the buffers already filled drops
+   all of them and restarts reading ahead at the new position. Right
+   after such a seek only a single buffer is read ahead so that
+   scattered access (e.g. while parsing headers) doesn't cause a lot of
+   unnecessary reads. */
+class mm_prefetch_io_c: public mm_proxy_io_c {
+protected:
+  struct block_t {
+    int64_t offset;
+    memory_cptr data;
+    size_t fill;
+  };
+
+  size_t const m_buffer_size;
+  unsigned int const m_num_buffers;
+  int64_t m_size, m_pos;
+  bool m_eof;
+
+  // Only used by the thread reading from this object.
+  block_t m_current;
+
+  // Shared with the background thread.
+  std::thread m_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_cond_worker, m_cond_reader;
+  std::deque<block_t> m_ready_blocks;
+  std::vector<memory_cptr> m_free_buffers;
+  int64_t m_next_offset;
+  unsigned int m_generation, m_num_wanted;
+  bool m_end_reached, m_stop_requested;
+  std::exception_ptr m_exception;
+
+  uint64_t m_num_blocks_read, m_num_stalls, m_num_restarts;
+  debugging_option_c m_debug;
+
+public:
+  mm_prefetch_io_c(mm_io_c *in, size_t buffer_size = 2 * 1024 * 1024, unsigned int num_buffers = 8, bool delete_in = true);
+  virtual ~mm_prefetch_io_c();
+
+  virtual uint64 getFilePointer();
+  virtual void setFilePointer(int64 offset, seek_mode mode = seek_beginning);
+  virtual int64_t get_size();
+  virtual bool eof();
+  virtual void clear_eof();
+  virtual void close();
+
+protected:
+  virtual uint32 _read(void *buffer, size_t size);
+  virtual size_t _write(const void *buffer, size_t size);
+
+  void run();
+  void stop();
+  bool fetch_next_block();
+  void restart_at(int64_t offset);
+  void recycle(block_t &block);
+};
+
+using mm_prefetch_io_cptr = std::shared_ptr<mm_prefetch_io_c>;
+
+#endif // MTX_COMMON_MM_PREFETCH_IO_H
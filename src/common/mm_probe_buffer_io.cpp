@@ -0,0 +1,150 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   IO callback class implementation
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "common/mm_io_x.h"
+#include "common/mm_probe_buffer_io.h"
+
+mm_probe_buffer_io_c::mm_probe_buffer_io_c(mm_io_c *in,
+                                           size_t max_head_size,
+                                           bool delete_in)
+  : mm_proxy_io_c(in, delete_in)
+  , m_head{memory_c::alloc(0)}
+  , m_pos{}
+  , m_file_size{static_cast<uint64_t>(in->get_size())}
+  , m_num_bytes_read_through{}
+  , m_max_head_size{static_cast<size_t>(std::min<uint64_t>(max_head_size, m_file_size))}
+  , m_eof{}
+{
+}
+
+mm_probe_buffer_io_c::~mm_probe_buffer_io_c() {
+  close();
+}
+
+uint64
+mm_probe_buffer_io_c::getFilePointer() {
+  return m_pos;
+}
+
+void
+mm_probe_buffer_io_c::setFilePointer(int64 offset,
+                                     seek_mode mode) {
+  int64_t new_pos = seek_beginning == mode ? offset
+                  : seek_current   == mode ? static_cast<int64_t>(m_pos)       + offset
+                  : seek_end       == mode ? static_cast<int64_t>(m_file_size) + offset // offsets from the end are negative already
+                  :                          -1;
+
+  if (0 > new_pos)
+    throw mtx::mm_io::seek_x();
+
+  m_pos = std::min<uint64_t>(new_pos, m_file_size);
+  m_eof = false;
+}
+
+int64_t
+mm_probe_buffer_io_c::get_size() {
+  return m_file_size;
+}
+
+bool
+mm_probe_buffer_io_c::eof() {
+  return m_eof;
+}
+
+void
+mm_probe_buffer_io_c::clear_eof() {
+  m_eof = false;
+}
+
+unsigned char const *
+mm_probe_buffer_io_c::get_head() {
+  fill_head(ms_min_fill_size);
+  return m_head->get_buffer();
+}
+
+size_t
+mm_probe_buffer_io_c::get_head_size() {
+  fill_head(ms_min_fill_size);
+  return m_head->get_size();
+}
+
+// Makes the buffer cover at least the area up to 'end_pos' unless
+// that exceeds the maximum buffer size. The buffer grows at least by
+// doubling its size so that a prober reading small pieces one after
+// the other doesn't cause lots of small reads.
+void
+mm_probe_buffer_io_c::fill_head(uint64_t end_pos) {
+  auto head_size = m_head->get_size();
+  if ((end_pos <= head_size) || (head_size >= m_max_head_size))
+    return;
+
+  auto new_size = std::min<uint64_t>(std::max<uint64_t>({ end_pos, head_size * 2, ms_min_fill_size }), m_max_head_size);
+
+  m_head->resize(new_size);
+  m_proxy_io->setFilePointer(head_size, seek_beginning);
+  auto num_read = m_proxy_io->read(m_head->get_buffer() + head_size, new_size - head_size);
+
+  m_head->resize(head_size + num_read);
+  if ((head_size + num_read) < new_size)
+    // Don't try to read past a short read again.
+    m_max_head_size = head_size + num_read;
+}
+
+uint64_t
+mm_probe_buffer_io_c::get_num_bytes_read_through()
+  const {
+  return m_num_bytes_read_through;
+}
+
+uint32
+mm_probe_buffer_io_c::_read(void *buffer,
+                            size_t size) {
+  // Only extend the buffer if the read starts inside it or right
+  // after it. Reads further into the file must not pull in
+  // everything in between.
+  if (m_pos <= m_head->get_size())
+    fill_head(m_pos + size);
+
+  auto dst       = static_cast<unsigned char *>(buffer);
+  auto head_size = m_head->get_size();
+  auto num_read  = size_t{};
+
+  if (m_pos < head_size) {
+    num_read = std::min<size_t>(size, head_size - m_pos);
+    std::memcpy(dst, m_head->get_buffer() + m_pos, num_read);
+    m_pos += num_read;
+  }
+
+  if ((num_read < size) && (m_pos < m_file_size)) {
+    m_proxy_io->setFilePointer(m_pos, seek_beginning);
+
+    auto num_read_through     = m_proxy_io->read(dst + num_read, size - num_read);
+    num_read                 += num_read_through;
+    m_pos                    += num_read_through;
+    m_num_bytes_read_through += num_read_through;
+  }
+
+  if (num_read < size)
+    m_eof = true;
+
+  return num_read;
+}
+
+size_t
+mm_probe_buffer_io_c::_write(const void *,
+                             size_t) {
+  throw mtx::mm_io::wrong_read_write_access_x();
+  return 0;
+}
@@ -0,0 +1,59 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   IO callback class definitions
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_COMMON_MM_PROBE_BUFFER_IO_H
+#define MTX_COMMON_MM_PROBE_BUFFER_IO_H
+
+#include "common/common_pch.h"
+
+#include "common/mm_io.h"
+
+/* Buffers the start of a file and serves all reads from that area out
+   of memory. Meant for file type detection where lots of probe
+   functions seek back to the start of the file and read the same data
+   over and over again. The buffer is filled on demand and grows up to
+   'max_head_size' bytes as reads reach its end. Reads beyond that are
+   passed on to the underlying file. */
+class mm_probe_buffer_io_c: public mm_proxy_io_c {
+protected:
+  static size_t const ms_min_fill_size = 64 * 1024;
+
+  memory_cptr m_head;
+  uint64_t m_pos, m_file_size, m_num_bytes_read_through;
+  size_t m_max_head_size;
+  bool m_eof;
+
+public:
+  mm_probe_buffer_io_c(mm_io_c *in, size_t max_head_size, bool delete_in = true);
+  virtual ~mm_probe_buffer_io_c();
+
+  virtual uint64 getFilePointer();
+  virtual void setFilePointer(int64 offset, seek_mode mode = seek_beginning);
+  virtual int64_t get_size();
+  virtual bool eof();
+  virtual void clear_eof();
+
+  unsigned char const *get_head();
+  size_t get_head_size();
+  uint64_t get_num_bytes_read_through() const;
+
+protected:
+  virtual uint32 _read(void *buffer, size_t size);
+  virtual size_t _write(const void *buffer, size_t size);
+
+  void fill_head(uint64_t end_pos);
+};
+
+using mm_probe_buffer_io_cptr = std::shared_ptr<mm_probe_buffer_io_c>;
+
+#endif // MTX_COMMON_MM_PROBE_BUFFER_IO_H
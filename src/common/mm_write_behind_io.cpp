@@ -0,0 +1,307 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   IO callback class implementation for writing in a background thread
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "common/mm_io_x.h"
+#include "common/mm_write_behind_io.h"
+
+mm_write_behind_io_c::mm_write_behind_io_c(mm_io_c *out,
+                                           size_t buffer_size,
+                                           unsigned int num_buffers,
+                                           bool delete_out)
+  : mm_write_buffer_io_c(out, buffer_size, delete_out)
+  , m_pos(out->getFilePointer())
+  , m_file_size{out->get_size()}
+  , m_preallocated{}
+  , m_num_buffers{std::max(num_buffers, 1u)}
+  , m_writing{}
+  , m_stop_requested{}
+  , m_num_blocks_written{}
+  , m_num_stalls{}
+  , m_debug{"write_behind_io"}
+{
+  m_thread = std::thread{[this]() { run(); }};
+}
+
+mm_write_behind_io_c::~mm_write_behind_io_c() {
+  try {
+    close();
+  } catch (...) {
+  }
+}
+
+mm_io_cptr
+mm_write_behind_io_c::open(std::string const &file_name,
+                           size_t buffer_size,
+                           unsigned int num_buffers) {
+  return mm_io_cptr(new mm_write_behind_io_c(new mm_file_io_c(file_name, MODE_CREATE), buffer_size, num_buffers));
+}
+
+void
+mm_write_behind_io_c::run() {
+  while (true) {
+    block_t block;
+
+    {
+      std::unique_lock<std::mutex> lock{m_mutex};
+
+      m_cond_writer.wait(lock, [this]() { return m_stop_requested || !m_pending_blocks.empty(); });
+
+      if (m_pending_blocks.empty())
+        return;
+
+      block = m_pending_blocks.front();
+      m_pending_blocks.pop_front();
+      m_writing = true;
+    }
+
+    auto exception = std::exception_ptr{};
+
+    try {
+      if (static_cast<int64_t>(m_proxy_io->getFilePointer()) != block.offset)
+        m_proxy_io->setFilePointer(block.offset, seek_beginning);
+
+      if (m_proxy_io->write(block.data->get_buffer(), block.fill) != block.fill)
+        throw mtx::mm_io::insufficient_space_x{};
+
+    } catch (...) {
+      exception = std::current_exception();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+
+      m_free_buffers.push_back(block.data);
+      m_writing = false;
+      ++m_num_blocks_written;
+
+      if (exception && !m_exception)
+        m_exception = exception;
+
+      // Nothing else can be written correctly after a failed write.
+      if (m_exception) {
+        for (auto const &other_block : m_pending_blocks)
+          m_free_buffers.push_back(other_block.data);
+        m_pending_blocks.clear();
+      }
+    }
+
+    m_cond_caller.notify_all();
+  }
+}
+
+void
+mm_write_behind_io_c::rethrow_writer_exception() {
+  if (!m_exception)
+    return;
+
+  auto exception = m_exception;
+  m_exception    = nullptr;
+
+  std::rethrow_exception(exception);
+}
+
+void
+mm_write_behind_io_c::flush_buffer() {
+  if (!m_fill)
+    return;
+
+  std::unique_lock<std::mutex> lock{m_mutex};
+
+  if (!m_exception && (m_pending_blocks.size() >= m_num_buffers)) {
+    ++m_num_stalls;
+    m_cond_caller.wait(lock, [this]() { return !!m_exception || (m_pending_blocks.size() < m_num_buffers); });
+  }
+
+  // Nothing can be written after a failed write. The buffered data
+  // must be dropped; otherwise closing the object, e.g. from
+  // mm_write_buffer_io_c's destructor, would try to write it again.
+  if (m_exception) {
+    m_fill = 0;
+    rethrow_writer_exception();
+  }
+
+  m_pending_blocks.push_back(block_t{m_pos - static_cast<int64_t>(m_fill), m_af_buffer, m_fill});
+
+  if (!m_free_buffers.empty()) {
+    m_af_buffer = m_free_buffers.back();
+    m_free_buffers.pop_back();
+
+  } else
+    m_af_buffer = memory_c::alloc(m_size);
+
+  m_buffer = m_af_buffer->get_buffer();
+  m_fill   = 0;
+
+  m_cond_writer.notify_all();
+}
+
+void
+mm_write_behind_io_c::wait_for_writer() {
+  flush_buffer();
+
+  std::unique_lock<std::mutex> lock{m_mutex};
+  m_cond_caller.wait(lock, [this]() { return m_pending_blocks.empty() && !m_writing; });
+
+  rethrow_writer_exception();
+}
+
+uint64
+mm_write_behind_io_c::getFilePointer() {
+  return m_pos;
+}
+
+void
+mm_write_behind_io_c::setFilePointer(int64 offset,
+                                     seek_mode mode) {
+  int64_t new_pos = seek_beginning == mode ? offset
+                  : seek_end       == mode ? m_file_size + offset // offsets from the end are negative already
+                  :                          m_pos       + offset;
+
+  if (0 > new_pos)
+    throw mtx::mm_io::seek_x{std::make_error_code(std::errc::invalid_argument)};
+
+  if (new_pos == m_pos)
+    return;
+
+  mxdebug_if(m_debug_seek, boost::format("seek from %1% to %2% diff %3%\n") % m_pos % new_pos % (new_pos - m_pos));
+
+  // The buffer's position is determined by the current position.
+  flush_buffer();
+  m_pos = new_pos;
+}
+
+int64_t
+mm_write_behind_io_c::get_size() {
+  return m_file_size;
+}
+
+bool
+mm_write_behind_io_c::eof() {
+  return m_pos >= m_file_size;
+}
+
+void
+mm_write_behind_io_c::clear_eof() {
+}
+
+uint32
+mm_write_behind_io_c::_read(void *buffer,
+                            size_t size) {
+  wait_for_writer();
+
+  m_proxy_io->setFilePointer(m_pos, seek_beginning);
+  auto num_read  = m_proxy_io->read(buffer, size);
+  m_pos         += num_read;
+
+  return num_read;
+}
+
+size_t
+mm_write_behind_io_c::_write(const void *buffer,
+                             size_t size) {
+  auto src    = static_cast<unsigned char const *>(buffer);
+  auto remain = size;
+
+  while (remain) {
+    auto avail = std::min(m_size - m_fill, remain);
+
+    std::memcpy(m_buffer + m_fill, src, avail);
+    m_fill += avail;
+    m_pos  += avail;
+    src    += avail;
+    remain -= avail;
+
+    if (m_fill == m_size)
+      flush_buffer();
+  }
+
+  m_file_size   = std::max(m_file_size, m_pos);
+  m_cached_size = -1;
+
+  return size;
+}
+
+void
+mm_write_behind_io_c::flush() {
+  wait_for_writer();
+  m_proxy_io->flush();
+}
+
+int
+mm_write_behind_io_c::truncate(int64_t pos) {
+  wait_for_writer();
+
+  m_proxy_io->flush();
+  auto result = m_proxy_io->truncate(pos);
+  if (!result)
+    m_file_size = pos;
+
+  return result;
+}
+
+void
+mm_write_behind_io_c::preallocate(int64_t size) {
+  wait_for_writer();
+
+  auto file = dynamic_cast<mm_file_io_c *>(m_proxy_io);
+  if (file && (size > m_file_size) && file->preallocate(size))
+    m_preallocated = size;
+
+  mxdebug_if(m_debug, boost::format("mm_write_behind_io_c: preallocating %1% bytes: %2%\n") % size % (m_preallocated ? "OK" : "failed"));
+}
+
+void
+mm_write_behind_io_c::discard_buffer() {
+  m_pos  -= m_fill;
+  m_fill  = 0;
+}
+
+void
+mm_write_behind_io_c::close() {
+  if (!m_proxy_io)
+    return;
+
+  auto exception = std::exception_ptr{};
+
+  try {
+    wait_for_writer();
+  } catch (...) {
+    exception = std::current_exception();
+    m_fill    = 0;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_stop_requested = true;
+  }
+
+  m_cond_writer.notify_all();
+
+  if (m_thread.joinable())
+    m_thread.join();
+
+  // Release the disk space reserved beyond the end of the file.
+  if (m_preallocated > m_file_size) {
+    m_proxy_io->flush();
+    m_proxy_io->truncate(m_file_size);
+  }
+
+  mxdebug_if(m_debug, boost::format("mm_write_behind_io_c: %1%: %2% blocks written, %3% stalls\n") % get_file_name() % m_num_blocks_written % m_num_stalls);
+
+  mm_proxy_io_c::close();
+
+  if (exception)
+    std::rethrow_exception(exception);
+}
@@ -0,0 +1,92 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   IO callback class definitions for writing in a background thread
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_COMMON_MM_WRITE_BEHIND_IO_H
+#define MTX_COMMON_MM_WRITE_BEHIND_IO_H
+
+#include "common/common_pch.h"
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include "common/mm_write_buffer_io.h"
+
+/* A write buffer that hands full buffers over to a background thread
+   which writes them to the proxied object while the caller goes on
+   filling the next one. Each buffer remembers the position it has to
+   be written at, and buffers are written in the order they were
+   filled. Therefore seeking elsewhere and overwriting data that has
+   been written before only submits the current buffer without having
+   to wait for the background thread.
+
+   Reading, flushing, truncating and closing wait until all submitted
+   buffers have been written; afterwards the proxied object is accessed
+   directly. Errors occurring in the background thread are re-thrown by
+   the next call to one of the writing or waiting functions. */
+class mm_write_behind_io_c: public mm_write_buffer_io_c {
+protected:
+  struct block_t {
+    int64_t offset;
+    memory_cptr data;
+    size_t fill;
+  };
+
+  int64_t m_pos, m_file_size, m_preallocated;
+  unsigned int const m_num_buffers;
+
+  std::thread m_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_cond_writer, m_cond_caller;
+  std::deque<block_t> m_pending_blocks;
+  std::vector<memory_cptr> m_free_buffers;
+  bool m_writing, m_stop_requested;
+  std::exception_ptr m_exception;
+
+  uint64_t m_num_blocks_written, m_num_stalls;
+  debugging_option_c m_debug;
+
+public:
+  mm_write_behind_io_c(mm_io_c *out, size_t buffer_size, unsigned int num_buffers, bool delete_out = true);
+  virtual ~mm_write_behind_io_c();
+
+  virtual uint64 getFilePointer();
+  virtual void setFilePointer(int64 offset, seek_mode mode = seek_beginning);
+  virtual int64_t get_size();
+  virtual bool eof();
+  virtual void clear_eof();
+  virtual void flush();
+  virtual void close();
+  virtual int truncate(int64_t pos);
+  virtual void discard_buffer();
+
+  // Reserves disk space for the expected size of the output file if
+  // the proxied object supports it. Space not needed is released when
+  // the file is closed.
+  virtual void preallocate(int64_t size);
+
+  static mm_io_cptr open(std::string const &file_name, size_t buffer_size, unsigned int num_buffers);
+
+protected:
+  virtual uint32 _read(void *buffer, size_t size);
+  virtual size_t _write(const void *buffer, size_t size);
+  virtual void flush_buffer();
+
+  void wait_for_writer();
+  void rethrow_writer_exception();
+  void run();
+};
+using mm_write_behind_io_cptr = std::shared_ptr<mm_write_behind_io_c>;
+
+#endif // MTX_COMMON_MM_WRITE_BEHIND_IO_H
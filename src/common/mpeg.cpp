@@ -12,54 +12,249 @@
 
 #include "common/common_pch.h"
 
+#if defined(__SSE2__)
+# define MTX_MPEG_SSE2_SCANNER 1
+# include <emmintrin.h>
+#endif
+
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)))
+# define MTX_MPEG_AVX2_SCANNER 1
+# include <immintrin.h>
+#endif
+
 #include "common/endian.h"
 #include "common/mpeg.h"
 
 namespace mtx { namespace mpeg {
 
-memory_cptr
-nalu_to_rbsp(memory_cptr const &buffer) {
-  int pos, size = buffer->get_size();
-  mm_mem_io_c d(nullptr, size, 100);
-  unsigned char *b = buffer->get_buffer();
-
-  for (pos = 0; pos < size; ++pos) {
-    if (   ((pos + 2) < size)
-        && (0 == b[pos])
-        && (0 == b[pos + 1])
-        && (3 == b[pos + 2])) {
-      d.write_uint8(0);
-      d.write_uint8(0);
-      pos += 2;
-
-    } else
-      d.write_uint8(b[pos]);
+namespace {
+
+using byte_sequence_finder_t = unsigned char const *(*)(unsigned char const *, unsigned char const *, unsigned char, unsigned char, unsigned char);
+
+unsigned char const *
+find_byte_sequence_scalar(unsigned char const *begin,
+                          unsigned char const *end,
+                          unsigned char byte0,
+                          unsigned char byte1,
+                          unsigned char byte2) {
+  while ((end - begin) >= 3) {
+    begin = static_cast<unsigned char const *>(std::memchr(begin, byte0, end - begin - 2));
+    if (!begin)
+      return end;
+
+    if ((begin[1] == byte1) && (begin[2] == byte2))
+      return begin;
+
+    ++begin;
+  }
+
+  return end;
+}
+
+#if defined(MTX_MPEG_SSE2_SCANNER)
+unsigned char const *
+find_byte_sequence_sse2(unsigned char const *begin,
+                        unsigned char const *end,
+                        unsigned char byte0,
+                        unsigned char byte1,
+                        unsigned char byte2) {
+  auto pattern0 = _mm_set1_epi8(static_cast<char>(byte0));
+  auto pattern1 = _mm_set1_epi8(static_cast<char>(byte1));
+  auto pattern2 = _mm_set1_epi8(static_cast<char>(byte2));
+
+  // Each iteration looks at 16 possible starting positions. Bit n of
+  // the mask is set if the sequence starts at begin + n.
+  while ((end - begin) >= (16 + 2)) {
+    auto matches0 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const *>(begin)),     pattern0);
+    auto matches1 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const *>(begin + 1)), pattern1);
+    auto matches2 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const *>(begin + 2)), pattern2);
+    auto mask     = _mm_movemask_epi8(_mm_and_si128(_mm_and_si128(matches0, matches1), matches2));
+
+    if (mask)
+      return begin + __builtin_ctz(mask);
+
+    begin += 16;
+  }
+
+  return find_byte_sequence_scalar(begin, end, byte0, byte1, byte2);
+}
+#endif
+
+#if defined(MTX_MPEG_AVX2_SCANNER)
+__attribute__((target("avx2")))
+unsigned char const *
+find_byte_sequence_avx2(unsigned char const *begin,
+                        unsigned char const *end,
+                        unsigned char byte0,
+                        unsigned char byte1,
+                        unsigned char byte2) {
+  auto pattern0 = _mm256_set1_epi8(static_cast<char>(byte0));
+  auto pattern1 = _mm256_set1_epi8(static_cast<char>(byte1));
+  auto pattern2 = _mm256_set1_epi8(static_cast<char>(byte2));
+
+  while ((end - begin) >= (32 + 2)) {
+    auto matches0 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(begin)),     pattern0);
+    auto matches1 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(begin + 1)), pattern1);
+    auto matches2 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(begin + 2)), pattern2);
+    auto mask     = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_and_si256(matches0, matches1), matches2)));
+
+    if (mask)
+      return begin + __builtin_ctz(mask);
+
+    begin += 32;
+  }
+
+  return find_byte_sequence_scalar(begin, end, byte0, byte1, byte2);
+}
+#endif
+
+byte_sequence_finder_t
+select_byte_sequence_finder() {
+#if defined(MTX_MPEG_AVX2_SCANNER)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return find_byte_sequence_avx2;
+#endif
+
+#if defined(MTX_MPEG_SSE2_SCANNER)
+  return find_byte_sequence_sse2;
+#else
+  return find_byte_sequence_scalar;
+#endif
+}
+
+}
+
+/** \brief Find the next occurrence of a three byte sequence
+
+   \return A pointer to the first byte of the first occurrence of the
+     sequence \c byte0, \c byte1, \c byte2 in the range
+     <tt>[begin, end)</tt> or \c end if there is none.
+*/
+unsigned char const *
+find_byte_sequence(unsigned char const *begin,
+                   unsigned char const *end,
+                   unsigned char byte0,
+                   unsigned char byte1,
+                   unsigned char byte2) {
+  static auto s_finder = select_byte_sequence_finder();
+
+  return s_finder(begin, end, byte0, byte1, byte2);
+}
+
+/** \brief Find the next MPEG start code (the bytes <tt>00 00 01</tt>)
+
+   \return A pointer to the first of the three bytes or \c end if no
+     start code is found in the range <tt>[begin, end)</tt>. A
+     four-byte start code's leading zero byte is not included.
+*/
+unsigned char const *
+find_start_code(unsigned char const *begin,
+                unsigned char const *end) {
+  return find_byte_sequence(begin, end, 0x00, 0x00, 0x01);
+}
+
+/** \brief Remove emulation prevention bytes
+
+   Copies \c src to \c dest leaving out the \c 03 of each sequence
+   <tt>00 00 03</tt>. Conversion stops when \c dest_size bytes have
+   been written; the source is only searched as far as needed for
+   that.
+
+   \return The number of bytes written to \c dest.
+*/
+std::size_t
+nalu_to_rbsp(unsigned char const *src,
+             std::size_t src_size,
+             unsigned char *dest,
+             std::size_t dest_size) {
+  auto src_end    = src  + src_size;
+  auto dest_start = dest;
+  auto dest_end   = dest + dest_size;
+
+  while ((src < src_end) && (dest < dest_end)) {
+    // A marker starting more than two bytes after the last byte that
+    // still fits into 'dest' doesn't influence the result.
+    auto search_end = std::min(src_end, src + (dest_end - dest) + 2);
+    auto marker     = find_byte_sequence(src, search_end, 0x00, 0x00, 0x03);
+    auto run_end    = marker == search_end ? search_end : marker + 2;
+    auto to_copy    = std::min<std::size_t>(run_end - src, dest_end - dest);
+
+    memcpy(dest, src, to_copy);
+
+    dest += to_copy;
+    src   = marker == search_end ? search_end : marker + 3;
   }
 
-  return std::make_shared<memory_c>(d.get_and_lock_buffer(), d.getFilePointer(), true);
+  return dest - dest_start;
+}
+
+/** \brief Insert emulation prevention bytes
+
+   Copies \c src to \c dest inserting a \c 03 after each two zero
+   bytes followed by a byte in the range <tt>00..03</tt>. \c dest must
+   be at least <tt>src_size + src_size / 2 + 1</tt> bytes long.
+
+   \return The number of bytes written to \c dest.
+*/
+std::size_t
+rbsp_to_nalu(unsigned char const *src,
+             std::size_t src_size,
+             unsigned char *dest) {
+  auto src_end    = src + src_size;
+  auto dest_start = dest;
+
+  while (src < src_end) {
+    auto marker = src_end;
+    auto ptr    = src;
+
+    while ((src_end - ptr) >= 3) {
+      ptr = static_cast<unsigned char const *>(std::memchr(ptr, 0x00, src_end - ptr - 2));
+      if (!ptr)
+        break;
+
+      if (!ptr[1] && (0x03 >= ptr[2])) {
+        marker = ptr;
+        break;
+      }
+
+      ++ptr;
+    }
+
+    auto run_end = marker == src_end ? src_end : marker + 2;
+
+    memcpy(dest, src, run_end - src);
+    dest += run_end - src;
+
+    if (marker == src_end)
+      break;
+
+    *dest++ = 0x03;
+    src     = run_end;
+  }
+
+  return dest - dest_start;
+}
+
+memory_cptr
+nalu_to_rbsp(memory_cptr const &buffer,
+             std::size_t max_size) {
+  auto size = std::min(buffer->get_size(), max_size);
+  auto rbsp = memory_c::alloc(size);
+
+  rbsp->set_size(nalu_to_rbsp(buffer->get_buffer(), buffer->get_size(), rbsp->get_buffer(), size));
+
+  return rbsp;
 }
 
 memory_cptr
 rbsp_to_nalu(memory_cptr const &buffer) {
-  int pos, size = buffer->get_size();
-  mm_mem_io_c d(nullptr, size, 100);
-  unsigned char *b = buffer->get_buffer();
-
-  for (pos = 0; pos < size; ++pos) {
-    if (   ((pos + 2) < size)
-        && (0 == b[pos])
-        && (0 == b[pos + 1])
-        && (3 >= b[pos + 2])) {
-      d.write_uint8(0);
-      d.write_uint8(0);
-      d.write_uint8(3);
-      ++pos;
-
-    } else
-      d.write_uint8(b[pos]);
-  }
+  auto size = buffer->get_size();
+  auto nalu = memory_c::alloc(size + size / 2 + 1);
+
+  nalu->set_size(rbsp_to_nalu(buffer->get_buffer(), size, nalu->get_buffer()));
 
-  return std::make_shared<memory_c>(d.get_and_lock_buffer(), d.getFilePointer(), true);
+  return nalu;
 }
 
 void
@@ -81,12 +276,29 @@ write_nalu_size(unsigned char *buffer,
 memory_cptr
 create_nalu_with_size(memory_cptr const &src,
                       std::size_t nalu_size_length,
-                      std::vector<memory_cptr> extra_data) {
-  auto final_size = nalu_size_length + src->get_size();
+                      std::vector<memory_cptr> const &extra_data) {
+  return create_nalus_with_size(std::vector<memory_cptr>{ src }, nalu_size_length, extra_data);
+}
+
+/** \brief Assemble a frame from NALUs
+
+   Copies \c extra_data verbatim followed by each NALU prefixed with
+   its size into a single buffer. All sizes are known in advance so
+   the frame is allocated and copied exactly once.
+*/
+memory_cptr
+create_nalus_with_size(std::vector<memory_cptr> const &nalus,
+                       std::size_t nalu_size_length,
+                       std::vector<memory_cptr> const &extra_data,
+                       bool ignore_nalu_size_length_errors) {
+  auto final_size = std::size_t{};
 
   for (auto &mem : extra_data)
     final_size += mem->get_size();
 
+  for (auto &nalu : nalus)
+    final_size += nalu_size_length + nalu->get_size();
+
   auto buffer = memory_c::alloc(final_size);
   auto dest   = buffer->get_buffer();
 
@@ -95,9 +307,12 @@ create_nalu_with_size(memory_cptr const &src,
     dest += mem->get_size();
   }
 
-  auto nalu_size = src->get_size();
-  write_nalu_size(dest, nalu_size, nalu_size_length);
-  memcpy(dest + nalu_size_length, src->get_buffer(), nalu_size);
+  for (auto &nalu : nalus) {
+    auto nalu_size = nalu->get_size();
+    write_nalu_size(dest, nalu_size, nalu_size_length, ignore_nalu_size_length_errors);
+    memcpy(dest + nalu_size_length, nalu->get_buffer(), nalu_size);
+    dest += nalu_size_length + nalu_size;
+  }
 
   return buffer;
 }
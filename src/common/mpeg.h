@@ -15,8 +15,15 @@
 
 #include "common/common_pch.h"
 
+#include <limits>
+
 namespace mtx { namespace mpeg {
 
+// The slice header fields the ES parsers look at fit into far fewer
+// bytes for all but broken streams. Only that much of each slice has
+// to be converted to RBSP.
+std::size_t const max_slice_header_rbsp_size = 256;
+
 class nalu_size_length_x: public mtx::exception {
 protected:
   std::size_t m_required_length;
@@ -41,11 +48,17 @@ public:
   }
 };
 
-memory_cptr nalu_to_rbsp(memory_cptr const &buffer);
+unsigned char const *find_start_code(unsigned char const *begin, unsigned char const *end);
+unsigned char const *find_byte_sequence(unsigned char const *begin, unsigned char const *end, unsigned char byte0, unsigned char byte1, unsigned char byte2);
+
+std::size_t nalu_to_rbsp(unsigned char const *src, std::size_t src_size, unsigned char *dest, std::size_t dest_size);
+std::size_t rbsp_to_nalu(unsigned char const *src, std::size_t src_size, unsigned char *dest);
+memory_cptr nalu_to_rbsp(memory_cptr const &buffer, std::size_t max_size = std::numeric_limits<std::size_t>::max());
 memory_cptr rbsp_to_nalu(memory_cptr const &buffer);
 
 void write_nalu_size(unsigned char *buffer, std::size_t size, std::size_t nalu_size_length, bool ignore_nalu_size_length_errors = false);
-memory_cptr create_nalu_with_size(memory_cptr const &src, std::size_t nalu_size_length, std::vector<memory_cptr> extra_data);
+memory_cptr create_nalu_with_size(memory_cptr const &src, std::size_t nalu_size_length, std::vector<memory_cptr> const &extra_data);
+memory_cptr create_nalus_with_size(std::vector<memory_cptr> const &nalus, std::size_t nalu_size_length, std::vector<memory_cptr> const &extra_data, bool ignore_nalu_size_length_errors = false);
 
 }}
 
@@ -968,48 +968,50 @@ mpeg4::p10::avc_es_parser_c::remove_trailing_zero_bytes(memory_c &memory) {
 void
 mpeg4::p10::avc_es_parser_c::add_bytes(unsigned char *buffer,
                                        size_t size) {
-  memory_slice_cursor_c cursor;
-  int marker_size              = 0;
-  int previous_marker_size     = 0;
-  int previous_pos             = -1;
+  int64_t previous_marker_size = 0;
+  int64_t previous_pos         = -1;
   uint64_t previous_parsed_pos = m_parsed_position;
 
-  if (m_unparsed_buffer && (0 != m_unparsed_buffer->get_size()))
-    cursor.add_slice(m_unparsed_buffer);
-  cursor.add_slice(buffer, size);
+  // The unparsed buffer starts with the last start code found (if
+  // any). Any other start code must extend into the new data.
+  auto unparsed_size = m_unparsed_buffer ? m_unparsed_buffer->get_size() : 0;
+  auto resume_pos    = std::max<int64_t>(static_cast<int64_t>(unparsed_size) - 2, 0);
 
-  if (3 <= cursor.get_remaining_size()) {
-    uint32_t marker =                               1 << 24
-                    | (unsigned int)cursor.get_char() << 16
-                    | (unsigned int)cursor.get_char() <<  8
-                    | (unsigned int)cursor.get_char();
+  // All NALUs found are views into this buffer. The caller's buffer
+  // cannot be used as it might be re-used after this function returns.
+  auto data_size = unparsed_size + size;
+  auto combined  = memory_c::alloc(data_size);
+  auto data      = combined->get_buffer();
 
-    while (1) {
-      if (NALU_START_CODE == marker)
-        marker_size = 4;
-      else if (NALU_START_CODE == (marker & 0x00ffffff))
-        marker_size = 3;
-
-      if (0 != marker_size) {
-        if (-1 != previous_pos) {
-          int new_size = cursor.get_position() - marker_size - previous_pos - previous_marker_size;
-          auto nalu = memory_c::alloc(new_size);
-          cursor.copy(nalu->get_buffer(), previous_pos + previous_marker_size, new_size);
-          m_parsed_position = previous_parsed_pos + previous_pos;
-          remove_trailing_zero_bytes(*nalu);
-          handle_nalu(nalu);
-        }
-        previous_pos         = cursor.get_position() - marker_size;
-        previous_marker_size = marker_size;
-        marker_size          = 0;
-      }
+  if (unparsed_size)
+    memcpy(data, m_unparsed_buffer->get_buffer(), unparsed_size);
+  memcpy(data + unparsed_size, buffer, size);
 
-      if (!cursor.char_available())
-        break;
+  auto end  = data + data_size;
+  auto scan = static_cast<unsigned char const *>(data);
+
+  while (true) {
+    auto start_code = mtx::mpeg::find_start_code(scan, end);
+    if (start_code == end)
+      break;
 
-      marker <<= 8;
-      marker  |= (unsigned int)cursor.get_char();
+    int64_t marker_pos  = start_code - data;
+    int64_t marker_size = 3;
+    if ((0 < marker_pos) && !data[marker_pos - 1]) {
+      --marker_pos;
+      marker_size = 4;
     }
+
+    if (-1 != previous_pos) {
+      auto nalu = memory_c::view(combined, previous_pos + previous_marker_size, marker_pos - previous_pos - previous_marker_size);
+      m_parsed_position = previous_parsed_pos + previous_pos;
+      remove_trailing_zero_bytes(*nalu);
+      handle_nalu(nalu);
+    }
+
+    previous_pos         = marker_pos;
+    previous_marker_size = marker_size;
+    scan                 = std::max(start_code + 3, static_cast<unsigned char const *>(data) + resume_pos);
   }
 
   if (-1 == previous_pos)
@@ -1018,13 +1020,15 @@ mpeg4::p10::avc_es_parser_c::add_bytes(unsigned char *buffer,
   m_stream_position += size;
   m_parsed_position  = previous_parsed_pos + previous_pos;
 
-  int new_size = cursor.get_size() - previous_pos;
-  if (0 != new_size) {
-    m_unparsed_buffer = memory_c::alloc(new_size);
-    cursor.copy(m_unparsed_buffer->get_buffer(), previous_pos, new_size);
-
-  } else
+  auto new_size = data_size - previous_pos;
+  if (0 == new_size)
     m_unparsed_buffer.reset();
+
+  else if (0 == previous_pos)
+    m_unparsed_buffer = combined;
+
+  else
+    m_unparsed_buffer = memory_c::view(combined, previous_pos, new_size);
 }
 
 void
@@ -1032,11 +1036,12 @@ mpeg4::p10::avc_es_parser_c::flush() {
   if (m_unparsed_buffer && (5 <= m_unparsed_buffer->get_size())) {
     m_parsed_position += m_unparsed_buffer->get_size();
     int marker_size = get_uint32_be(m_unparsed_buffer->get_buffer()) == NALU_START_CODE ? 4 : 3;
-    handle_nalu(memory_c::clone(m_unparsed_buffer->get_buffer() + marker_size, m_unparsed_buffer->get_size() - marker_size));
+    handle_nalu(memory_c::view(m_unparsed_buffer, marker_size, m_unparsed_buffer->get_size() - marker_size));
   }
 
   m_unparsed_buffer.reset();
   if (m_have_incomplete_frame) {
+    assemble_incomplete_frame_data();
     m_frames.push_back(m_incomplete_frame);
     m_have_incomplete_frame = false;
   }
@@ -1094,6 +1099,7 @@ mpeg4::p10::avc_es_parser_c::flush_incomplete_frame() {
   if (!m_have_incomplete_frame || !m_avcc_ready)
     return;
 
+  assemble_incomplete_frame_data();
   m_frames.push_back(m_incomplete_frame);
   m_incomplete_frame.clear();
   m_have_incomplete_frame = false;
@@ -1119,19 +1125,14 @@ mpeg4::p10::avc_es_parser_c::handle_slice_nalu(memory_cptr const &nalu) {
   }
 
   slice_info_t si;
-  if (!parse_slice(mtx::mpeg::nalu_to_rbsp(nalu), si))
+  if (!parse_slice(mtx::mpeg::nalu_to_rbsp(nalu, mtx::mpeg::max_slice_header_rbsp_size), si))
     return;
 
   if (m_have_incomplete_frame && flush_decision(si, m_incomplete_frame.m_si))
     flush_incomplete_frame();
 
   if (m_have_incomplete_frame) {
-    memory_c &mem = *(m_incomplete_frame.m_data.get());
-    int offset    = mem.get_size();
-    mem.resize(offset + m_nalu_size_length + nalu->get_size());
-    mtx::mpeg::write_nalu_size(mem.get_buffer() + offset, nalu->get_size(), m_nalu_size_length, m_ignore_nalu_size_length_errors);
-    memcpy(mem.get_buffer() + offset + m_nalu_size_length, nalu->get_buffer(), nalu->get_size());
-
+    m_incomplete_frame_nalus.push_back(nalu);
     return;
   }
 
@@ -1173,7 +1174,7 @@ mpeg4::p10::avc_es_parser_c::handle_slice_nalu(memory_cptr const &nalu) {
   } else if (is_b_slice)
     m_b_frames_since_keyframe = true;
 
-  m_incomplete_frame.m_data = create_nalu_with_size(nalu, true);
+  start_incomplete_frame_data(nalu);
   m_have_incomplete_frame   = true;
 
   if (!m_provided_stream_positions.empty() && (m_parsed_position >= m_provided_stream_positions.front())) {
@@ -1250,7 +1251,7 @@ mpeg4::p10::avc_es_parser_c::handle_pps_nalu(memory_cptr const &nalu) {
       break;
 
   if (m_pps_info_list.size() == i) {
-    m_pps_list.push_back(nalu);
+    m_pps_list.push_back(nalu->clone());
     m_pps_info_list.push_back(pps_info);
     m_avcc_changed = true;
 
@@ -1258,7 +1259,7 @@ mpeg4::p10::avc_es_parser_c::handle_pps_nalu(memory_cptr const &nalu) {
     mxverb(2, boost::format("mpeg4::p10: PPS ID %|1$04x| changed; checksum old %|2$04x| new %|3$04x|\n") % pps_info.id % m_pps_info_list[i].checksum % pps_info.checksum);
 
     m_pps_info_list[i] = pps_info;
-    m_pps_list[i]      = nalu;
+    m_pps_list[i]      = nalu->clone();
     m_avcc_changed     = true;
   }
 
@@ -1642,6 +1643,30 @@ mpeg4::p10::avc_es_parser_c::cleanup() {
   m_frames.clear();
 }
 
+void
+mpeg4::p10::avc_es_parser_c::start_incomplete_frame_data(memory_cptr const &nalu) {
+  // The frame's data is only assembled once all of its slices are
+  // known. Still report NALUs too big for the NALU size length right
+  // away.
+  unsigned char nalu_size[8];
+  if (static_cast<std::size_t>(m_nalu_size_length) <= sizeof(nalu_size))
+    mtx::mpeg::write_nalu_size(nalu_size, nalu->get_size(), m_nalu_size_length);
+
+  m_incomplete_frame_extra_data.swap(m_extra_data);
+  m_extra_data.clear();
+
+  m_incomplete_frame_nalus.clear();
+  m_incomplete_frame_nalus.push_back(nalu);
+}
+
+void
+mpeg4::p10::avc_es_parser_c::assemble_incomplete_frame_data() {
+  m_incomplete_frame.m_data = mtx::mpeg::create_nalus_with_size(m_incomplete_frame_nalus, m_nalu_size_length, m_incomplete_frame_extra_data, m_ignore_nalu_size_length_errors);
+
+  m_incomplete_frame_nalus.clear();
+  m_incomplete_frame_extra_data.clear();
+}
+
 memory_cptr
 mpeg4::p10::avc_es_parser_c::create_nalu_with_size(const memory_cptr &src,
                                                    bool add_extra_data) {
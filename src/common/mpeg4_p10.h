@@ -248,6 +248,7 @@ protected:
   uint64_t m_stream_position, m_parsed_position;
 
   avc_frame_t m_incomplete_frame;
+  std::vector<memory_cptr> m_incomplete_frame_nalus, m_incomplete_frame_extra_data;
   bool m_have_incomplete_frame;
   std::deque<memory_cptr> m_unhandled_nalus;
 
@@ -403,6 +404,8 @@ protected:
   bool flush_decision(slice_info_t &si, slice_info_t &ref);
   void flush_incomplete_frame();
   void flush_unhandled_nalus();
+  void start_incomplete_frame_data(memory_cptr const &nalu);
+  void assemble_incomplete_frame_data();
   memory_cptr create_nalu_with_size(const memory_cptr &src, bool add_extra_data = false);
   void remove_trailing_zero_bytes(memory_c &memory);
   void init_nalu_names();
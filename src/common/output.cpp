@@ -13,6 +13,7 @@
 
 #include "common/common_pch.h"
 
+#include <mutex>
 #include <sstream>
 
 #include "common/command_line.h"
@@ -35,6 +36,7 @@ std::shared_ptr<mm_io_c> g_mm_stdio   = std::shared_ptr<mm_io_c>(new mm_stdio_c)
 
 static mxmsg_handler_t s_mxmsg_info_handler, s_mxmsg_warning_handler, s_mxmsg_error_handler;
 static std::vector<std::string> s_warnings_emitted, s_errors_emitted;
+static std::recursive_mutex s_mxmsg_mutex;
 
 static nlohmann::json
 to_json_array(std::vector<std::string> const &messages) {
@@ -106,6 +108,11 @@ mxmsg(unsigned int level,
   if (g_suppress_info && (MXMSG_INFO == level))
     return;
 
+  // Readers may run on worker threads (see "--threaded-readers" in
+  // mkvmerge). Keep messages from different threads from being
+  // interleaved.
+  std::lock_guard<std::recursive_mutex> lock{s_mxmsg_mutex};
+
   if ('\n' == message[0]) {
     message.erase(0, 1);
     g_mm_stdio->puts("\n");
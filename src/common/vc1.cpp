@@ -16,6 +16,7 @@
 
 #include "common/bit_cursor.h"
 #include "common/endian.h"
+#include "common/mpeg.h"
 #include "common/strings/formatting.h"
 #include "common/vc1.h"
 
@@ -299,51 +300,56 @@ vc1::es_parser_c::~es_parser_c() {
 void
 vc1::es_parser_c::add_bytes(unsigned char *buffer,
                             int size) {
-  memory_slice_cursor_c cursor;
-
-  int previous_pos            = -1;
+  int64_t previous_pos        = -1;
   int64_t previous_stream_pos = m_stream_pos;
 
-  if (m_unparsed_buffer && (0 != m_unparsed_buffer->get_size()))
-    cursor.add_slice(m_unparsed_buffer);
-  cursor.add_slice(buffer, size);
-
-  if (3 <= cursor.get_remaining_size()) {
-    uint32_t marker = (1 << 24) | ((unsigned int)cursor.get_char() << 16) | ((unsigned int)cursor.get_char() << 8) | (unsigned int)cursor.get_char();
-
-    while (1) {
-      if (vc1::is_marker(marker)) {
-        if (-1 != previous_pos) {
-          int new_size = cursor.get_position() - 4 - previous_pos;
+  // The unparsed buffer starts with the last marker found (if
+  // any). Any other marker must extend into the new data.
+  auto unparsed_size = m_unparsed_buffer ? m_unparsed_buffer->get_size() : 0;
+  auto resume_pos    = std::max<int64_t>(static_cast<int64_t>(unparsed_size) - 3, 0);
+
+  memory_cptr combined;
+  auto data         = buffer;
+  int64_t data_size = size;
+
+  if (unparsed_size) {
+    combined  = memory_c::alloc(unparsed_size + size);
+    data      = combined->get_buffer();
+    data_size = unparsed_size + size;
+    memcpy(data,                 m_unparsed_buffer->get_buffer(), unparsed_size);
+    memcpy(data + unparsed_size, buffer,                          size);
+  }
 
-          memory_cptr packet(new memory_c(safemalloc(new_size), new_size, true));
-          cursor.copy(packet->get_buffer(), previous_pos, new_size);
+  // A marker consists of a start code and the following byte.
+  auto end  = data + data_size;
+  auto scan = static_cast<unsigned char const *>(data);
 
-          handle_packet(packet);
-        }
+  while (true) {
+    auto start_code = mtx::mpeg::find_start_code(scan, end);
+    if ((end - start_code) < 4)
+      break;
 
-        previous_pos = cursor.get_position() - 4;
-        m_stream_pos = previous_stream_pos + previous_pos;
-      }
+    int64_t marker_pos = start_code - data;
 
-      if (!cursor.char_available())
-        break;
+    if (-1 != previous_pos)
+      handle_packet(memory_c::clone(data + previous_pos, marker_pos - previous_pos));
 
-      marker <<= 8;
-      marker  |= (unsigned int)cursor.get_char();
-    }
+    previous_pos = marker_pos;
+    m_stream_pos = previous_stream_pos + previous_pos;
+    scan         = std::max(start_code + 3, static_cast<unsigned char const *>(data) + resume_pos);
   }
 
   if (-1 == previous_pos)
     previous_pos = 0;
 
-  int new_size = cursor.get_size() - previous_pos;
-  if (0 != new_size) {
-    memory_cptr new_unparsed_buffer = memory_c::alloc(new_size);
-    cursor.copy(new_unparsed_buffer->get_buffer(), previous_pos, new_size);
-    m_unparsed_buffer = new_unparsed_buffer;
+  auto new_size = data_size - previous_pos;
+  if ((0 == previous_pos) && combined)
+    m_unparsed_buffer = combined;
+
+  else if (0 != new_size)
+    m_unparsed_buffer = memory_c::clone(data + previous_pos, new_size);
 
-  } else
+  else
     m_unparsed_buffer.reset();
 }
 
@@ -40,14 +40,14 @@ extract_cli_parser_c::set_default_values() {
 
 void
 extract_cli_parser_c::init_parser() {
-  add_information(YT("mkvextract <mode> <source-filename> [options] <extraction-spec>"));
+  add_information(YT("mkvextract <mode> <source-filename> [options] <extraction-spec> [<mode> [options] <extraction-spec> ...]"));
 
   add_section_header(YT("Usage"));
   add_information(YT("mkvextract tracks <inname> [options] [TID1:out1 [TID2:out2 ...]]"));
-  add_information(YT("mkvextract tags <inname> [options]"));
+  add_information(YT("mkvextract tags <inname> [options] [out]"));
   add_information(YT("mkvextract attachments <inname> [options] [AID1:out1 [AID2:out2 ...]]"));
-  add_information(YT("mkvextract chapters <inname> [options]"));
-  add_information(YT("mkvextract cuesheet <inname> [options]"));
+  add_information(YT("mkvextract chapters <inname> [options] [out]"));
+  add_information(YT("mkvextract cuesheet <inname> [options] [out]"));
   add_information(YT("mkvextract timecodes_v2 <inname> [TID1:out1 [TID2:out2 ...]]"));
   add_information(YT("mkvextract cues <inname> [options] [TID1:out1 [TID2:out2 ...]]"));
   add_information(YT("mkvextract <-h|-V>"));
@@ -57,6 +57,10 @@ extract_cli_parser_c::init_parser() {
   add_information(YT("The first word tells mkvextract what to extract. The second must be the source file. "
                      "There are few global options that can be used with all modes. "
                      "All other options depend on the mode."));
+  add_information(YT("Several modes can be combined in a single call by listing each of them with its own options and extraction specifications after the source file. "
+                     "The file is analyzed only once, and tracks and timecodes are extracted during the same pass over the clusters. "
+                     "Each mode may only be used once. "
+                     "When more than one mode is used, the output file names for tags, chapters and CUE sheets must be given."));
 
   add_section_header(YT("Global options"));
   OPT("f|parse-fully",    set_parse_fully,      YT("Parse the whole file instead of relying on the index."));
@@ -78,7 +82,7 @@ extract_cli_parser_c::init_parser() {
   add_separator();
 
   add_section_header(YT("Tag extraction"));
-  add_information(YT("The second mode extracts the tags and converts them to XML. The output is written to the standard output. The output can be used as a source for mkvmerge."));
+  add_information(YT("The second mode extracts the tags and converts them to XML. The output is written to the standard output unless an output file name is given. The output can be used as a source for mkvmerge."));
 
   add_section_header(YT("Example"));
 
@@ -94,7 +98,7 @@ extract_cli_parser_c::init_parser() {
   add_information(YT("mkvextract attachments \"a movie.mkv\" 4:cover.jpg"));
 
   add_section_header(YT("Chapter extraction"));
-  add_information(YT("The fourth mode extracts the chapters and converts them to XML. The output is written to the standard output. The output can be used as a source for mkvmerge."));
+  add_information(YT("The fourth mode extracts the chapters and converts them to XML. The output is written to the standard output unless an output file name is given. The output can be used as a source for mkvmerge."));
   OPT("s|simple", set_simple, YT("Exports the chapter information in the simple format used in OGM tools (CHAPTER01=... CHAPTER01NAME=...)."));
   OPT("simple-language=language", set_simple_language, YT("Uses the chapter names of the specified language for extraction instead of the first chapter name found."));
 
@@ -126,6 +130,10 @@ extract_cli_parser_c::init_parser() {
 
   add_information(YT("mkvextract cues \"a movie.mkv\" 0:cues_track0.txt"));
 
+  add_section_header(YT("Combining modes"));
+
+  add_information(YT("mkvextract tracks \"a movie.mkv\" 0:video.h264 timecodes_v2 0:timecodes_track0.txt cues 0:cues_track0.txt chapters chapters.xml"));
+
   add_separator();
 
   add_hook(cli_parser_c::ht_unknown_option, std::bind(&extract_cli_parser_c::set_mode_or_extraction_spec, this));
@@ -133,12 +141,18 @@ extract_cli_parser_c::init_parser() {
 
 #undef OPT
 
+options_c::extraction_mode_e
+extract_cli_parser_c::current_extraction_mode()
+  const {
+  return m_options.m_modes.empty() ? options_c::em_unknown : m_options.m_modes.back().m_extraction_mode;
+}
+
 void
 extract_cli_parser_c::assert_mode(options_c::extraction_mode_e mode) {
-  if      ((options_c::em_tracks   == mode) && (m_options.m_extraction_mode != mode))
+  if      ((options_c::em_tracks   == mode) && (current_extraction_mode() != mode))
     mxerror(boost::format(Y("'%1%' is only allowed when extracting tracks.\n"))   % m_current_arg);
 
-  else if ((options_c::em_chapters == mode) && (m_options.m_extraction_mode != mode))
+  else if ((options_c::em_chapters == mode) && (current_extraction_mode() != mode))
     mxerror(boost::format(Y("'%1%' is only allowed when extracting chapters.\n")) % m_current_arg);
 }
 
@@ -181,7 +195,7 @@ extract_cli_parser_c::set_fullraw() {
 void
 extract_cli_parser_c::set_simple() {
   assert_mode(options_c::em_chapters);
-  m_options.m_simple_chapter_format = true;
+  m_options.m_modes.back().m_simple_chapter_format = true;
 }
 
 void
@@ -192,7 +206,7 @@ extract_cli_parser_c::set_simple_language() {
   if (0 > language_idx)
     mxerror(boost::format(Y("'%1%' is neither a valid ISO639-2 nor a valid ISO639-1 code. See 'mkvmerge --list-languages' for a list of all languages and their respective ISO639-2 codes.\n")) % m_next_arg);
 
-  m_options.m_simple_chapter_language.reset(g_iso639_languages[language_idx].iso639_2_code);
+  m_options.m_modes.back().m_simple_chapter_language.reset(g_iso639_languages[language_idx].iso639_2_code);
 }
 
 void
@@ -205,12 +219,15 @@ extract_cli_parser_c::set_mode_or_extraction_spec() {
   else if (2 == m_num_unknown_args)
     m_options.m_file_name = m_current_arg;
 
+  else if (options_c::em_unknown != find_extraction_mode(m_current_arg))
+    set_extraction_mode();
+
   else
     add_extraction_spec();
 }
 
-void
-extract_cli_parser_c::set_extraction_mode() {
+options_c::extraction_mode_e
+extract_cli_parser_c::find_extraction_mode(std::string const &name) {
   static struct {
     const char *name;
     options_c::extraction_mode_e extraction_mode;
@@ -227,27 +244,60 @@ extract_cli_parser_c::set_extraction_mode() {
 
   int i;
   for (i = 0; s_mode_map[i].name; ++i)
-    if (m_current_arg == s_mode_map[i].name) {
-      m_options.m_extraction_mode = s_mode_map[i].extraction_mode;
-      return;
-    }
+    if (name == s_mode_map[i].name)
+      return s_mode_map[i].extraction_mode;
+
+  return options_c::em_unknown;
+}
+
+void
+extract_cli_parser_c::set_extraction_mode() {
+  auto extraction_mode = find_extraction_mode(m_current_arg);
+
+  if (options_c::em_unknown == extraction_mode)
+    mxerror(boost::format(Y("Unknown mode '%1%'.\n")) % m_current_arg);
+
+  if (m_options.find_mode(extraction_mode))
+    mxerror(boost::format(Y("The mode '%1%' has been given more than once.\n")) % m_current_arg);
 
-  mxerror(boost::format(Y("Unknown mode '%1%'.\n")) % m_current_arg);
+  m_options.m_modes.emplace_back(extraction_mode);
+
+  m_used_tids.clear();
+  set_default_values();
+}
+
+void
+extract_cli_parser_c::add_output_file_name() {
+  auto &mode = m_options.m_modes.back();
+
+  if (!mode.m_output_file_name.empty())
+    mxerror(boost::format(Y("Unrecognized command line option '%1%'.\n")) % m_current_arg);
+
+  mode.m_output_file_name = m_current_arg;
 }
 
 void
 extract_cli_parser_c::add_extraction_spec() {
-  if (   (options_c::em_tracks       != m_options.m_extraction_mode)
-      && (options_c::em_cues         != m_options.m_extraction_mode)
-      && (options_c::em_timecodes_v2 != m_options.m_extraction_mode)
-      && (options_c::em_attachments  != m_options.m_extraction_mode))
+  auto extraction_mode = current_extraction_mode();
+
+  if (   (options_c::em_tags     == extraction_mode)
+      || (options_c::em_chapters == extraction_mode)
+      || (options_c::em_cuesheet == extraction_mode)) {
+    add_output_file_name();
+    return;
+  }
+
+  if (   (options_c::em_tracks       != extraction_mode)
+      && (options_c::em_cues         != extraction_mode)
+      && (options_c::em_timecodes_v2 != extraction_mode)
+      && (options_c::em_attachments  != extraction_mode))
     mxerror(boost::format(Y("Unrecognized command line option '%1%'.\n")) % m_current_arg);
 
   boost::regex s_track_id_re("^(\\d+)(:(.+))?$", boost::regex::perl);
 
   boost::smatch matches;
   if (!boost::regex_search(m_current_arg, matches, s_track_id_re)) {
-    if (options_c::em_attachments == m_options.m_extraction_mode)
+    if (options_c::em_attachments == extraction_mode)
       mxerror(boost::format(Y("Invalid attachment ID/file name specification in argument '%1%'.\n")) % m_current_arg);
     else
       mxerror(boost::format(Y("Invalid track ID/file name specification in argument '%1%'.\n")) % m_current_arg);
@@ -266,7 +316,7 @@ extract_cli_parser_c::add_extraction_spec() {
     output_file_name = matches[3].str();
 
   if (output_file_name.empty()) {
-    if (options_c::em_attachments == m_options.m_extraction_mode)
+    if (options_c::em_attachments == extraction_mode)
       mxinfo(Y("No output file name specified, will use attachment name.\n"));
     else
       mxerror(boost::format(Y("Missing output file name in argument '%1%'.\n")) % m_current_arg);
@@ -277,16 +327,31 @@ extract_cli_parser_c::add_extraction_spec() {
   track.extract_cuesheet       = m_extract_cuesheet;
   track.extract_blockadd_level = m_extract_blockadd_level;
   track.target_mode            = m_target_mode;
-  m_options.m_tracks.push_back(track);
+  m_options.m_modes.back().m_tracks.push_back(track);
 
   set_default_values();
 }
 
+void
+extract_cli_parser_c::verify_modes() {
+  if (m_options.m_modes.size() < 2)
+    return;
+
+  // Only one mode can own the standard output. As track extraction
+  // reports its progress there, too, all modes must write to files
+  // once several of them are combined.
+  for (auto const &mode : m_options.m_modes)
+    if (mode.writes_to_stdout())
+      mxerror(Y("When several modes are combined, an output file name must be given for the extraction of tags, chapters and CUE sheets.\n"));
+}
+
 options_c
 extract_cli_parser_c::run() {
   init_parser();
 
   parse_args();
 
+  verify_modes();
+
   return m_options;
 }
@@ -41,6 +41,7 @@ protected:
   void set_default_values();
 
   void assert_mode(options_c::extraction_mode_e mode);
+  options_c::extraction_mode_e current_extraction_mode() const;
 
   void set_parse_fully();
   void set_charset();
@@ -53,6 +54,11 @@ protected:
   void set_mode_or_extraction_spec();
   void set_extraction_mode();
   void add_extraction_spec();
+  void add_output_file_name();
+
+  void verify_modes();
+
+  static options_c::extraction_mode_e find_extraction_mode(std::string const &name);
 };
 
 #endif // MTX_EXTRACT_EXTRACT_CLI_PARSER_H
@@ -19,6 +19,7 @@
 #include "common/command_line.h"
 #include "common/mm_io.h"
 #include "common/mm_io_x.h"
+#include "common/mm_write_buffer_io.h"
 #include "common/strings/parsing.h"
 #include "common/translation.h"
 #include "common/version.h"
@@ -68,6 +69,21 @@ open_and_analyze(std::string const &file_name,
   }
 }
 
+mm_io_cptr
+open_output_file(std::string const &file_name) {
+  if (file_name.empty())
+    return g_mm_stdio;
+
+  try {
+    return mm_write_buffer_io_c::open(file_name, 128 * 1024);
+
+  } catch (mtx::mm_io::exception &ex) {
+    mxerror(boost::format(Y("The file '%1%' could not be opened for writing: %2%.\n")) % file_name % ex);
+  }
+
+  return {};
+}
+
 void
 show_element(EbmlElement *l,
              int level,
@@ -104,39 +120,58 @@ setup(char **argv) {
   version_info = get_version_info("mkvextract", vif_full);
 }
 
-int
-main(int argc,
-     char **argv) {
-  setup(argv);
+// The source file is analyzed only once for all modes. Modes that
+// only need the level 1 elements found by the analyzer are handled
+// first. Tracks and timecodes are extracted afterwards during a
+// single pass over the clusters.
+static void
+run_extraction(options_c &options) {
+  auto analyzer = open_and_analyze(options.m_file_name, options.m_parse_mode, options.needs_index());
+  std::vector<track_spec_t> no_tracks;
 
-  options_c options = extract_cli_parser_c(command_line_utf8(argc, argv)).run();
+  for (auto &mode : options.m_modes) {
+    if (options_c::em_tags == mode.m_extraction_mode)
+      extract_tags(*analyzer, mode);
 
-  if (options_c::em_tracks == options.m_extraction_mode) {
-    extract_tracks(options.m_file_name, options.m_tracks, options.m_parse_mode);
+    else if (options_c::em_attachments == mode.m_extraction_mode)
+      extract_attachments(*analyzer, mode);
 
-    if (0 == verbose)
-      mxinfo(Y("Progress: 100%\n"));
+    else if (options_c::em_chapters == mode.m_extraction_mode)
+      extract_chapters(*analyzer, mode);
 
-  } else if (options_c::em_tags == options.m_extraction_mode)
-    extract_tags(options.m_file_name, options.m_parse_mode);
+    else if (options_c::em_cues == mode.m_extraction_mode)
+      extract_cues(*analyzer, mode);
 
-  else if (options_c::em_attachments == options.m_extraction_mode)
-    extract_attachments(options.m_file_name, options.m_tracks, options.m_parse_mode);
+    else if (options_c::em_cuesheet == mode.m_extraction_mode)
+      extract_cuesheet(*analyzer, options.m_file_name, mode);
+  }
 
-  else if (options_c::em_chapters == options.m_extraction_mode)
-    extract_chapters(options.m_file_name, options.m_simple_chapter_format, options.m_parse_mode, options.m_simple_chapter_language);
+  auto tracks    = options.find_mode(options_c::em_tracks);
+  auto timecodes = options.find_mode(options_c::em_timecodes_v2);
 
-  else if (options_c::em_cues == options.m_extraction_mode)
-    extract_cues(options.m_file_name, options.m_tracks, options.m_parse_mode);
+  if (!tracks && !timecodes)
+    return;
 
-  else if (options_c::em_cuesheet == options.m_extraction_mode)
-    extract_cuesheet(options.m_file_name, options.m_parse_mode);
+  if ((tracks && tracks->m_tracks.empty()) || (timecodes && timecodes->m_tracks.empty()))
+    mxerror(Y("Nothing to do.\n"));
 
-  else if (options_c::em_timecodes_v2 == options.m_extraction_mode)
-    extract_timecodes(options.m_file_name, options.m_tracks, 2);
+  extract_tracks(options.m_file_name, analyzer.get(), tracks ? tracks->m_tracks : no_tracks, timecodes ? timecodes->m_tracks : no_tracks);
 
-  else
+  if (0 == verbose)
+    mxinfo(Y("Progress: 100%\n"));
+}
+
+int
+main(int argc,
+     char **argv) {
+  setup(argv);
+
+  options_c options = extract_cli_parser_c(command_line_utf8(argc, argv)).run();
+
+  if (options.m_modes.empty())
     usage(2);
 
+  run_extraction(options);
+
   mxexit();
 }
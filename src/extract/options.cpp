@@ -16,8 +16,38 @@
 #include "extract/options.h"
 
 options_c::options_c()
-  : m_simple_chapter_format(false)
-  , m_parse_mode(kax_analyzer_c::parse_mode_fast)
-  , m_extraction_mode(options_c::em_unknown)
+  : m_parse_mode(kax_analyzer_c::parse_mode_fast)
 {
 }
+
+options_c::mode_options_c *
+options_c::find_mode(extraction_mode_e extraction_mode) {
+  auto itr = brng::find_if(m_modes, [extraction_mode](mode_options_c const &mode) { return mode.m_extraction_mode == extraction_mode; });
+  return itr != m_modes.end() ? &*itr : nullptr;
+}
+
+// Tracks and timecodes are read from the clusters and can do without
+// the index. All other modes need the level 1 elements located by
+// kax_analyzer_c.
+bool
+options_c::needs_index()
+  const {
+  return std::any_of(m_modes.begin(), m_modes.end(), [](mode_options_c const &mode) {
+      return (em_tracks != mode.m_extraction_mode) && (em_timecodes_v2 != mode.m_extraction_mode);
+    });
+}
+
+options_c::mode_options_c::mode_options_c(extraction_mode_e extraction_mode)
+  : m_extraction_mode(extraction_mode)
+  , m_simple_chapter_format(false)
+{
+}
+
+bool
+options_c::mode_options_c::writes_to_stdout()
+  const {
+  return m_output_file_name.empty()
+      && (   (em_tags     == m_extraction_mode)
+          || (em_chapters == m_extraction_mode)
+          || (em_cuesheet == m_extraction_mode));
+}
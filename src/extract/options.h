@@ -13,6 +13,9 @@
 
 #include "common/common_pch.h"
 
+#include "common/kax_analyzer.h"
+#include "extract/track_spec.h"
+
 class options_c {
 public:
   enum extraction_mode_e {
@@ -26,16 +29,29 @@ public:
     em_cues,
   };
 
+  struct mode_options_c {
+    extraction_mode_e m_extraction_mode;
+    bool m_simple_chapter_format;
+    boost::optional<std::string> m_simple_chapter_language;
+    std::string m_output_file_name;
+
+    std::vector<track_spec_t> m_tracks;
+
+    mode_options_c(extraction_mode_e extraction_mode);
+
+    bool writes_to_stdout() const;
+  };
+
   std::string m_file_name;
-  bool m_simple_chapter_format;
-  boost::optional<std::string> m_simple_chapter_language;
   kax_analyzer_c::parse_mode_e m_parse_mode;
-  extraction_mode_e m_extraction_mode;
 
-  std::vector<track_spec_t> m_tracks;
+  std::vector<mode_options_c> m_modes;
 
 public:
   options_c();
+
+  mode_options_c *find_mode(extraction_mode_e extraction_mode);
+  bool needs_index() const;
 };
 
 #endif // MTX_EXTRACT_OPTIONS_H
@@ -341,18 +341,40 @@ handle_segment_info(EbmlMaster *info,
   file->set_timecode_scale(tc_scale);
 }
 
+static void
+handle_tracks(KaxTracks &tracks,
+              std::vector<track_spec_t> &tspecs,
+              std::vector<track_spec_t> &timecode_tspecs) {
+  find_and_verify_track_uids(tracks, tspecs);
+  find_and_verify_track_uids(tracks, timecode_tspecs);
+
+  create_extractors(tracks, tspecs);
+  create_timecode_files(tracks, timecode_tspecs, 2);
+}
+
+// Extracts both the tracks' content and their v2 timecodes during the
+// same pass over the clusters. If an analyzer is given then its file
+// and its copies of the segment info and the tracks are used instead
+// of opening the source file another time.
 bool
 extract_tracks(const std::string &file_name,
+               kax_analyzer_c *analyzer,
                std::vector<track_spec_t> &tspecs,
-               kax_analyzer_c::parse_mode_e parse_mode) {
-  if (tspecs.empty())
+               std::vector<track_spec_t> &timecode_tspecs) {
+  if (tspecs.empty() && timecode_tspecs.empty())
     mxerror(Y("Nothing to do.\n"));
 
   // open input file
-  mm_io_cptr in;
+  mm_io_cptr own_in;
+  mm_io_c *in = nullptr;
   kax_file_cptr file;
   try {
-    in   = mm_file_io_c::open(file_name);
+    if (analyzer)
+      in = &analyzer->get_file();
+    else {
+      own_in = mm_file_io_c::open(file_name);
+      in     = own_in.get();
+    }
     file = std::make_shared<kax_file_c>(*in);
   } catch (mtx::mm_io::exception &ex) {
     show_error(boost::format(Y("The file '%1%' could not be opened for reading: %2%.\n")) % file_name % ex);
@@ -363,8 +385,6 @@ extract_tracks(const std::string &file_name,
   uint64_t tc_scale = TIMECODE_SCALE;
   bool segment_info_found = false, tracks_found = false;
 
-  // open input file
-  auto analyzer = open_and_analyze(file_name, parse_mode, false);
   if (analyzer) {
     auto af_master    = ebml_master_cptr{ analyzer->read_all(EBML_INFO(KaxInfo)) };
     auto segment_info = dynamic_cast<KaxInfo *>(af_master.get());
@@ -377,8 +397,7 @@ extract_tracks(const std::string &file_name,
     auto tracks = dynamic_cast<KaxTracks *>(af_master.get());
     if (tracks) {
       tracks_found = true;
-      find_and_verify_track_uids(*tracks, tspecs);
-      create_extractors(*tracks, tspecs);
+      handle_tracks(*tracks, tspecs, timecode_tspecs);
     }
   }
 
@@ -429,8 +448,7 @@ extract_tracks(const std::string &file_name,
 
       } else if (Is<KaxTracks>(l1) && !tracks_found) {
         tracks_found = true;
-        find_and_verify_track_uids(*dynamic_cast<KaxTracks *>(l1), tspecs);
-        create_extractors(*dynamic_cast<KaxTracks *>(l1), tspecs);
+        handle_tracks(*dynamic_cast<KaxTracks *>(l1), tspecs, timecode_tspecs);
 
       } else if (Is<KaxCluster>(l1)) {
         show_element(l1, 1, Y("Cluster"));
@@ -457,10 +475,12 @@ extract_tracks(const std::string &file_name,
           if (Is<KaxBlockGroup>(el)) {
             show_element(el, 2, Y("Block group"));
             max_bg_timecode = handle_blockgroup(*static_cast<KaxBlockGroup *>(el), *cluster, tc_scale);
+            extract_timecodes_from_blockgroup(*static_cast<KaxBlockGroup *>(el), *cluster, tc_scale);
 
           } else if (Is<KaxSimpleBlock>(el)) {
             show_element(el, 2, Y("SimpleBlock"));
             max_bg_timecode = handle_simpleblock(*static_cast<KaxSimpleBlock *>(el), *cluster);
+            extract_timecodes_from_simpleblock(*static_cast<KaxSimpleBlock *>(el), *cluster);
           }
 
           max_timecode = std::max(max_timecode, max_bg_timecode);
@@ -507,6 +527,7 @@ extract_tracks(const std::string &file_name,
     // lullaby. Just close your eyes, listen to her sweet voice, singing,
     // singing, fading... fad... ing...
     close_extractors();
+    close_timecode_files();
 
     return true;
   } catch (...) {
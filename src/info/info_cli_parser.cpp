@@ -45,6 +45,8 @@ info_cli_parser_c::init_parser() {
   OPT("x|hexdump",      set_hexdump,      YT("Show the first 16 bytes of each frame as a hex dump."));
   OPT("X|full-hexdump", set_full_hexdump, YT("Show all bytes of each frame as a hex dump."));
   OPT("z|size",         set_size,         YT("Show the size of each element including its header."));
+  OPT("verify-crc32",   set_verify_crc32, YT("Only verify the CRC-32 elements of the segment and its top level elements."));
+  OPT("seek-info",      set_seek_info,    YT("Only show how many bytes a player has to read before it can seek."));
 
   add_common_options();
 
@@ -110,6 +112,16 @@ info_cli_parser_c::set_track_info() {
     verbose = 1;
 }
 
+void
+info_cli_parser_c::set_verify_crc32() {
+  m_options.m_verify_crc32 = true;
+}
+
+void
+info_cli_parser_c::set_seek_info() {
+  m_options.m_show_seek_info = true;
+}
+
 void
 info_cli_parser_c::set_file_name() {
   if (!m_options.m_file_name.empty())
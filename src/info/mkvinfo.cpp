@@ -72,6 +72,7 @@
 #include "common/strings/formatting.h"
 #include "common/translation.h"
 #include "common/version.h"
+#include "common/vint.h"
 #include "common/xml/ebml_chapters_converter.h"
 #include "common/xml/ebml_tags_converter.h"
 #include "info/mkvinfo.h"
@@ -1627,6 +1628,222 @@ display_track_info() {
   }
 }
 
+// Checks the CRC-32 elements of the EBML head, the segment and all
+// level 1 elements. The elements are not parsed: their content is read
+// as a whole and checksummed if its first child is a CRC-32
+// element. Elements without one are skipped, as are CRC-32 elements on
+// deeper levels.
+class crc32_verifier_c {
+protected:
+  mm_io_c &m_in;
+  uint64_t m_file_size;
+  memory_cptr m_buffer;
+  unsigned int m_num_verified, m_num_mismatches;
+
+public:
+  crc32_verifier_c(mm_io_c &in)
+    : m_in(in)
+    , m_file_size(in.get_size())
+    , m_buffer{memory_c::alloc(1024 * 1024)}
+    , m_num_verified{}
+    , m_num_mismatches{}
+  {
+  }
+
+  bool
+  run() {
+    verify_elements(0, m_file_size, 0);
+
+    mxinfo(boost::format(Y("%1% CRC-32 element(s) verified, %2% mismatch(es) found.\n")) % m_num_verified % m_num_mismatches);
+
+    return !m_num_mismatches;
+  }
+
+protected:
+  void
+  verify_elements(uint64_t start,
+                  uint64_t end,
+                  int level) {
+    auto position = start;
+
+    while (position < end) {
+      m_in.setFilePointer(position);
+
+      auto id   = vint_c::read_ebml_id(m_in);
+      auto size = vint_c::read(m_in);
+
+      if (!id.is_valid() || !size.is_valid())
+        return;
+
+      auto data_start = m_in.getFilePointer();
+      auto is_segment = (0 == level) && (EBML_ID(KaxSegment) == EbmlId(id));
+
+      // Only segments may have an unknown size; their content extends
+      // to the end of the file.
+      if (size.is_unknown()) {
+        if (is_segment)
+          verify_elements(data_start, m_file_size, 1);
+        return;
+      }
+
+      auto data_end = data_start + size.m_value;
+      if (data_end > end) {
+        mxwarn(boost::format(Y("The element at %1% is truncated.\n")) % position);
+        return;
+      }
+
+      verify_element(id, position, data_start, size.m_value);
+
+      if (is_segment)
+        verify_elements(data_start, data_end, 1);
+
+      position = data_end;
+    }
+  }
+
+  void
+  verify_element(EbmlId const &id,
+                 uint64_t position,
+                 uint64_t data_start,
+                 uint64_t data_size) {
+    if (data_size < ebml_crc32_element_size)
+      return;
+
+    unsigned char crc_element[ebml_crc32_element_size];
+    m_in.setFilePointer(data_start);
+    if (   (ebml_crc32_element_size != m_in.read(crc_element, ebml_crc32_element_size))
+        || (0xbf != crc_element[0])
+        || (0x84 != crc_element[1]))
+      return;
+
+    auto content_size = data_size - ebml_crc32_element_size;
+    if (m_buffer->get_size() < content_size)
+      m_buffer->resize(content_size);
+
+    if (content_size != m_in.read(m_buffer->get_buffer(), content_size)) {
+      mxwarn(boost::format(Y("The element at %1% is truncated.\n")) % position);
+      return;
+    }
+
+    auto stored     = get_uint32_le(&crc_element[2]);
+    auto calculated = calculate_ebml_crc32(m_buffer->get_buffer(), content_size);
+    auto callbacks  = find_ebml_callbacks(EBML_INFO(KaxSegment), id);
+    auto name       = callbacks ? std::string{EBML_INFO_NAME(*callbacks)} : (boost::format("0x%|1$x|") % EBML_ID_VALUE(id)).str();
+
+    ++m_num_verified;
+
+    if (stored == calculated) {
+      if (g_options.m_verbose)
+        mxinfo(boost::format(Y("CRC-32 of the %1% element at %2%: 0x%|3$08x| (OK)\n")) % name % position % stored);
+      return;
+    }
+
+    ++m_num_mismatches;
+    mxwarn(boost::format(Y("CRC-32 mismatch for the %1% element at %2%: stored 0x%|3$08x|, calculated 0x%|4$08x|.\n")) % name % position % stored % calculated);
+  }
+};
+
+static bool
+verify_crc32_elements(std::string const &file_name) {
+  mm_io_cptr in;
+  try {
+    in = mm_file_io_c::open(file_name);
+  } catch (mtx::mm_io::exception &ex) {
+    show_error((boost::format(Y("Error: Couldn't open input file %1% (%2%).")) % file_name % ex).str());
+    return false;
+  }
+
+  try {
+    return crc32_verifier_c{*in}.run();
+
+  } catch (mtx::mm_io::exception &ex) {
+    show_error((boost::format(Y("Error reading the file: %1%")) % ex).str());
+    return false;
+  }
+}
+
+// Determines how many bytes a player has to read before it can seek:
+// everything up to the end of the cues if they are located in front of
+// the first cluster, otherwise the headers up to the first cluster and
+// the cues at the end of the file. Only the level 1 elements' heads
+// are read.
+static bool
+show_seek_info(std::string const &file_name) {
+  mm_io_cptr in;
+  try {
+    in = mm_file_io_c::open(file_name);
+  } catch (mtx::mm_io::exception &ex) {
+    show_error((boost::format(Y("Error: Couldn't open input file %1% (%2%).")) % file_name % ex).str());
+    return false;
+  }
+
+  try {
+    auto file_size         = in->get_size();
+    auto position          = 0ull;
+    auto segment_end       = file_size;
+    auto in_segment        = false;
+    auto first_cluster_pos = boost::optional<uint64_t>{};
+    auto cues_pos          = boost::optional<uint64_t>{};
+    auto cues_end          = 0ull;
+
+    while (position < segment_end) {
+      in->setFilePointer(position);
+
+      auto id   = vint_c::read_ebml_id(*in);
+      auto size = vint_c::read(*in);
+
+      if (!id.is_valid() || !size.is_valid())
+        break;
+
+      auto data_start = in->getFilePointer();
+
+      if (!in_segment && (EBML_ID(KaxSegment) == EbmlId(id))) {
+        in_segment  = true;
+        position    = data_start;
+        segment_end = size.is_unknown() ? file_size : std::min<uint64_t>(data_start + size.m_value, file_size);
+        continue;
+      }
+
+      // Elements of unknown size (e.g. clusters of live streams) cannot
+      // be skipped.
+      if (size.is_unknown())
+        break;
+
+      if (in_segment && (EBML_ID(KaxCluster) == EbmlId(id)) && !first_cluster_pos)
+        first_cluster_pos = position;
+
+      else if (in_segment && (EBML_ID(KaxCues) == EbmlId(id)) && !cues_pos) {
+        cues_pos = position;
+        cues_end = data_start + size.m_value;
+      }
+
+      position = data_start + size.m_value;
+    }
+
+    if (!in_segment) {
+      show_error(Y("No segment/level 0 element found."));
+      return false;
+    }
+
+    if (!cues_pos)
+      mxinfo(boost::format(Y("The file does not contain cues. A player has to read the whole file (%1% bytes) in order to seek.\n")) % file_size);
+
+    else if (!first_cluster_pos || (*cues_pos < *first_cluster_pos))
+      mxinfo(boost::format(Y("The cues are located at %1% in front of the first cluster. A player has to read %2% bytes before it can seek.\n")) % *cues_pos % cues_end);
+
+    else
+      mxinfo(boost::format(Y("The cues are located at %1% after the first cluster. A player has to read %2% bytes up to the first cluster and %3% bytes of cues, "
+                             "%4% bytes in total, in two separate requests before it can seek.\n"))
+             % *cues_pos % *first_cluster_pos % (cues_end - *cues_pos) % (*first_cluster_pos + cues_end - *cues_pos));
+
+    return true;
+
+  } catch (mtx::mm_io::exception &ex) {
+    show_error((boost::format(Y("Error reading the file: %1%")) % ex).str());
+    return false;
+  }
+}
+
 bool
 process_file(const std::string &file_name) {
   // Elements for different levels
@@ -1708,6 +1925,12 @@ console_main() {
   if (g_options.m_file_name.empty())
     mxerror(Y("No file name given.\n"));
 
+  if (g_options.m_verify_crc32)
+    return verify_crc32_elements(g_options.m_file_name) ? 0 : 1;
+
+  if (g_options.m_show_seek_info)
+    return show_seek_info(g_options.m_file_name) ? 0 : 1;
+
   return process_file(g_options.m_file_name.c_str()) ? 0 : 1;
 }
 
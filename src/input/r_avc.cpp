@@ -17,6 +17,7 @@
 #include "common/codec.h"
 #include "common/error.h"
 #include "common/memory.h"
+#include "common/mm_mmap_io.h"
 #include "common/id_info.h"
 #include "input/r_avc.h"
 #include "merge/input_x.h"
@@ -78,6 +79,7 @@ avc_es_reader_c::avc_es_reader_c(const track_info_c &ti,
                                  const mm_io_cptr &in)
   : generic_reader_c(ti, in)
   , m_buffer(memory_c::alloc(READ_SIZE))
+  , m_mmap_in{dynamic_cast<mm_mmap_io_c *>(in.get())}
 {
 }
 
@@ -130,9 +132,18 @@ avc_es_reader_c::read(generic_packetizer_c *,
   if (m_in->getFilePointer() >= m_size)
     return FILE_STATUS_DONE;
 
-  int num_read = m_in->read(m_buffer->get_buffer(), READ_SIZE);
+  // The parser copies the data, so mapped memory can be passed on
+  // directly.
+  auto num_read = static_cast<size_t>(READ_SIZE);
+  auto data     = m_mmap_in ? m_mmap_in->read_direct(num_read) : nullptr;
+
+  if (!data) {
+    num_read = m_in->read(m_buffer->get_buffer(), READ_SIZE);
+    data     = m_buffer->get_buffer();
+  }
+
   if (0 < num_read)
-    PTZR0->process(new packet_t(new memory_c(m_buffer->get_buffer(), num_read)));
+    PTZR0->process(new packet_t(new memory_c(const_cast<unsigned char *>(data), num_read)));
 
   return (0 != num_read) && (m_in->getFilePointer() < m_size) ? FILE_STATUS_MOREDATA : flush_packetizers();
 }
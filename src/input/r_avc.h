@@ -20,6 +20,8 @@
 #include "common/mpeg4_p10.h"
 #include "merge/generic_reader.h"
 
+class mm_mmap_io_c;
+
 class avc_es_reader_c: public generic_reader_c {
 protected:
   static debugging_option_c ms_debug;
@@ -27,6 +29,7 @@ protected:
   int m_width, m_height;
 
   memory_cptr m_buffer;
+  mm_mmap_io_c *m_mmap_in;
 
 public:
   avc_es_reader_c(const track_info_c &ti, const mm_io_cptr &in);
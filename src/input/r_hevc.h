@@ -18,11 +18,14 @@
 #include "common/hevc.h"
 #include "merge/generic_reader.h"
 
+class mm_mmap_io_c;
+
 class hevc_es_reader_c: public generic_reader_c {
 private:
   int m_width, m_height;
 
   memory_cptr m_buffer;
+  mm_mmap_io_c *m_mmap_in;
 
 public:
   hevc_es_reader_c(const track_info_c &ti, const mm_io_cptr &in);
@@ -1994,7 +1994,13 @@ kax_reader_c::read(generic_packetizer_c *requested_ptzr,
   }
 
   try {
-    KaxCluster *cluster = m_in_file->read_next_cluster();
+    // Blocks of tracks that aren't processed are skipped without
+    // reading their content. Blocks for unknown track numbers are read
+    // so that the user is warned about them.
+    KaxCluster *cluster = m_in_file->read_next_cluster([this](uint64_t track_number) -> bool {
+      auto track = find_track_by_num(track_number);
+      return !track || (-1 != track->ptzr);
+    });
     if (!cluster) {
       flush_packetizers();
 
@@ -2027,6 +2033,15 @@ kax_reader_c::read(generic_packetizer_c *requested_ptzr,
 
     delete cluster;
 
+    // Blocks of other tracks skipped while reading the cluster still
+    // count for the progress and for the timestamp reported after
+    // errors, e.g. if the only selected track is sparse.
+    auto skipped_timecode = m_in_file->get_last_skipped_block_timecode();
+    if (-1 != skipped_timecode) {
+      m_in_file->set_last_timecode(std::max(m_in_file->get_last_timecode(), skipped_timecode));
+      m_last_timecode = std::max(m_last_timecode, skipped_timecode - (m_appending ? m_first_timecode : 0));
+    }
+
   } catch (...) {
     mxwarn(boost::format("%1% %2% %3%\n")
            % (boost::format(Y("%1%: an unknown exception occurred.")) % "kax_reader_c::read()")
@@ -2228,7 +2243,7 @@ kax_reader_c::process_block_group(KaxCluster *cluster,
       auto data         = std::make_shared<memory_c>(data_buffer.Buffer(), data_buffer.Size(), false);
       block_track->content_decoder.reverse(data, CONTENT_ENCODING_SCOPE_BLOCK);
 
-      auto packet                = std::make_shared<packet_t>(data, m_last_timecode + i * frame_duration, block_duration, block_bref, block_fref);
+      auto packet                = packet_t::create(data, m_last_timecode + i * frame_duration, block_duration, block_bref, block_fref);
       packet->duration_mandatory = duration;
 
       process_block_group_common(block_group, packet.get(), *block_track);
@@ -2251,7 +2266,7 @@ kax_reader_c::process_block_group(KaxCluster *cluster,
 
     if (('s' == block_track->type) && ('t' == block_track->sub_type)) {
       if ((2 < data->get_size()) || ((0 < data->get_size()) && (' ' != *data->get_buffer()) && (0 != *data->get_buffer()) && !iscr(*data->get_buffer()))) {
-        auto packet = std::make_shared<packet_t>(data, m_last_timecode, block_duration, block_bref, block_fref);
+        auto packet = packet_t::create(data, m_last_timecode, block_duration, block_bref, block_fref);
 
         process_block_group_common(block_group, packet.get(), *block_track);
 
@@ -2259,7 +2274,7 @@ kax_reader_c::process_block_group(KaxCluster *cluster,
       }
 
     } else {
-      auto packet = std::make_shared<packet_t>(data, m_last_timecode + block_idx * frame_duration, block_duration, block_bref, block_fref);
+      auto packet = packet_t::create(data, m_last_timecode + block_idx * frame_duration, block_duration, block_bref, block_fref);
 
       if ((duration) && !duration->GetValue())
         packet->duration_mandatory = true;
@@ -2274,6 +2289,12 @@ kax_reader_c::process_block_group(KaxCluster *cluster,
   block_track->units_processed   += block->NumberFrames();
 }
 
+timestamp_c
+kax_reader_c::get_duration()
+  const {
+  return 0 != m_segment_duration ? timestamp_c::ns(m_segment_duration) : timestamp_c{};
+}
+
 int
 kax_reader_c::get_progress() {
   if (0 != m_segment_duration)
@@ -221,6 +221,7 @@ public:
   virtual file_status_e read(generic_packetizer_c *ptzr, bool force = false);
 
   virtual int get_progress();
+  virtual timestamp_c get_duration() const;
   virtual void set_headers();
   virtual void identify();
   virtual void create_packetizers();
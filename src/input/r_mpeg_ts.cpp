@@ -20,6 +20,7 @@
 #include "common/checksums/crc.h"
 #include "common/clpi.h"
 #include "common/endian.h"
+#include "common/fs_sys_helpers.h"
 #include "common/math.h"
 #include "common/mp3.h"
 #include "common/mm_mpls_multi_file_io.h"
@@ -52,6 +53,8 @@
 #define TS_PIDS_DETECT_SIZE    10 * 1024 * 1024
 #define TS_PACKET_SIZE         188
 #define TS_MAX_PACKET_SIZE     204
+#define TS_NUM_PIDS            0x2000
+#define TS_READ_BUFFER_SIZE    (2 * 1024 * 1024)
 
 int mpeg_ts_reader_c::potential_packet_sizes[] = { 188, 192, 204, 0 };
 
@@ -99,7 +102,7 @@ mpeg_ts_track_c::send_to_packetizer() {
 
   if (use_packet) {
     auto bytes_to_skip = std::min<size_t>(pes_payload->get_size(), skip_packet_data_bytes);
-    process(std::make_shared<packet_t>(memory_c::clone(pes_payload->get_buffer() + bytes_to_skip, pes_payload->get_size() - bytes_to_skip), timestamp_to_use.to_ns(-1)));
+    process(packet_t::create(memory_c::clone(pes_payload->get_buffer() + bytes_to_skip, pes_payload->get_size() - bytes_to_skip), timestamp_to_use.to_ns(-1)));
   }
 
   pes_payload->remove(pes_payload->get_size());
@@ -399,6 +402,7 @@ mpeg_ts_track_c::new_stream_a_truehd() {
 void
 mpeg_ts_track_c::set_pid(uint16_t new_pid) {
   pid = new_pid;
+  reader.invalidate_pid_to_track_idx();
 
   std::string arg;
   m_debug_delivery = debugging_c::requested("mpeg_ts")
@@ -684,6 +688,14 @@ mpeg_ts_reader_c::mpeg_ts_reader_c(const track_info_c &ti,
   , m_probing{true}
   , file_done{}
   , m_packet_sent_to_packetizer{}
+  , m_pid_to_track_idx(TS_NUM_PIDS, -1)
+  , m_pid_to_track_idx_valid{}
+  , m_read_block{}
+  , m_read_buffer_pos{}
+  , m_read_buffer_fill{}
+  , m_mmap_in{dynamic_cast<mm_mmap_io_c *>(in.get())}
+  , m_num_packets_read{}
+  , m_read_start_time{-1}
   , m_dont_use_audio_pts{      "mpeg_ts|mpeg_ts_dont_use_audio_pts"}
   , m_debug_resync{            "mpeg_ts|mpeg_ts_resync"}
   , m_debug_pat_pmt{           "mpeg_ts|mpeg_ts_pat|mpeg_ts_pmt|mpeg_ts_headers"}
@@ -692,6 +704,7 @@ mpeg_ts_reader_c::mpeg_ts_reader_c(const track_info_c &ti,
   , m_debug_aac{               "mpeg_ts|mpeg_aac"}
   , m_debug_timestamp_wrapping{"mpeg_ts|mpeg_ts_timestamp_wrapping"}
   , m_debug_clpi{              "clpi"}
+  , m_debug_performance{       "mpeg_ts_performance"}
   , m_detected_packet_size{}
   , m_num_pat_crc_errors{}
   , m_num_pmt_crc_errors{}
@@ -716,6 +729,7 @@ mpeg_ts_reader_c::read_headers() {
     auto PAT = std::make_shared<mpeg_ts_track_c>(*this);
     PAT->type = PAT_TYPE;
     tracks.push_back(PAT);
+    invalidate_pid_to_track_idx();
 
     unsigned char buf[TS_MAX_PACKET_SIZE]; // maximum TS packet size + 1
 
@@ -762,6 +776,7 @@ mpeg_ts_reader_c::read_headers() {
       auto PAT = std::make_shared<mpeg_ts_track_c>(*this);
       PAT->type = PAT_TYPE;
       tracks.push_back(PAT);
+      invalidate_pid_to_track_idx();
     }
   } catch (...) {
     mxdebug_if(m_debug_headers, boost::format("mpeg_ts_reader_c::read_headers: caught exception\n"));
@@ -832,6 +847,11 @@ mpeg_ts_reader_c::process_chapter_entries() {
 }
 
 mpeg_ts_reader_c::~mpeg_ts_reader_c() {
+  if (!m_debug_performance || (-1 == m_read_start_time))
+    return;
+
+  auto duration = std::max<int64_t>(mtx::sys::get_current_time_millis() - m_read_start_time, 1);
+  mxdebug(boost::format("mpeg_ts_reader_c: read %1% packets in %2% ms (%3% packets/second)\n") % m_num_packets_read % duration % (m_num_packets_read * 1000 / duration));
 }
 
 uint32_t
@@ -963,6 +983,7 @@ mpeg_ts_reader_c::parse_pat(unsigned char *pat) {
       PMT->set_pid(tmp_pid);
 
       tracks.push_back(PMT);
+      invalidate_pid_to_track_idx();
     }
   }
 
@@ -1166,6 +1187,7 @@ mpeg_ts_reader_c::parse_pmt(unsigned char *pmt) {
       track->processed  = false;
       track->data_ready = false;
       tracks.push_back(track);
+      invalidate_pid_to_track_idx();
       ++es_to_process;
 
       brng::copy(track->m_coupled_tracks, std::back_inserter(tracks));
@@ -1204,12 +1226,8 @@ mpeg_ts_reader_c::parse_packet(unsigned char *buf) {
   if (!(hdr->get_adaptation_field_control() & 0x01)) //no ts_payload
     return false;
 
-  size_t tidx;
-  for (tidx = 0; tracks.size() > tidx; ++tidx)
-    if ((tracks[tidx]->pid == table_pid) && (m_probing || (-1 != tracks[tidx]->ptzr)))
-      break;
-
-  if ((tidx >= tracks.size()) || tracks[tidx]->processed)
+  auto tidx = find_track_idx_for_pid(table_pid);
+  if ((-1 == tidx) || tracks[tidx]->processed)
     return false;
 
   unsigned char *ts_payload                 = (unsigned char *)hdr + sizeof(mpeg_ts_packet_header_t);
@@ -1272,7 +1290,7 @@ mpeg_ts_reader_c::parse_packet(unsigned char *buf) {
   if (!track->data_ready)
     return true;
 
-  mxdebug_if(m_debug_headers, boost::format("mpeg_ts_reader_c::parse_packet: Table/PES completed (%1%) for PID %2% at file position %3%\n") % track->pes_payload->get_size() % table_pid % m_in->getFilePointer());
+  mxdebug_if(m_debug_headers, boost::format("mpeg_ts_reader_c::parse_packet: Table/PES completed (%1%) for PID %2% at file position %3%\n") % track->pes_payload->get_size() % table_pid % get_read_position());
 
   if (m_probing)
     probe_packet_complete(track);
@@ -1337,8 +1355,10 @@ mpeg_ts_reader_c::probe_packet_complete(mpeg_ts_track_ptr &track) {
   if (result == 0) {
     if (track->type == PAT_TYPE || track->type == PMT_TYPE) {
       auto it = brng::find(tracks, track);
-      if (tracks.end() != it)
+      if (tracks.end() != it) {
         tracks.erase(it);
+        invalidate_pid_to_track_idx();
+      }
 
     } else {
       track->processed = true;
@@ -1602,6 +1622,8 @@ mpeg_ts_reader_c::create_packetizers() {
   mxdebug_if(m_debug_headers, boost::format("mpeg_ts_reader_c::create_packetizers: create packetizers...\n"));
   for (i = 0; i < tracks.size(); i++)
     create_packetizer(i);
+
+  invalidate_pid_to_track_idx();
 }
 
 void
@@ -1621,7 +1643,7 @@ mpeg_ts_reader_c::finish() {
   for (auto &track : tracks) {
     if ((-1 != track->ptzr) && (0 < track->pes_payload->get_size())) {
       auto bytes_to_skip = std::min<size_t>(track->pes_payload->get_size(), track->skip_packet_data_bytes);
-      track->process(std::make_shared<packet_t>(memory_c::clone(track->pes_payload->get_buffer() + bytes_to_skip, track->pes_payload->get_size() - bytes_to_skip)));
+      track->process(packet_t::create(memory_c::clone(track->pes_payload->get_buffer() + bytes_to_skip, track->pes_payload->get_size() - bytes_to_skip)));
     }
 
     if (track->converter)
@@ -1643,21 +1665,27 @@ mpeg_ts_reader_c::read(generic_packetizer_c *requested_ptzr,
       return FILE_STATUS_HOLDING;
   }
 
-  unsigned char buf[TS_MAX_PACKET_SIZE + 1];
-
   if (file_done)
     return flush_packetizers();
 
+  if (-1 == m_read_start_time)
+    m_read_start_time = mtx::sys::get_current_time_millis();
+
   while (true) {
-    if (m_in->read(buf, m_detected_packet_size) != static_cast<unsigned int>(m_detected_packet_size))
+    auto buf = read_buffered_packet();
+    if (!buf)
       return finish();
 
     if (buf[0] != 0x47) {
-      if (resync(m_in->getFilePointer() - m_detected_packet_size))
+      auto start_at = get_read_position() - m_detected_packet_size;
+      discard_read_buffer();
+
+      if (resync(start_at))
         continue;
       return finish();
     }
 
+    ++m_num_packets_read;
     parse_packet(buf);
 
     if (m_packet_sent_to_packetizer)
@@ -1665,6 +1693,86 @@ mpeg_ts_reader_c::read(generic_packetizer_c *requested_ptzr,
   }
 }
 
+unsigned char *
+mpeg_ts_reader_c::read_buffered_packet() {
+  if ((m_read_buffer_pos + m_detected_packet_size) > m_read_buffer_fill) {
+    auto block_size = (TS_READ_BUFFER_SIZE / m_detected_packet_size) * m_detected_packet_size;
+    auto remaining  = m_read_buffer_fill - m_read_buffer_pos;
+
+    // Without a partial packet left over the next block can be parsed
+    // right from the mapping.
+    auto direct_size = static_cast<size_t>(block_size);
+    auto block       = m_mmap_in && !remaining ? m_mmap_in->read_direct(direct_size) : nullptr;
+
+    if (block) {
+      m_read_block       = block;
+      m_read_buffer_pos  = 0;
+      m_read_buffer_fill = direct_size;
+
+    } else {
+      if (!m_read_buffer)
+        m_read_buffer = memory_c::alloc(block_size);
+
+      auto buffer = m_read_buffer->get_buffer();
+
+      if (remaining)
+        std::memmove(buffer, m_read_block + m_read_buffer_pos, remaining);
+
+      m_read_block       = buffer;
+      m_read_buffer_pos  = 0;
+      m_read_buffer_fill = remaining + m_in->read(buffer + remaining, m_read_buffer->get_size() - remaining);
+    }
+
+    if (m_read_buffer_fill < m_detected_packet_size)
+      return nullptr;
+  }
+
+  // The packet is only read from, so handing out mapped memory is safe.
+  auto packet         = const_cast<unsigned char *>(m_read_block) + m_read_buffer_pos;
+  m_read_buffer_pos  += m_detected_packet_size;
+
+  return packet;
+}
+
+void
+mpeg_ts_reader_c::discard_read_buffer() {
+  m_read_buffer_pos  = 0;
+  m_read_buffer_fill = 0;
+}
+
+int64_t
+mpeg_ts_reader_c::get_read_position() {
+  return m_in->getFilePointer() - (m_read_buffer_fill - m_read_buffer_pos);
+}
+
+int
+mpeg_ts_reader_c::get_progress() {
+  return 100 * get_read_position() / m_size;
+}
+
+void
+mpeg_ts_reader_c::invalidate_pid_to_track_idx() {
+  m_pid_to_track_idx_valid = false;
+}
+
+int
+mpeg_ts_reader_c::find_track_idx_for_pid(uint16_t pid) {
+  if (!m_pid_to_track_idx_valid) {
+    std::fill(m_pid_to_track_idx.begin(), m_pid_to_track_idx.end(), -1);
+
+    // If several tracks use the same PID then the first one wins.
+    for (int tidx = tracks.size() - 1; 0 <= tidx; --tidx) {
+      auto &track = *tracks[tidx];
+      if ((TS_NUM_PIDS > track.pid) && (m_probing || (-1 != track.ptzr)))
+        m_pid_to_track_idx[track.pid] = tidx;
+    }
+
+    m_pid_to_track_idx_valid = true;
+  }
+
+  return TS_NUM_PIDS > pid ? m_pid_to_track_idx[pid] : -1;
+}
+
 bfs::path
 mpeg_ts_reader_c::find_clip_info_file() {
   auto mpls_multi_in = dynamic_cast<mm_mpls_multi_file_io_c *>(get_underlying_input());
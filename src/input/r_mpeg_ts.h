@@ -24,6 +24,7 @@
 #include "common/dts.h"
 #include "common/hevc.h"
 #include "common/mm_io.h"
+#include "common/mm_mmap_io.h"
 #include "common/mpeg4_p10.h"
 #include "common/truehd.h"
 #include "input/packet_converter.h"
@@ -405,7 +406,23 @@ protected:
 
   std::vector<timestamp_c> m_chapter_timestamps;
 
-  debugging_option_c m_dont_use_audio_pts, m_debug_resync, m_debug_pat_pmt, m_debug_headers, m_debug_packet, m_debug_aac, m_debug_timestamp_wrapping, m_debug_clpi;
+  // Maps each of the 8192 possible PIDs to the index in 'tracks' of
+  // the track handling it (or -1). Must be invalidated whenever
+  // 'tracks', a track's PID, a track's packetizer or 'm_probing'
+  // change.
+  std::vector<int> m_pid_to_track_idx;
+  bool m_pid_to_track_idx_valid;
+
+  // Packets are read in large blocks and parsed in place. For
+  // memory-mapped files the blocks point into the mapping directly.
+  memory_cptr m_read_buffer;
+  unsigned char const *m_read_block;
+  size_t m_read_buffer_pos, m_read_buffer_fill;
+  mm_mmap_io_c *m_mmap_in;
+
+  int64_t m_num_packets_read, m_read_start_time;
+
+  debugging_option_c m_dont_use_audio_pts, m_debug_resync, m_debug_pat_pmt, m_debug_headers, m_debug_packet, m_debug_aac, m_debug_timestamp_wrapping, m_debug_clpi, m_debug_performance;
 
   unsigned int m_detected_packet_size, m_num_pat_crc_errors, m_num_pmt_crc_errors;
   bool m_validate_pat_crc, m_validate_pmt_crc;
@@ -429,6 +446,7 @@ public:
   virtual void create_packetizer(int64_t tid);
   virtual void create_packetizers();
   virtual void add_available_track_ids();
+  virtual int get_progress();
 
   virtual bool parse_packet(unsigned char *buf);
 
@@ -461,6 +479,13 @@ private:
 
   bool resync(int64_t start_at);
 
+  unsigned char *read_buffered_packet();
+  void discard_read_buffer();
+  int64_t get_read_position();
+
+  int find_track_idx_for_pid(uint16_t pid);
+  void invalidate_pid_to_track_idx();
+
   uint32_t calculate_crc(void const *buffer, size_t size) const;
 
   friend class mpeg_ts_track_c;
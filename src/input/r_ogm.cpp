@@ -813,9 +813,13 @@ ogm_reader_c::handle_stream_comments() {
     if (title != "") {
       title = cch->utf8(title);
       if (!g_segment_title_set && g_segment_title.empty() && dmx->ms_compat) {
-        g_segment_title     = title;
-        g_segment_title_set = true;
-        segment_title_set   = true;
+        // Several files may be identified concurrently. Identification
+        // doesn't use the global title anyway.
+        if (!g_identifying) {
+          g_segment_title     = title;
+          g_segment_title_set = true;
+        }
+        segment_title_set = true;
       }
       dmx->title = title.c_str();
       title      = "";
@@ -1194,7 +1198,7 @@ ogm_a_opus_demuxer_c::process_page(int64_t granulepos) {
     if ((4 <= op.bytes) && !memcmp(op.packet, "Opus", 4))
       continue;
 
-    auto packet                = std::make_shared<packet_t>(memory_c::clone(op.packet, op.bytes));
+    auto packet                = packet_t::create(memory_c::clone(op.packet, op.bytes));
     auto toc                   = mtx::opus::toc_t::decode(packet->data);
     m_calculated_end_timecode += toc.packet_duration;
 
@@ -1309,7 +1313,7 @@ ogm_v_mscomp_demuxer_c::initialize() {
   stream_header *sth = (stream_header *)(packet_data[0]->get_buffer() + 1);
   codec              = codec_c::look_up(get_codec());
 
-  if (0 > g_video_fps)
+  if (!g_identifying && (0 > g_video_fps))
     g_video_fps = 10000000.0 / (float)get_uint64_le(&sth->time_unit);
 
   default_duration = 100 * get_uint64_le(&sth->time_unit);
@@ -126,6 +126,7 @@ qtmp4_reader_c::qtmp4_reader_c(const track_info_c &ti,
                                const mm_io_cptr &in)
   : generic_reader_c(ti, in)
   , m_time_scale(1)
+  , m_duration(0)
   , m_compression_algorithm{}
   , m_main_dmx(-1)
   , m_audio_encoder_delay_samples(0)
@@ -134,11 +135,17 @@ qtmp4_reader_c::qtmp4_reader_c(const track_info_c &ti,
   , m_fragment{}
   , m_track_for_fragment{}
   , m_timecodes_calculated{}
+  , m_read_buffer_pos{}
+  , m_num_bytes_read{}
+  , m_num_reads{}
+  , m_num_seeks{}
+  , m_badly_interleaved{}
   , m_debug_chapters{    "qtmp4|qtmp4_full|qtmp4_chapters"}
   , m_debug_headers{     "qtmp4|qtmp4_full|qtmp4_headers"}
   , m_debug_tables{            "qtmp4_full|qtmp4_tables"}
   , m_debug_interleaving{"qtmp4|qtmp4_full|qtmp4_interleaving"}
   , m_debug_resync{      "qtmp4|qtmp4_full|qtmp4_resync"}
+  , m_debug_reads{       "qtmp4|qtmp4_full|qtmp4_reads"}
 {
 }
 
@@ -158,6 +165,7 @@ qtmp4_reader_c::read_headers() {
 }
 
 qtmp4_reader_c::~qtmp4_reader_c() {
+  mxdebug_if(m_debug_reads, boost::format("Sample data: %1% bytes read in %2% reads with %3% seeks\n") % m_num_bytes_read % m_num_reads % m_num_seeks);
 }
 
 qt_atom_t
@@ -430,20 +438,18 @@ qtmp4_reader_c::handle_cmvd_atom(qt_atom_t atom,
 
 void
 qtmp4_reader_c::handle_ctts_atom(qtmp4_demuxer_cptr &new_dmx,
-                                 qt_atom_t,
+                                 qt_atom_t parent,
                                  int level) {
   m_in->skip(1 + 3);        // version & flags
   uint32_t count = m_in->read_uint32_be();
+  auto values    = read_uint32_be_table(parent, 8, count, 2);
   mxdebug_if(m_debug_headers, boost::format("%1%Frame offset table: %2% raw entries\n") % space(level * 2 + 1) % count);
 
-  size_t i;
-  for (i = 0; i < count; ++i) {
-    qt_frame_offset_t frame_offset;
+  new_dmx->raw_frame_offset_table.reserve(new_dmx->raw_frame_offset_table.size() + count);
 
-    frame_offset.count  = m_in->read_uint32_be();
-    frame_offset.offset = m_in->read_uint32_be();
-    new_dmx->raw_frame_offset_table.push_back(frame_offset);
-  }
+  size_t i;
+  for (i = 0; i < count; ++i)
+    new_dmx->raw_frame_offset_table.emplace_back(values[i * 2], values[i * 2 + 1]);
 
   if (m_debug_tables) {
     i = 0;
@@ -858,7 +864,11 @@ qtmp4_reader_c::handle_mvhd_atom(qt_atom_t atom,
 
   m_time_scale = get_uint32_be(&mvhd.time_scale);
 
-  mxdebug_if(m_debug_headers, boost::format("%1%Time scale: %2%\n") % space(level * 2 + 1) % m_time_scale);
+  // Version 1 headers use 64-bit fields; their duration is ignored.
+  if (0 == mvhd.version)
+    m_duration = get_uint32_be(&mvhd.duration);
+
+  mxdebug_if(m_debug_headers, boost::format("%1%Time scale: %2% duration: %3%\n") % space(level * 2 + 1) % m_time_scale % m_duration);
 }
 
 void
@@ -1121,15 +1131,17 @@ qtmp4_reader_c::handle_stbl_atom(qtmp4_demuxer_cptr &new_dmx,
 
 void
 qtmp4_reader_c::handle_stco_atom(qtmp4_demuxer_cptr &new_dmx,
-                                 qt_atom_t,
+                                 qt_atom_t parent,
                                  int level) {
   m_in->skip(1 + 3);        // version & flags
   uint32_t count = m_in->read_uint32_be();
+  auto offsets   = read_uint32_be_table(parent, 8, count);
 
   mxdebug_if(m_debug_headers, boost::format("%1%Chunk offset table: %2% entries\n") % space(level * 2 + 1) % count);
 
-  for (auto i = 0u; i < count; ++i)
-    new_dmx->chunk_table.emplace_back(0, m_in->read_uint32_be());
+  new_dmx->chunk_table.reserve(new_dmx->chunk_table.size() + count);
+  for (auto offset : offsets)
+    new_dmx->chunk_table.emplace_back(0, offset);
 
   if (m_debug_tables)
     for (auto const &chunk : new_dmx->chunk_table)
@@ -1138,15 +1150,17 @@ qtmp4_reader_c::handle_stco_atom(qtmp4_demuxer_cptr &new_dmx,
 
 void
 qtmp4_reader_c::handle_co64_atom(qtmp4_demuxer_cptr &new_dmx,
-                                 qt_atom_t,
+                                 qt_atom_t parent,
                                  int level) {
   m_in->skip(1 + 3);        // version & flags
   uint32_t count = m_in->read_uint32_be();
+  auto halves    = read_uint32_be_table(parent, 8, count, 2);
 
   mxdebug_if(m_debug_headers, boost::format("%1%64bit chunk offset table: %2% entries\n") % space(level * 2 + 1) % count);
 
+  new_dmx->chunk_table.reserve(new_dmx->chunk_table.size() + count);
   for (auto i = 0u; i < count; ++i)
-    new_dmx->chunk_table.emplace_back(0, m_in->read_uint64_be());
+    new_dmx->chunk_table.emplace_back(0, (static_cast<uint64_t>(halves[i * 2]) << 32) | halves[i * 2 + 1]);
 
   if (m_debug_tables)
     for (auto const &chunk : new_dmx->chunk_table)
@@ -1155,17 +1169,21 @@ qtmp4_reader_c::handle_co64_atom(qtmp4_demuxer_cptr &new_dmx,
 
 void
 qtmp4_reader_c::handle_stsc_atom(qtmp4_demuxer_cptr &new_dmx,
-                                 qt_atom_t,
+                                 qt_atom_t parent,
                                  int level) {
   m_in->skip(1 + 3);        // version & flags
   uint32_t count = m_in->read_uint32_be();
+  auto values    = read_uint32_be_table(parent, 8, count, 3);
+
+  new_dmx->chunkmap_table.reserve(new_dmx->chunkmap_table.size() + count);
+
   size_t i;
   for (i = 0; i < count; ++i) {
     qt_chunkmap_t chunkmap;
 
-    chunkmap.first_chunk           = m_in->read_uint32_be() - 1;
-    chunkmap.samples_per_chunk     = m_in->read_uint32_be();
-    chunkmap.sample_description_id = m_in->read_uint32_be();
+    chunkmap.first_chunk           = values[i * 3] - 1;
+    chunkmap.samples_per_chunk     = values[i * 3 + 1];
+    chunkmap.sample_description_id = values[i * 3 + 2];
     new_dmx->chunkmap_table.push_back(chunkmap);
   }
 
@@ -1207,14 +1225,13 @@ qtmp4_reader_c::handle_stsd_atom(qtmp4_demuxer_cptr &new_dmx,
 
 void
 qtmp4_reader_c::handle_stss_atom(qtmp4_demuxer_cptr &new_dmx,
-                                 qt_atom_t,
+                                 qt_atom_t parent,
                                  int level) {
   m_in->skip(1 + 3);        // version & flags
   uint32_t count = m_in->read_uint32_be();
+  auto keyframes = read_uint32_be_table(parent, 8, count);
 
-  size_t i;
-  for (i = 0; i < count; ++i)
-    new_dmx->keyframe_table.push_back(m_in->read_uint32_be());
+  new_dmx->keyframe_table.insert(new_dmx->keyframe_table.end(), keyframes.begin(), keyframes.end());
 
   std::sort(new_dmx->keyframe_table.begin(), new_dmx->keyframe_table.end());
 
@@ -1226,26 +1243,21 @@ qtmp4_reader_c::handle_stss_atom(qtmp4_demuxer_cptr &new_dmx,
 
 void
 qtmp4_reader_c::handle_stsz_atom(qtmp4_demuxer_cptr &new_dmx,
-                                 qt_atom_t,
+                                 qt_atom_t parent,
                                  int level) {
   m_in->skip(1 + 3);        // version & flags
   uint32_t sample_size = m_in->read_uint32_be();
   uint32_t count       = m_in->read_uint32_be();
 
   if (0 == sample_size) {
-    size_t i;
-    for (i = 0; i < count; ++i) {
-      qt_sample_t sample;
+    auto sizes = read_uint32_be_table(parent, 12, count);
 
-      sample.size = m_in->read_uint32_be();
+    new_dmx->sample_table.reserve(new_dmx->sample_table.size() + count);
 
+    for (auto size : sizes)
       // This is a sanity check against damaged samples. I have one of
       // those in which one sample was suppposed to be > 2GB big.
-      if (sample.size >= 100 * 1024 * 1024)
-        sample.size = 0;
-
-      new_dmx->sample_table.push_back(sample);
-    }
+      new_dmx->sample_table.emplace_back(size >= 100 * 1024 * 1024 ? 0 : size);
 
     mxdebug_if(m_debug_headers, boost::format("%1%Sample size table: %2% entries\n") % space(level * 2 + 1) % count);
     if (m_debug_tables) {
@@ -1262,19 +1274,17 @@ qtmp4_reader_c::handle_stsz_atom(qtmp4_demuxer_cptr &new_dmx,
 
 void
 qtmp4_reader_c::handle_sttd_atom(qtmp4_demuxer_cptr &new_dmx,
-                                 qt_atom_t,
+                                 qt_atom_t parent,
                                  int level) {
   m_in->skip(1 + 3);        // version & flags
   uint32_t count = m_in->read_uint32_be();
+  auto values    = read_uint32_be_table(parent, 8, count, 2);
 
-  size_t i;
-  for (i = 0; i < count; ++i) {
-    qt_durmap_t durmap;
+  new_dmx->durmap_table.reserve(new_dmx->durmap_table.size() + count);
 
-    durmap.number   = m_in->read_uint32_be();
-    durmap.duration = m_in->read_uint32_be();
-    new_dmx->durmap_table.push_back(durmap);
-  }
+  size_t i;
+  for (i = 0; i < count; ++i)
+    new_dmx->durmap_table.emplace_back(values[i * 2], values[i * 2 + 1]);
 
   mxdebug_if(m_debug_headers, boost::format("%1%Sample duration table: %2% entries\n") % space(level * 2 + 1) % count);
   if (m_debug_tables) {
@@ -1286,19 +1296,17 @@ qtmp4_reader_c::handle_sttd_atom(qtmp4_demuxer_cptr &new_dmx,
 
 void
 qtmp4_reader_c::handle_stts_atom(qtmp4_demuxer_cptr &new_dmx,
-                                 qt_atom_t,
+                                 qt_atom_t parent,
                                  int level) {
   m_in->skip(1 + 3);        // version & flags
   uint32_t count = m_in->read_uint32_be();
+  auto values    = read_uint32_be_table(parent, 8, count, 2);
 
-  size_t i;
-  for (i = 0; i < count; ++i) {
-    qt_durmap_t durmap;
+  new_dmx->durmap_table.reserve(new_dmx->durmap_table.size() + count);
 
-    durmap.number   = m_in->read_uint32_be();
-    durmap.duration = m_in->read_uint32_be();
-    new_dmx->durmap_table.push_back(durmap);
-  }
+  size_t i;
+  for (i = 0; i < count; ++i)
+    new_dmx->durmap_table.emplace_back(values[i * 2], values[i * 2 + 1]);
 
   mxdebug_if(m_debug_headers, boost::format("%1%Sample duration table: %2% entries\n") % space(level * 2 + 1) % count);
   if (m_debug_tables) {
@@ -1458,29 +1466,25 @@ qtmp4_reader_c::read(generic_packetizer_c *ptzr,
   qtmp4_demuxer_cptr &dmx = m_demuxers[dmx_idx];
   qt_index_t &index       = dmx->m_index[dmx->pos];
 
-  m_in->setFilePointer(index.file_pos);
+  auto buffer = read_sample(index);
 
-  int buffer_offset = 0;
-  memory_cptr buffer;
+  if (!buffer) {
+    mxwarn(boost::format(Y("Quicktime/MP4 reader: Could not read chunk number %1%/%2% with size %3% from position %4%. Aborting.\n"))
+           % dmx->pos % dmx->m_index.size() % index.size % index.file_pos);
+    return flush_packetizers();
+  }
 
   if (   dmx->is_video()
       && !dmx->pos
       && dmx->codec.is(codec_c::type_e::V_MPEG4_P2)
       && dmx->esds_parsed
       && (dmx->esds.decoder_config)) {
-    buffer        = memory_c::alloc(index.size + dmx->esds.decoder_config->get_size());
-    buffer_offset = dmx->esds.decoder_config->get_size();
-
-    memcpy(buffer->get_buffer(), dmx->esds.decoder_config->get_buffer(), dmx->esds.decoder_config->get_size());
+    auto with_config = memory_c::alloc(index.size + dmx->esds.decoder_config->get_size());
 
-  } else {
-    buffer = memory_c::alloc(index.size);
-  }
+    memcpy(with_config->get_buffer(),                                         dmx->esds.decoder_config->get_buffer(), dmx->esds.decoder_config->get_size());
+    memcpy(with_config->get_buffer() + dmx->esds.decoder_config->get_size(), buffer->get_buffer(),                   index.size);
 
-  if (m_in->read(buffer->get_buffer() + buffer_offset, index.size) != index.size) {
-    mxwarn(boost::format(Y("Quicktime/MP4 reader: Could not read chunk number %1%/%2% with size %3% from position %4%. Aborting.\n"))
-           % dmx->pos % dmx->m_index.size() % index.size % index.file_pos);
-    return flush_packetizers();
+    buffer = with_config;
   }
 
   PTZR(dmx->ptzr)->process(new packet_t(buffer, index.timecode, index.duration, index.is_keyframe ? VFT_IFRAME : VFT_PFRAMEAUTOMATIC, VFT_NOBFRAME));
@@ -1492,6 +1496,129 @@ qtmp4_reader_c::read(generic_packetizer_c *ptzr,
   return flush_packetizers();
 }
 
+// Returns the sample's content as a view into the buffer of the run
+// containing it. If it isn't contained in the buffer of the last read
+// run then a new run starting at the sample is read. For badly
+// interleaved files consecutive samples usually belong to tracks
+// stored far apart; runs would be thrown away after a single sample,
+// so only the sample itself is read.
+memory_cptr
+qtmp4_reader_c::read_sample(qt_index_t const &index) {
+  auto start_pos = static_cast<uint64_t>(index.file_pos);
+  auto end_pos   = start_pos + index.size;
+
+  if (   !m_read_buffer
+      || (start_pos < m_read_buffer_pos)
+      || (end_pos   > (m_read_buffer_pos + m_read_buffer->get_size()))) {
+    m_read_buffer.reset();
+
+    auto run_end  = m_badly_interleaved ? end_pos : determine_read_run_end(start_pos, end_pos);
+    auto run_size = run_end - start_pos;
+    auto buffer   = memory_c::alloc(run_size);
+
+    if (m_in->getFilePointer() != start_pos) {
+      m_in->setFilePointer(start_pos);
+      ++m_num_seeks;
+    }
+
+    auto num_read     = m_in->read(buffer->get_buffer(), run_size);
+    m_num_bytes_read += num_read;
+    ++m_num_reads;
+
+    if (num_read < static_cast<uint64_t>(index.size))
+      return {};
+
+    buffer->set_size(num_read);
+    m_read_buffer     = buffer;
+    m_read_buffer_pos = start_pos;
+
+    mxdebug_if(m_debug_reads, boost::format("read run at %1% size %2% (sample size %3%)\n") % start_pos % num_read % index.size);
+  }
+
+  return memory_c::view(m_read_buffer, start_pos - m_read_buffer_pos, index.size);
+}
+
+// Finds the end of the area starting at 'start_pos' that is covered
+// by upcoming samples of all tracks that are read. Gaps smaller than
+// the maximum are read along instead of seeking over them; the
+// samples of interleaved files are therefore usually read with one
+// large read per interleaving period.
+//
+// A sample handed out as a view keeps its whole run alive for as long
+// as it is queued. The run size is therefore limited relative to the
+// size of the sample starting it so that small samples, e.g. audio
+// frames, don't pin megabytes of memory each.
+uint64_t
+qtmp4_reader_c::determine_read_run_end(uint64_t start_pos,
+                                       uint64_t min_end_pos) {
+  static auto const s_min_run_size            = uint64_t{256 * 1024};
+  static auto const s_max_run_size            = uint64_t{4 * 1024 * 1024};
+  static auto const s_max_run_size_per_sample = uint64_t{64};
+  static auto const s_max_gap                 = uint64_t{64 * 1024};
+  static auto const s_max_num_looked          = size_t{16384};
+
+  auto run_size    = std::min(std::max((min_end_pos - start_pos) * s_max_run_size_per_sample, s_min_run_size), s_max_run_size);
+  auto max_end_pos = std::max(start_pos + run_size, min_end_pos);
+  std::vector<std::pair<uint64_t, uint64_t>> extents;
+
+  for (auto const &dmx : m_demuxers) {
+    if (-1 == dmx->ptzr)
+      continue;
+
+    for (auto idx = static_cast<size_t>(dmx->pos), end = std::min(dmx->m_index.size(), idx + s_max_num_looked); idx < end; ++idx) {
+      auto const &index = dmx->m_index[idx];
+      auto sample_start = static_cast<uint64_t>(index.file_pos);
+      auto sample_end   = sample_start + index.size;
+
+      if (sample_start >= max_end_pos)
+        break;
+
+      if ((sample_start >= start_pos) && (sample_end <= max_end_pos))
+        extents.emplace_back(sample_start, sample_end);
+    }
+  }
+
+  brng::sort(extents);
+
+  auto run_end = min_end_pos;
+  for (auto const &extent : extents) {
+    if (extent.first > (run_end + s_max_gap))
+      break;
+    run_end = std::max(run_end, extent.second);
+  }
+
+  return run_end;
+}
+
+// Reads all entries of a sample table atom with one read and converts
+// them from big endian in one go. The number of entries is limited to
+// what actually fits into the atom so that damaged counts don't lead
+// to huge allocations.
+std::vector<uint32_t>
+qtmp4_reader_c::read_uint32_be_table(qt_atom_t const &parent,
+                                     uint64_t num_header_bytes,
+                                     uint32_t &num_entries,
+                                     unsigned int num_values_per_entry) {
+  auto entry_size      = uint64_t{4} * num_values_per_entry;
+  auto max_num_entries = parent.size > num_header_bytes ? (parent.size - num_header_bytes) / entry_size : 0;
+
+  if (num_entries > max_num_entries) {
+    mxdebug_if(m_debug_headers, boost::format("Table in atom at %1% claims %2% entries but only has room for %3%\n") % parent.pos % num_entries % max_num_entries);
+    num_entries = max_num_entries;
+  }
+
+  auto num_values = static_cast<size_t>(num_entries) * num_values_per_entry;
+  auto data       = memory_c::alloc(num_values * 4);
+
+  if (m_in->read(data->get_buffer(), num_values * 4) != (num_values * 4))
+    throw mtx::mm_io::end_of_file_x{};
+
+  std::vector<uint32_t> values(num_values);
+  get_uint32_be_array(values.data(), data->get_buffer(), num_values);
+
+  return values;
+}
+
 memory_cptr
 qtmp4_reader_c::create_bitmap_info_header(qtmp4_demuxer_cptr &dmx,
                                           const char *fourcc,
@@ -1802,6 +1929,12 @@ qtmp4_reader_c::create_packetizers() {
     create_packetizer(m_demuxers[i]->id);
 }
 
+timestamp_c
+qtmp4_reader_c::get_duration()
+  const {
+  return (0 != m_duration) && (0 != m_time_scale) ? timestamp_c::ns(m_duration * 1000000000ll / m_time_scale) : timestamp_c{};
+}
+
 int
 qtmp4_reader_c::get_progress() {
   if (-1 == m_main_dmx)
@@ -1928,8 +2061,10 @@ qtmp4_reader_c::detect_interleaving() {
   double badness = *boost::max_element(gradients) - *boost::min_element(gradients);
   mxdebug_if(m_debug_interleaving, boost::format("Interleaving: Badness: %1% (%2%)\n") % badness % (MAX_INTERLEAVING_BADNESS < badness ? "badly interleaved" : "ok"));
 
-  if (MAX_INTERLEAVING_BADNESS < badness)
+  if (MAX_INTERLEAVING_BADNESS < badness) {
     m_in->enable_buffering(false);
+    m_badly_interleaved = true;
+  }
 }
 
 // ----------------------------------------------------------------------
@@ -2291,6 +2426,8 @@ qtmp4_demuxer_c::build_index_constant_sample_size_mode() {
   auto v1_bytes_per_frame    = 1 == v0_audio_version ? get_uint32_be(&sound_stsd_atom->v1.bytes_per_frame)    : 0;
   auto v1_samples_per_packet = 1 == v0_audio_version ? get_uint32_be(&sound_stsd_atom->v1.samples_per_packet) : 0;
 
+  m_index.reserve(m_index.size() + chunk_table.size());
+
   size_t frame_idx;
   for (frame_idx = 0; frame_idx < chunk_table.size(); ++frame_idx) {
     uint64_t frame_size;
@@ -2327,6 +2464,8 @@ qtmp4_demuxer_c::build_index_chunk_mode() {
   size_t keyframe_table_idx  = 0;
   size_t keyframe_table_size = keyframe_table.size();
 
+  m_index.reserve(m_index.size() + frame_indices.size());
+
   size_t frame_idx;
   for (frame_idx = 0; frame_idx < frame_indices.size(); ++frame_idx) {
     int act_frame_idx = frame_indices[frame_idx];
@@ -432,7 +432,7 @@ private:
   std::unordered_map<unsigned int, bool> m_chapter_track_ids;
   std::unordered_map<unsigned int, qt_track_defaults_t> m_track_defaults;
 
-  int64_t m_time_scale;
+  int64_t m_time_scale, m_duration;
   fourcc_c m_compression_algorithm;
   int m_main_dmx;
 
@@ -444,7 +444,14 @@ private:
 
   bool m_timecodes_calculated;
 
-  debugging_option_c m_debug_chapters, m_debug_headers, m_debug_tables, m_debug_interleaving, m_debug_resync;
+  // Samples are read in runs spanning several samples of all tracks
+  // and handed out as views into the run's buffer. Badly interleaved
+  // files are read sample by sample instead.
+  memory_cptr m_read_buffer;
+  uint64_t m_read_buffer_pos, m_num_bytes_read, m_num_reads, m_num_seeks;
+  bool m_badly_interleaved;
+
+  debugging_option_c m_debug_chapters, m_debug_headers, m_debug_tables, m_debug_interleaving, m_debug_resync, m_debug_reads;
 
   friend class qtmp4_demuxer_c;
 
@@ -459,6 +466,7 @@ public:
   virtual void read_headers();
   virtual file_status_e read(generic_packetizer_c *ptzr, bool force = false);
   virtual int get_progress();
+  virtual timestamp_c get_duration() const;
   virtual void identify();
   virtual void create_packetizers();
   virtual void create_packetizer(int64_t tid);
@@ -540,7 +548,11 @@ protected:
 
   virtual void detect_interleaving();
 
+  virtual memory_cptr read_sample(qt_index_t const &index);
+  virtual uint64_t determine_read_run_end(uint64_t start_pos, uint64_t min_end_pos);
+
   virtual std::string read_string_atom(qt_atom_t atom, size_t num_skipped);
+  virtual std::vector<uint32_t> read_uint32_be_table(qt_atom_t const &parent, uint64_t num_header_bytes, uint32_t &num_entries, unsigned int num_values_per_entry = 1);
 };
 
 #endif  // MTX_INPUT_R_QTMP4_H
@@ -91,7 +91,7 @@ webvtt_reader_c::read(generic_packetizer_c *,
     return FILE_STATUS_DONE;
 
   auto cue    = m_parser->get_cue();
-  auto packet = std::make_shared<packet_t>(cue->m_content, cue->m_start.to_ns(), cue->m_duration.to_ns());
+  auto packet = packet_t::create(cue->m_content, cue->m_start.to_ns(), cue->m_duration.to_ns());
 
   if (cue->m_addition)
     packet->data_adds.emplace_back(cue->m_addition);
@@ -14,6 +14,8 @@
 
 #include "common/common_pch.h"
 
+#include <unordered_map>
+
 #include "common/ebml.h"
 #include "common/hacks.h"
 #include "common/math.h"
@@ -22,6 +24,7 @@
 #include "common/translation.h"
 #include "merge/cluster_helper.h"
 #include "merge/cues.h"
+#include "merge/direct_cluster_renderer.h"
 #include "merge/libmatroska_extensions.h"
 #include "merge/output_control.h"
 #include "merge/packet_extensions.h"
@@ -294,6 +297,29 @@ cluster_helper_c::set_output(mm_io_c *out) {
   m->out = out;
 }
 
+// Returns the BlockDuration to set for a group of frames with the given
+// durations or -1 if none is needed.
+static int64_t
+determine_block_duration(std::vector<int64_t> const &durations,
+                         bool duration_mandatory,
+                         int64_t def_duration) {
+  int64_t block_duration = boost::accumulate(durations, int64_t{});
+
+  if (duration_mandatory) {
+    if (   (0 == block_duration)
+        || (   (0 < block_duration)
+            && (RND_TIMECODE_SCALE(block_duration) != RND_TIMECODE_SCALE(static_cast<int64_t>(durations.size()) * def_duration))))
+      return RND_TIMECODE_SCALE(block_duration);
+
+  } else if (   (   g_use_durations
+                 || (0 < def_duration))
+             && (0 < block_duration)
+             && (RND_TIMECODE_SCALE(block_duration) != RND_TIMECODE_SCALE(durations.size() * def_duration)))
+    return RND_TIMECODE_SCALE(block_duration);
+
+  return -1;
+}
+
 void
 cluster_helper_c::set_duration(render_groups_c *rg) {
   if (rg->m_durations.empty())
@@ -301,26 +327,15 @@ cluster_helper_c::set_duration(render_groups_c *rg) {
 
   kax_block_blob_c *group = rg->m_groups.back().get();
   int64_t def_duration    = rg->m_source->get_track_default_duration();
-  int64_t block_duration  = 0;
+  int64_t block_duration  = boost::accumulate(rg->m_durations, int64_t{});
 
-  size_t i;
-  for (i = 0; rg->m_durations.size() > i; ++i)
-    block_duration += rg->m_durations[i];
   mxdebug_if(m->debug_duration,
              boost::format("cluster_helper::set_duration: block_duration %1% rounded duration %2% def_duration %3% use_durations %4% rg->m_duration_mandatory %5%\n")
              % block_duration % RND_TIMECODE_SCALE(block_duration) % def_duration % (g_use_durations ? 1 : 0) % (rg->m_duration_mandatory ? 1 : 0));
 
-  if (rg->m_duration_mandatory) {
-    if (   (0 == block_duration)
-        || (   (0 < block_duration)
-            && (RND_TIMECODE_SCALE(block_duration) != RND_TIMECODE_SCALE(static_cast<int64_t>(rg->m_durations.size()) * def_duration))))
-      group->set_block_duration(RND_TIMECODE_SCALE(block_duration));
-
-  } else if (   (   g_use_durations
-                 || (0 < def_duration))
-             && (0 < block_duration)
-             && (RND_TIMECODE_SCALE(block_duration) != RND_TIMECODE_SCALE(rg->m_durations.size() * def_duration)))
-    group->set_block_duration(RND_TIMECODE_SCALE(block_duration));
+  auto duration = determine_block_duration(rg->m_durations, rg->m_duration_mandatory, def_duration);
+  if (-1 != duration)
+    group->set_block_duration(duration);
 }
 
 bool
@@ -371,8 +386,8 @@ cluster_helper_c::must_duration_be_set(render_groups_c *rg,
 int
 cluster_helper_c::render() {
   std::vector<render_groups_cptr> render_groups;
-  KaxCues cues;
-  cues.SetGlobalTimecodeScale(g_timecode_scale);
+  std::vector<std::pair<kax_block_blob_c *, int64_t>> cue_blobs;
+  KaxCues no_cues;
 
   bool use_simpleblock    = !hack_engaged(ENGAGE_NO_SIMPLE_BLOCKS);
 
@@ -393,6 +408,11 @@ cluster_helper_c::render() {
   m->timecode_offset       = boost::accumulate(m->packets, m->timecode_offset, [](int64_t a, const packet_cptr &p) { return std::min(a, p->assigned_timecode); });
   int64_t timecode_offset = m->timecode_offset + get_discarded_duration();
 
+  if (can_render_directly()) {
+    render_directly(timecode_offset);
+    return 1;
+  }
+
   for (auto &pack : m->packets) {
     generic_packetizer_c *source = pack->source;
     bool has_codec_state         = !!pack->codec_state;
@@ -491,8 +511,6 @@ cluster_helper_c::render() {
     render_group->m_durations.push_back(pack->get_unmodified_duration());
     render_group->m_duration_mandatory |= pack->duration_mandatory;
 
-    cues_c::get().set_duration_for_id_timecode(source->get_track_num(), pack->assigned_timecode - timecode_offset, pack->get_duration());
-
     if (new_block_group) {
       // Set the reference priority if it was wanted.
       if ((0 < pack->ref_priority) && new_block_group->replace_simple_by_group())
@@ -521,8 +539,8 @@ cluster_helper_c::render() {
 
     else if (g_write_cues && (!added_to_cues || has_codec_state)) {
       added_to_cues = add_to_cues_maybe(pack);
-      if (added_to_cues)
-        cues.AddBlockBlob(*new_block_group);
+      if (added_to_cues && (cue_blobs.end() == brng::find_if(cue_blobs, [new_block_group](std::pair<kax_block_blob_c *, int64_t> const &blob) { return blob.first == new_block_group; })))
+        cue_blobs.emplace_back(new_block_group, source->wants_cue_duration() ? pack->get_duration() : 0);
     }
 
     pack->group = new_block_group;
@@ -541,7 +559,11 @@ cluster_helper_c::render() {
       m->cluster->set_min_timecode(min_cl_timecode - timecode_offset);
       m->cluster->set_max_timecode(max_cl_timecode - timecode_offset);
 
-      m->cluster->Render(*m->out, cues);
+      if (g_write_crc32_elements)
+        render_ebml_master_with_crc32(*m->out, *m->cluster, [this, &no_cues](IOCallback &buffer) { m->cluster->Render(buffer, no_cues); }, m->cluster_content_size + 1024);
+      else
+        m->cluster->Render(*m->out, no_cues);
+
       m->bytes_in_file += m->cluster->ElementSize();
 
       if (g_kax_sh_cues)
@@ -549,7 +571,8 @@ cluster_helper_c::render() {
 
       m->previous_cluster_tc = m->cluster->GlobalTimecode();
 
-      cues_c::get().postprocess_cues(cues, *m->cluster);
+      for (auto const &point : create_cue_points_for_block_blobs(*g_kax_segment, *m->cluster, cue_blobs))
+        cues_c::get().add(point);
 
     } else
       m->previous_cluster_tc = -1;
@@ -563,6 +586,129 @@ cluster_helper_c::render() {
   return 1;
 }
 
+// Clusters whose blocks would each contain a single frame without
+// block additions, codec states etc. are written without building
+// libmatroska's element tree.
+bool
+cluster_helper_c::can_render_directly() {
+  if (m->packets.empty() || discarding() || hack_engaged(ENGAGE_NO_DIRECT_CLUSTER_RENDERING))
+    return false;
+
+  // Whether or not the rendering loop in render() would add the next
+  // frame of a source to the block containing the source's previous
+  // frame.
+  std::unordered_map<generic_packetizer_c *, bool> more_data;
+
+  for (auto &pack : m->packets) {
+    auto source       = pack->source;
+    auto &track_entry = static_cast<KaxTrackEntry &>(*source->get_track_entry());
+
+    if (   source->contains_gap()
+        || (0x80 <= source->get_track_num())
+        || !pack->data_adds.empty()
+        || pack->codec_state
+        || pack->has_discard_padding()
+        || (0 < pack->ref_priority))
+      return false;
+
+    auto &source_more_data = more_data[source];
+
+    if (   source_more_data
+        && pack->is_key_frame()
+        && !must_duration_be_set(nullptr, pack)
+        && !source->is_lacing_prevented())
+      return false;
+
+    // libmatroska's KaxInternalBlock::AddFrame() doesn't accept further
+    // frames after one with six times 255 bytes or more.
+    source_more_data = pack->is_key_frame()
+                    && track_entry.LacingEnabled()
+                    && (pack->data->get_size() < 6 * 0xff);
+  }
+
+  return true;
+}
+
+// Does the same as the rendering loop in render() does for the
+// clusters accepted by can_render_directly(), but writes the blocks with
+// direct_cluster_renderer_c instead of libmatroska.
+void
+cluster_helper_c::render_directly(int64_t timecode_offset) {
+  auto use_simpleblock = !hack_engaged(ENGAGE_NO_SIMPLE_BLOCKS);
+  auto min_cl_timecode = std::numeric_limits<int64_t>::max();
+  auto max_cl_timecode = int64_t{};
+
+  for (auto &pack : m->packets) {
+    min_cl_timecode = std::min(pack->assigned_timecode, min_cl_timecode);
+    max_cl_timecode = std::max(pack->assigned_timecode, max_cl_timecode);
+  }
+
+  m->cluster->SetPreviousTimecode(min_cl_timecode - timecode_offset - 1, (int64_t)g_timecode_scale);
+  m->cluster->set_min_timecode(min_cl_timecode - timecode_offset);
+  m->cluster->set_max_timecode(max_cl_timecode - timecode_offset);
+
+  direct_cluster_renderer_c renderer{*m->cluster};
+
+  for (auto &pack : m->packets) {
+    auto source       = pack->source;
+    auto &track_entry = static_cast<KaxTrackEntry &>(*source->get_track_entry());
+
+    if (g_video_packetizer == source)
+      m->max_video_timecode_rendered = std::max(pack->assigned_timecode + pack->get_duration(), m->max_video_timecode_rendered);
+
+    for (auto const &extension : pack->extensions)
+      if (packet_extension_c::BEFORE_ADDING_TO_CLUSTER_CB == extension->get_type())
+        static_cast<before_adding_to_cluster_cb_packet_extension_c *>(extension.get())->get_callback()(pack, timecode_offset);
+
+    auto timecode   = pack->assigned_timecode - timecode_offset;
+    auto past_block = pack->has_bref() ? pack->bref - timecode_offset : -1;
+    auto forw_block = pack->has_fref() ? pack->fref - timecode_offset : -1;
+
+    if (!use_simpleblock || must_duration_be_set(nullptr, pack))
+      renderer.add_block_group(track_entry, timecode, pack->data, past_block, forw_block,
+                               determine_block_duration({ pack->get_unmodified_duration() }, pack->duration_mandatory, source->get_track_default_duration()));
+    else
+      renderer.add_simple_block(track_entry, timecode, pack->data, past_block, forw_block);
+
+    if (-1 == m->first_timecode_in_file)
+      m->first_timecode_in_file = pack->assigned_timecode;
+    if (-1 == m->first_timecode_in_part)
+      m->first_timecode_in_part = pack->assigned_timecode;
+
+    m->min_timecode_in_file      = std::min(timestamp_c::ns(pack->assigned_timecode),       m->min_timecode_in_file.value_or_max());
+    m->max_timecode_in_file      = std::max(pack->assigned_timecode,                        m->max_timecode_in_file);
+    m->max_timecode_and_duration = std::max(pack->assigned_timecode + pack->get_duration(), m->max_timecode_and_duration);
+
+    if (g_write_cues && add_to_cues_maybe(pack))
+      renderer.add_cue_point(source->wants_cue_duration() ? pack->get_duration() : 0);
+
+    pack->group = nullptr;
+
+    pack->account(m->track_statistics[ source->get_uid() ]);
+
+    source->after_packet_rendered(*pack);
+  }
+
+  auto cue_points = renderer.render(*m->out, *g_kax_segment, g_write_crc32_elements);
+
+  m->bytes_in_file += m->cluster->ElementSize();
+
+  if (g_kax_sh_cues)
+    g_kax_sh_cues->IndexThis(*m->cluster, *g_kax_segment);
+
+  m->previous_cluster_tc = m->cluster->GlobalTimecode();
+
+  for (auto const &point : cue_points)
+    cues_c::get().add(point);
+
+  mxdebug_if(m->debug_rendering, boost::format("render_directly: cluster at %1% with %2% blocks\n") % m->cluster->GetElementPosition() % m->packets.size());
+
+  m->min_timecode_in_cluster = -1;
+  m->max_timecode_in_cluster = -1;
+
+  m->cluster->delete_non_blocks();
+}
+
 bool
 cluster_helper_c::add_to_cues_maybe(packet_cptr &pack) {
   auto &source  = *pack->source;
@@ -97,6 +97,9 @@ private:
   void split(packet_cptr &packet);
 
   bool add_to_cues_maybe(packet_cptr &pack);
+
+  bool can_render_directly();
+  void render_directly(int64_t timecode_offset);
 };
 
 extern std::unique_ptr<cluster_helper_c> g_cluster_helper;
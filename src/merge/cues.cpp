@@ -13,74 +13,149 @@
 
 #include "common/common_pch.h"
 
+#include <numeric>
+
 #include "common/debugging.h"
 #include "common/ebml.h"
+#include "common/endian.h"
 #include "common/fs_sys_helpers.h"
 #include "common/hacks.h"
 #include "common/math.h"
 #include "merge/cluster_helper.h"
 #include "merge/cues.h"
-#include "merge/generic_packetizer.h"
 #include "merge/libmatroska_extensions.h"
 #include "merge/output_control.h"
 
 cues_cptr cues_c::s_cues;
 
+namespace {
+
+template<typename T>
+void
+permute(std::vector<T> &column,
+        std::vector<uint32_t> const &order) {
+  if (column.empty())
+    return;
+
+  std::vector<T> permuted;
+  permuted.reserve(column.size());
+
+  for (auto idx : order)
+    permuted.push_back(column[idx]);
+
+  column.swap(permuted);
+}
+
+template<typename T>
+void
+set_optional_column(std::vector<T> &column,
+                    size_t idx,
+                    T value) {
+  if (!value && column.empty())
+    return;
+
+  if (column.size() <= idx)
+    column.resize(idx + 1, 0);
+
+  column[idx] = value;
+}
+
+template<typename T>
+T
+get_optional_column(std::vector<T> const &column,
+                    size_t idx) {
+  return idx < column.size() ? column[idx] : 0;
+}
+
+unsigned char *
+put_ebml_id(unsigned char *buffer,
+            EbmlId const &id) {
+  id.Fill(buffer);
+  return buffer + EBML_ID_LENGTH(id);
+}
+
+unsigned char *
+put_ebml_uint(unsigned char *buffer,
+              EbmlId const &id,
+              uint64_t value,
+              size_t num_bytes) {
+  buffer    = put_ebml_id(buffer, id);
+  *buffer++ = 0x80 | num_bytes;
+  put_uint_be(buffer, value, num_bytes);
+
+  return buffer + num_bytes;
+}
+
+}
+
 cues_c::cues_c()
-  : m_num_cue_points_postprocessed{}
-  , m_no_cue_duration{hack_engaged(ENGAGE_NO_CUE_DURATION)}
+  : m_no_cue_duration{hack_engaged(ENGAGE_NO_CUE_DURATION)}
   , m_no_cue_relative_position{hack_engaged(ENGAGE_NO_CUE_RELATIVE_POSITION)}
   , m_debug_cue_duration{         "cues|cues_cue_duration"}
   , m_debug_cue_relative_position{"cues|cues_cue_relative_position"}
 {
 }
 
+// Adds a cue point. Its relative position and duration have to be
+// determined by the caller while the cluster is rendered.
 void
-cues_c::set_duration_for_id_timecode(uint64_t id,
-                                     uint64_t timecode,
-                                     uint64_t duration) {
-  if (!m_no_cue_duration)
-    m_id_timecode_duration_multimap.insert({ id_timecode_t{id, timecode}, duration });
-}
+cues_c::add(cue_point_t const &point) {
+  auto idx = m_timecodes.size();
 
-void
-cues_c::add(KaxCues &cues) {
-  for (auto child : cues) {
-    auto point = dynamic_cast<KaxCuePoint *>(child);
-    if (point)
-      add(*point);
-  }
-}
+  m_timecodes.push_back(point.timecode / g_timecode_scale);
+  m_track_nums.push_back(point.track_num);
+  m_relative_positions.push_back(m_no_cue_relative_position ? 0 : point.relative_position);
 
-void
-cues_c::add(KaxCuePoint &point) {
-  uint64_t timecode = FindChildValue<KaxCueTime>(point) * g_timecode_scale;
+  if (m_cluster_positions.empty() || (m_cluster_positions.back() != point.cluster_position))
+    m_cluster_positions.push_back(point.cluster_position);
+  m_cluster_indexes.push_back(m_cluster_positions.size() - 1);
 
-  for (auto point_child : point) {
-    auto positions = dynamic_cast<KaxCueTrackPositions *>(point_child);
-    if (!positions)
-      continue;
+  if (point.duration && !m_no_cue_duration)
+    set_optional_column(m_durations, idx, static_cast<uint64_t>(RND_TIMECODE_SCALE(point.duration) / g_timecode_scale));
 
-    uint64_t track_num = FindChildValue<KaxCueTrack>(*positions);
-    assert(track_num <= static_cast<uint64_t>(std::numeric_limits<uint32_t>::max()));
+  set_optional_column(m_codec_state_positions, idx, point.codec_state_position);
 
-    m_points.push_back({ timecode, 0, FindChildValue<KaxCueClusterPosition>(*positions), static_cast<uint32_t>(track_num), 0 });
+  mxdebug_if(m_debug_cue_relative_position,
+             boost::format("cue_relative_position: <%1%:%2%>: cluster_position %3% relative_position %4%\n")
+             % point.track_num % point.timecode % point.cluster_position % point.relative_position);
+  mxdebug_if(m_debug_cue_duration, boost::format("cue_duration: <%1%:%2%>: %3%\n") % point.track_num % point.timecode % point.duration);
+}
 
-    uint64_t codec_state_position = FindChildValue<KaxCueCodecState>(*positions);
-    if (codec_state_position)
-      m_codec_state_position_map[ id_timecode_t{ track_num, timecode } ] = codec_state_position;
-  }
+size_t
+cues_c::get_num_points()
+  const {
+  return m_timecodes.size();
+}
+
+cue_point_t
+cues_c::get_point(size_t idx)
+  const {
+  return { m_timecodes[idx] * g_timecode_scale,
+           get_optional_column(m_durations, idx) * g_timecode_scale,
+           m_cluster_positions[m_cluster_indexes[idx]],
+           get_optional_column(m_codec_state_positions, idx),
+           m_track_nums[idx],
+           m_relative_positions[idx] };
+}
+
+void
+cues_c::clear() {
+  m_timecodes.clear();
+  m_durations.clear();
+  m_codec_state_positions.clear();
+  m_cluster_positions.clear();
+  m_track_nums.clear();
+  m_relative_positions.clear();
+  m_cluster_indexes.clear();
 }
 
 void
 cues_c::write(mm_io_c &out,
               KaxSeekHead &seek_head) {
-  if (!m_points.size() || !g_cue_writing_requested)
+  if (m_timecodes.empty() || !g_cue_writing_requested)
     return;
 
-  // auto start = mtx::sys::get_current_time_millis();
   sort();
-  // auto end_sort = mtx::sys::get_current_time_millis();
 
   // Need to write the (empty) cues element so that its position will
   // be set for indexing in g_kax_sh_main. Necessary because there's
@@ -97,158 +172,127 @@ cues_c::write(mm_io_c &out,
 
   // Forcefully write the correct head and copy its content from the
   // temporary storage location.
-  auto total_size = calculate_total_size();
+  auto total_size = calculate_total_size() + (g_write_crc32_elements ? ebml_crc32_element_size : 0);
   write_ebml_element_head(out, EBML_ID(KaxCues), total_size);
 
-  for (auto &point : m_points) {
-    KaxCuePoint kc_point;
+  // With CRC-32 elements the cue points are collected in memory first
+  // so that the checksum can be written in front of them.
+  std::unique_ptr<mm_positioned_mem_io_c> crc32_content;
+  if (g_write_crc32_elements)
+    crc32_content = std::make_unique<mm_positioned_mem_io_c>(out.getFilePointer() + ebml_crc32_element_size, total_size);
 
-    GetChild<KaxCueTime>(kc_point).SetValue(point.timecode / g_timecode_scale);
+  auto &points_out = crc32_content ? static_cast<mm_io_c &>(*crc32_content) : out;
 
-    auto &positions = GetChild<KaxCueTrackPositions>(kc_point);
-    GetChild<KaxCueTrack>(positions).SetValue(point.track_num);
-    GetChild<KaxCueClusterPosition>(positions).SetValue(point.cluster_position);
+  // The points are serialized directly into a buffer that is flushed
+  // whenever it is nearly full. A single point never exceeds 128 bytes.
+  std::vector<unsigned char> buffer(64 * 1024);
+  auto buffer_end = buffer.data() + buffer.size() - 128;
+  auto ptr        = buffer.data();
 
-    auto codec_state_position = m_codec_state_position_map.find({ point.track_num, point.timecode });
-    if (codec_state_position != m_codec_state_position_map.end())
-      GetChild<KaxCueCodecState>(positions).SetValue(codec_state_position->second);
+  for (auto idx = 0u, num_points = static_cast<unsigned int>(m_timecodes.size()); idx < num_points; ++idx) {
+    ptr = render_point(ptr, idx);
 
-    if (point.relative_position)
-      GetChild<KaxCueRelativePosition>(positions).SetValue(point.relative_position);
-
-    if (point.duration)
-      GetChild<KaxCueDuration>(positions).SetValue(RND_TIMECODE_SCALE(point.duration) / g_timecode_scale);
-
-    kc_point.Render(out);
+    if (ptr >= buffer_end) {
+      points_out.write(buffer.data(), ptr - buffer.data());
+      ptr = buffer.data();
+    }
   }
 
-  m_points.clear();
-  m_codec_state_position_map.clear();
-  m_num_cue_points_postprocessed = 0;
+  points_out.write(buffer.data(), ptr - buffer.data());
+
+  if (crc32_content)
+    write_ebml_crc32_and_content(out, *crc32_content);
 
-  // auto end_all = mtx::sys::get_current_time_millis();
-  // mxinfo(boost::format("dur sort %1% write %2% total %3%\n") % (end_sort - start) % (end_all - end_sort) % (end_all - start));
+  clear();
 }
 
+// The points arrive nearly sorted as clusters are written in order.
+// Only points that are out of order cause a permutation of all
+// columns.
 void
 cues_c::sort() {
-  brng::sort(m_points, [](cue_point_t const &a, cue_point_t const &b) -> bool {
-      if (a.timecode < b.timecode)
-        return true;
-      if (a.timecode > b.timecode)
-        return false;
-
-      if (a.track_num < b.track_num)
-        return true;
-
-      return false;
-    });
-}
-
-std::multimap<id_timecode_t, uint64_t>
-cues_c::calculate_block_positions(KaxCluster &cluster)
-  const {
-
-  std::multimap<id_timecode_t, uint64_t> positions;
-
-  for (auto child : cluster) {
-    auto simple_block = dynamic_cast<KaxSimpleBlock *>(child);
-    if (simple_block) {
-      simple_block->SetParent(cluster);
-      positions.insert({ id_timecode_t{ simple_block->TrackNum(), simple_block->GlobalTimecode()}, simple_block->GetElementPosition() });
-      continue;
-    }
+  auto less = [this](uint32_t a, uint32_t b) -> bool {
+    if (m_timecodes[a] != m_timecodes[b])
+      return m_timecodes[a] < m_timecodes[b];
+    return m_track_nums[a] < m_track_nums[b];
+  };
 
-    auto block_group = dynamic_cast<KaxBlockGroup *>(child);
-    if (!block_group)
-      continue;
+  auto num_points = static_cast<uint32_t>(m_timecodes.size());
+  auto idx        = 1u;
 
-    auto block = FindChild<KaxBlock>(block_group);
-    if (!block)
-      continue;
+  while ((idx < num_points) && !less(idx, idx - 1))
+    ++idx;
 
-    block->SetParent(cluster);
-    positions.insert({ id_timecode_t{ block->TrackNum(), block->GlobalTimecode()}, block_group->GetElementPosition() });
-  }
-
-  return positions;
-}
-
-void
-cues_c::postprocess_cues(KaxCues &cues,
-                         KaxCluster &cluster) {
-  add(cues);
-
-  if (m_no_cue_duration && m_no_cue_relative_position)
+  if (idx >= num_points)
     return;
 
-  auto cluster_data_start_pos = cluster.GetElementPosition() + cluster.HeadSize();
-  auto block_positions        = calculate_block_positions(cluster);
-  std::map<id_timecode_t, size_t> nblocks_processed; //# blocks processed so far with given track #/timecode
-
-  for (auto point = m_points.begin() + m_num_cue_points_postprocessed, end = m_points.end(); point != end; ++point) {
-    nblocks_processed[id_timecode_t{ point->track_num, point->timecode }]++;
-
-    // Set CueRelativePosition for all cues.
-    if (!m_no_cue_relative_position) {
-      auto pair          = block_positions.equal_range({ point->track_num, point->timecode });
-      auto position_itr  = pair.first;
-      auto pos_end       = pair.second;
-      auto num_processed = nblocks_processed[id_timecode_t{ point->track_num, point->timecode }];
-
-      for (auto i = 0u; ((i + 1) < num_processed) && (position_itr != pos_end); ++i)
-        position_itr++;
-
-      auto relative_position = block_positions.end() != position_itr ? std::max(position_itr->second, cluster_data_start_pos) - cluster_data_start_pos : 0ull;
-
-      assert(relative_position <= static_cast<uint64_t>(std::numeric_limits<uint32_t>::max()));
-
-      point->relative_position = relative_position;
-
-      mxdebug_if(m_debug_cue_relative_position,
-                 boost::format("cue_relative_position: looking for <%1%:%2%>: cluster_data_start_pos %3% position %4%\n")
-                 % point->track_num % point->timecode % cluster_data_start_pos % relative_position);
-    }
-
-    // Set CueDuration if the packetizer wants them.
-    if (m_no_cue_duration)
-      continue;
-
-    auto pair          = m_id_timecode_duration_multimap.equal_range({ point->track_num, point->timecode });
-    auto duration_itr  = pair.first;
-    auto dur_end       = pair.second;
-    auto num_processed = nblocks_processed[id_timecode_t{ point->track_num, point->timecode }];
-
-    for (auto i = 0u; ((i + 1) < num_processed) && (duration_itr != dur_end); ++i)
-      duration_itr++;
+  std::vector<uint32_t> order(num_points);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), less);
+
+  // The optional columns are filled up so that they can be permuted
+  // like the other ones.
+  if (!m_durations.empty())
+    m_durations.resize(num_points, 0);
+  if (!m_codec_state_positions.empty())
+    m_codec_state_positions.resize(num_points, 0);
+
+  permute(m_timecodes,             order);
+  permute(m_durations,             order);
+  permute(m_codec_state_positions, order);
+  permute(m_track_nums,            order);
+  permute(m_relative_positions,    order);
+  permute(m_cluster_indexes,       order);
+}
 
-    auto ptzr         = g_packetizers_by_track_num[point->track_num];
+uint64_t
+cues_c::calculate_total_size()
+  const {
+  auto total_size = 0ull;
 
-    if (!ptzr || !ptzr->wants_cue_duration())
-      continue;
+  for (auto idx = 0u, num_points = static_cast<unsigned int>(m_timecodes.size()); idx < num_points; ++idx)
+    total_size += calculate_point_size(idx);
 
-    if (m_id_timecode_duration_multimap.end() != duration_itr)
-      point->duration = duration_itr->second;
+  return total_size;
+}
 
-    mxdebug_if(m_debug_cue_duration,
-               boost::format("cue_duration: looking for <%1%:%2%>: %3%\n")
-               % point->track_num % point->timecode % (duration_itr == m_id_timecode_duration_multimap.end() ? static_cast<int64_t>(-1) : duration_itr->second));
-  }
+// The size of the whole Cues element including its head as write()
+// will produce it.
+uint64_t
+cues_c::calculate_element_size()
+  const {
+  if (m_timecodes.empty())
+    return 0;
 
-  m_num_cue_points_postprocessed = m_points.size();
+  auto content_size = calculate_total_size() + (g_write_crc32_elements ? ebml_crc32_element_size : 0);
 
-  m_id_timecode_duration_multimap.clear();
+  return EBML_ID_LENGTH(EBML_ID(KaxCues)) + CodedSizeLength(content_size, 0) + content_size;
 }
 
+// Estimates the size of a Cues element with 'num_points' points for a
+// file with the given duration (in nanoseconds) and size. Each point is
+// assumed to carry a relative position but neither a duration nor a
+// codec state.
 uint64_t
-cues_c::calculate_total_size()
-  const {
-  return boost::accumulate(m_points, 0ull, [this](uint64_t sum, cue_point_t const &point) { return sum + calculate_point_size(point); });
+cues_c::estimate_element_size(uint64_t num_points,
+                              uint64_t duration,
+                              uint64_t file_size) {
+  if (!num_points)
+    return 0;
+
+  uint64_t point_size = EBML_ID_LENGTH(EBML_ID(KaxCuePoint))            + 1
+                      + EBML_ID_LENGTH(EBML_ID(KaxCueTime))             + 1 + calculate_bytes_for_uint(duration / g_timecode_scale)
+                      + EBML_ID_LENGTH(EBML_ID(KaxCueTrackPositions))   + 1
+                      + EBML_ID_LENGTH(EBML_ID(KaxCueTrack))            + 1 + 1
+                      + EBML_ID_LENGTH(EBML_ID(KaxCueClusterPosition))  + 1 + calculate_bytes_for_uint(file_size)
+                      + EBML_ID_LENGTH(EBML_ID(KaxCueRelativePosition)) + 1 + 3;
+  auto content_size   = num_points * point_size + (g_write_crc32_elements ? ebml_crc32_element_size : 0);
+
+  return EBML_ID_LENGTH(EBML_ID(KaxCues)) + CodedSizeLength(content_size, 0) + content_size;
 }
 
 uint64_t
-cues_c::calculate_bytes_for_uint(uint64_t value)
-  const {
+cues_c::calculate_bytes_for_uint(uint64_t value) {
   for (int idx = 1; 7 >= idx; ++idx)
     if (value < (1ull << (idx * 8)))
       return idx;
@@ -256,46 +300,92 @@ cues_c::calculate_bytes_for_uint(uint64_t value)
 }
 
 uint64_t
-cues_c::calculate_point_size(cue_point_t const &point)
+cues_c::calculate_point_size(size_t idx)
   const {
   uint64_t point_size = EBML_ID_LENGTH(EBML_ID(KaxCuePoint))           + 1
-                      + EBML_ID_LENGTH(EBML_ID(KaxCuePoint))           + 1 + calculate_bytes_for_uint(point.timecode / g_timecode_scale)
+                      + EBML_ID_LENGTH(EBML_ID(KaxCueTime))            + 1 + calculate_bytes_for_uint(m_timecodes[idx])
                       + EBML_ID_LENGTH(EBML_ID(KaxCueTrackPositions))  + 1
-                      + EBML_ID_LENGTH(EBML_ID(KaxCueTrack))           + 1 + calculate_bytes_for_uint(point.track_num)
-                      + EBML_ID_LENGTH(EBML_ID(KaxCueClusterPosition)) + 1 + calculate_bytes_for_uint(point.cluster_position);
+                      + EBML_ID_LENGTH(EBML_ID(KaxCueTrack))           + 1 + calculate_bytes_for_uint(m_track_nums[idx])
+                      + EBML_ID_LENGTH(EBML_ID(KaxCueClusterPosition)) + 1 + calculate_bytes_for_uint(m_cluster_positions[m_cluster_indexes[idx]]);
 
-  auto codec_state_position = m_codec_state_position_map.find({ point.track_num, point.timecode });
-  if (codec_state_position != m_codec_state_position_map.end())
-    point_size += EBML_ID_LENGTH(EBML_ID(KaxCueCodecState)) + 1 + calculate_bytes_for_uint(codec_state_position->second);
+  auto codec_state_position = get_optional_column(m_codec_state_positions, idx);
+  if (codec_state_position)
+    point_size += EBML_ID_LENGTH(EBML_ID(KaxCueCodecState)) + 1 + calculate_bytes_for_uint(codec_state_position);
 
-  if (point.relative_position)
-    point_size += EBML_ID_LENGTH(EBML_ID(KaxCueRelativePosition)) + 1 + calculate_bytes_for_uint(point.relative_position);
+  if (m_relative_positions[idx])
+    point_size += EBML_ID_LENGTH(EBML_ID(KaxCueRelativePosition)) + 1 + calculate_bytes_for_uint(m_relative_positions[idx]);
 
-  if (point.duration)
-    point_size += EBML_ID_LENGTH(EBML_ID(KaxCueDuration)) + 1 + calculate_bytes_for_uint(RND_TIMECODE_SCALE(point.duration) / g_timecode_scale);
+  auto duration = get_optional_column(m_durations, idx);
+  if (duration)
+    point_size += EBML_ID_LENGTH(EBML_ID(KaxCueDuration)) + 1 + calculate_bytes_for_uint(duration);
 
   return point_size;
 }
 
+// Writes a single CuePoint with the same layout libmatroska would
+// produce: the children in the order CueTime, CueTrack,
+// CueClusterPosition, CueCodecState, CueRelativePosition and
+// CueDuration, each with the minimal number of bytes.
+unsigned char *
+cues_c::render_point(unsigned char *buffer,
+                     size_t idx)
+  const {
+  auto cluster_position     = m_cluster_positions[m_cluster_indexes[idx]];
+  auto codec_state_position = get_optional_column(m_codec_state_positions, idx);
+  auto relative_position    = m_relative_positions[idx];
+  auto duration             = get_optional_column(m_durations, idx);
+
+  auto positions_size = EBML_ID_LENGTH(EBML_ID(KaxCueTrack))           + 1 + calculate_bytes_for_uint(m_track_nums[idx])
+                      + EBML_ID_LENGTH(EBML_ID(KaxCueClusterPosition)) + 1 + calculate_bytes_for_uint(cluster_position);
+
+  if (codec_state_position)
+    positions_size += EBML_ID_LENGTH(EBML_ID(KaxCueCodecState)) + 1 + calculate_bytes_for_uint(codec_state_position);
+  if (relative_position)
+    positions_size += EBML_ID_LENGTH(EBML_ID(KaxCueRelativePosition)) + 1 + calculate_bytes_for_uint(relative_position);
+  if (duration)
+    positions_size += EBML_ID_LENGTH(EBML_ID(KaxCueDuration)) + 1 + calculate_bytes_for_uint(duration);
+
+  auto time_size  = calculate_bytes_for_uint(m_timecodes[idx]);
+  auto point_size = EBML_ID_LENGTH(EBML_ID(KaxCueTime)) + 1 + time_size + EBML_ID_LENGTH(EBML_ID(KaxCueTrackPositions)) + 1 + positions_size;
+
+  buffer    = put_ebml_id(buffer, EBML_ID(KaxCuePoint));
+  *buffer++ = 0x80 | point_size;
+  buffer    = put_ebml_uint(buffer, EBML_ID(KaxCueTime), m_timecodes[idx], time_size);
+
+  buffer    = put_ebml_id(buffer, EBML_ID(KaxCueTrackPositions));
+  *buffer++ = 0x80 | positions_size;
+  buffer    = put_ebml_uint(buffer, EBML_ID(KaxCueTrack),           m_track_nums[idx], calculate_bytes_for_uint(m_track_nums[idx]));
+  buffer    = put_ebml_uint(buffer, EBML_ID(KaxCueClusterPosition), cluster_position,  calculate_bytes_for_uint(cluster_position));
+
+  if (codec_state_position)
+    buffer = put_ebml_uint(buffer, EBML_ID(KaxCueCodecState),       codec_state_position, calculate_bytes_for_uint(codec_state_position));
+  if (relative_position)
+    buffer = put_ebml_uint(buffer, EBML_ID(KaxCueRelativePosition), relative_position,    calculate_bytes_for_uint(relative_position));
+  if (duration)
+    buffer = put_ebml_uint(buffer, EBML_ID(KaxCueDuration),         duration,             calculate_bytes_for_uint(duration));
+
+  return buffer;
+}
+
 void
 cues_c::adjust_positions(uint64_t old_position,
                          uint64_t delta) {
   auto s_debug_rerender_track_headers = debugging_option_c{"rerender|rerender_track_headers"};
 
-  if (!delta || (m_points.empty() && m_codec_state_position_map.empty()))
+  if (!delta || m_timecodes.empty())
     return;
 
   mxdebug_if(s_debug_rerender_track_headers,
              boost::format("[rerender] cues_c::adjust_positions: old_position %1% delta %2% num_points %3% first point's position %4%\n")
-             % old_position % delta % m_points.size() % (!m_points.empty() ? m_points[0].cluster_position : 0));
+             % old_position % delta % m_timecodes.size() % m_cluster_positions[m_cluster_indexes[0]]);
 
-  for (auto &point : m_points)
-    if (point.cluster_position >= old_position)
-      point.cluster_position += delta;
+  for (auto &position : m_cluster_positions)
+    if (position >= old_position)
+      position += delta;
 
-  for (auto &element : m_codec_state_position_map)
-    if (element.second >= old_position)
-      element.second += delta;
+  for (auto &position : m_codec_state_positions)
+    if (position && (position >= old_position))
+      position += delta;
 }
 
 cues_c &
@@ -304,3 +394,49 @@ cues_c::get() {
     s_cues = std::make_shared<cues_c>();
   return *s_cues;
 }
+
+// Cue points for clusters rendered by libmatroska are created once the
+// cluster has been written, as only then the positions of the blocks
+// within the cluster are known.
+std::vector<cue_point_t>
+create_cue_points_for_block_blobs(KaxSegment const &segment,
+                                  KaxCluster &cluster,
+                                  std::vector<std::pair<kax_block_blob_c *, int64_t>> const &blobs) {
+  std::vector<cue_point_t> cue_points;
+
+  auto cluster_position       = segment.GetRelativePosition(cluster);
+  auto cluster_data_start_pos = cluster.GetElementPosition() + cluster.HeadSize();
+
+  for (auto const &blob_and_duration : blobs) {
+    auto &blob                  = *blob_and_duration.first;
+    EbmlElement *element        = nullptr;
+    KaxInternalBlock *block     = nullptr;
+    KaxCodecState *codec_state  = nullptr;
+
+    if (blob.IsSimpleBlock()) {
+      auto &simple_block = static_cast<KaxSimpleBlock &>(blob);
+      element            = &simple_block;
+      block              = &simple_block;
+
+    } else {
+      auto &block_group  = static_cast<KaxBlockGroup &>(blob);
+      element            = &block_group;
+      block              = FindChild<KaxBlock>(block_group);
+      codec_state        = FindChild<KaxCodecState>(block_group);
+    }
+
+    if (!block)
+      continue;
+
+    block->SetParent(cluster);
+
+    cue_points.push_back({ block->GlobalTimecode(),
+                           static_cast<uint64_t>(blob_and_duration.second),
+                           cluster_position,
+                           codec_state ? segment.GetRelativePosition(codec_state->GetElementPosition()) : 0,
+                           static_cast<uint32_t>(block->TrackNum()),
+                           static_cast<uint32_t>(element->GetElementPosition() - cluster_data_start_pos) });
+  }
+
+  return cue_points;
+}
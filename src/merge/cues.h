@@ -16,29 +16,33 @@
 
 #include "common/common_pch.h"
 
+#include <matroska/KaxCluster.h>
 #include <matroska/KaxCues.h>
 #include <matroska/KaxCuesData.h>
 #include <matroska/KaxSeekHead.h>
+#include <matroska/KaxSegment.h>
 
 #include "common/mm_io.h"
 
-using id_timecode_t = std::pair<uint64_t, uint64_t>;
-
 struct cue_point_t {
-  uint64_t timecode, duration, cluster_position;
+  uint64_t timecode, duration, cluster_position, codec_state_position;
   uint32_t track_num, relative_position;
 };
 
 class cues_c;
+class kax_block_blob_c;
 using cues_cptr = std::shared_ptr<cues_c>;
 
+// The cue points are stored column by column. Timecodes and durations
+// are kept in units of the timecode scale, the cluster positions in a
+// separate table referenced by index as all cue points of a cluster
+// share its position. The duration and codec state columns are only
+// allocated once the first point actually uses them.
 class cues_c {
 protected:
-  std::vector<cue_point_t> m_points;
-  std::multimap<id_timecode_t, uint64_t> m_id_timecode_duration_multimap;
-  std::map<id_timecode_t, uint64_t> m_codec_state_position_map;
+  std::vector<uint64_t> m_timecodes, m_durations, m_codec_state_positions, m_cluster_positions;
+  std::vector<uint32_t> m_track_nums, m_relative_positions, m_cluster_indexes;
 
-  size_t m_num_cue_points_postprocessed;
   bool m_no_cue_duration, m_no_cue_relative_position;
   debugging_option_c m_debug_cue_duration, m_debug_cue_relative_position;
 
@@ -48,22 +52,29 @@ protected:
 public:
   cues_c();
 
-  void add(KaxCues &cues);
-  void add(KaxCuePoint &point);
+  void add(cue_point_t const &point);
   void write(mm_io_c &out, KaxSeekHead &seek_head);
-  void postprocess_cues(KaxCues &cues, KaxCluster &cluster);
-  void set_duration_for_id_timecode(uint64_t id, uint64_t timecode, uint64_t duration);
   void adjust_positions(uint64_t old_position, uint64_t delta);
 
+  size_t get_num_points() const;
+  cue_point_t get_point(size_t idx) const;
+
+  uint64_t calculate_element_size() const;
+
 public:
   static cues_c &get();
+  static uint64_t estimate_element_size(uint64_t num_points, uint64_t duration, uint64_t file_size);
 
 protected:
   void sort();
-  std::multimap<id_timecode_t, uint64_t> calculate_block_positions(KaxCluster &cluster) const;
+  void clear();
   uint64_t calculate_total_size() const;
-  uint64_t calculate_point_size(cue_point_t const &point) const;
-  uint64_t calculate_bytes_for_uint(uint64_t value) const;
+  uint64_t calculate_point_size(size_t idx) const;
+  unsigned char *render_point(unsigned char *buffer, size_t idx) const;
+
+  static uint64_t calculate_bytes_for_uint(uint64_t value);
 };
 
+std::vector<cue_point_t> create_cue_points_for_block_blobs(KaxSegment const &segment, KaxCluster &cluster, std::vector<std::pair<kax_block_blob_c *, int64_t>> const &blobs);
+
 #endif  // MTX_MERGE_CUES_H
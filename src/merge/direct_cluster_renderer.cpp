@@ -0,0 +1,218 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   rendering clusters without libmatroska's element tree
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <matroska/KaxBlock.h>
+#include <matroska/KaxBlockData.h>
+#include <matroska/KaxClusterData.h>
+
+#include "common/ebml.h"
+#include "common/endian.h"
+#include "merge/direct_cluster_renderer.h"
+
+static uint64_t
+calculate_element_size(EbmlId const &id,
+                       uint64_t content_size) {
+  return EBML_ID_LENGTH(id) + CodedSizeLength(content_size, 0) + content_size;
+}
+
+// The number of bytes libebml uses for storing a signed integer.
+static unsigned int
+calculate_bytes_for_int(int64_t value) {
+  auto num_bytes = 1u;
+  while (   (8 > num_bytes)
+         && (   (value <  -(int64_t{1} << (num_bytes * 8 - 1)))
+             || (value >=  (int64_t{1} << (num_bytes * 8 - 1)))))
+    ++num_bytes;
+
+  return num_bytes;
+}
+
+// The number of bytes libebml uses for storing an unsigned integer.
+static unsigned int
+calculate_bytes_for_uint(uint64_t value) {
+  auto num_bytes = 1u;
+  while ((8 > num_bytes) && (value >> (num_bytes * 8)))
+    ++num_bytes;
+
+  return num_bytes;
+}
+
+static void
+write_ebml_int_element(mm_io_c &out,
+                       EbmlId const &id,
+                       uint64_t value,
+                       unsigned int num_bytes) {
+  unsigned char buffer[8];
+  put_uint64_be(buffer, value);
+
+  write_ebml_element_head(out, id, num_bytes);
+  out.write(&buffer[8 - num_bytes], num_bytes);
+}
+
+direct_cluster_renderer_c::direct_cluster_renderer_c(kax_cluster_c &cluster)
+  : m_cluster(cluster)
+{
+}
+
+void
+direct_cluster_renderer_c::add_simple_block(KaxTrackEntry const &track,
+                                            int64_t timecode,
+                                            memory_cptr const &data,
+                                            int64_t past_block,
+                                            int64_t forw_block) {
+  m_blocks.push_back({ track.TrackNumber(), timecode, past_block, forw_block, -1, track.GlobalTimecodeScale(), false, false, 0, data });
+}
+
+void
+direct_cluster_renderer_c::add_block_group(KaxTrackEntry const &track,
+                                           int64_t timecode,
+                                           memory_cptr const &data,
+                                           int64_t past_block,
+                                           int64_t forw_block,
+                                           int64_t duration) {
+  m_blocks.push_back({ track.TrackNumber(), timecode, past_block, forw_block, duration, track.GlobalTimecodeScale(), true, false, 0, data });
+}
+
+void
+direct_cluster_renderer_c::add_cue_point(uint64_t duration) {
+  assert(!m_blocks.empty());
+
+  m_blocks.back().add_cue_point = true;
+  m_blocks.back().cue_duration  = duration;
+}
+
+// Track number, relative timecode, flags and the frame.
+uint64_t
+direct_cluster_renderer_c::calculate_block_size(block_t const &block)
+  const {
+  return 4 + block.data->get_size();
+}
+
+// A BlockGroup contains the Block followed by the ReferenceBlocks for
+// the past and the forward reference and the BlockDuration, in the
+// order kax_block_group_c::add_frame() and
+// kax_block_blob_c::set_block_duration() add them.
+uint64_t
+direct_cluster_renderer_c::calculate_block_group_size(block_t const &block)
+  const {
+  auto size = calculate_element_size(EBML_ID(KaxBlock), calculate_block_size(block));
+
+  for (auto reference : { block.past_block, block.forw_block })
+    if (0 <= reference)
+      size += calculate_element_size(EBML_ID(KaxReferenceBlock), calculate_bytes_for_int((reference - block.timecode) / block.timecode_scale));
+
+  if (-1 != block.duration)
+    size += calculate_element_size(EBML_ID(KaxBlockDuration), calculate_bytes_for_uint(block.duration / block.timecode_scale));
+
+  return size;
+}
+
+void
+direct_cluster_renderer_c::render_block(mm_io_c &out,
+                                        EbmlId const &id,
+                                        block_t const &block,
+                                        unsigned char flags) {
+  unsigned char header[4];
+  header[0] = 0x80 | block.track_num;
+  put_uint16_be(&header[1], m_cluster.GetBlockLocalTimecode(block.timecode));
+  header[3] = flags;
+
+  write_ebml_element_head(out, id, calculate_block_size(block));
+  out.write(header, 4);
+  out.write(block.data->get_buffer(), block.data->get_size());
+}
+
+void
+direct_cluster_renderer_c::render_block_group(mm_io_c &out,
+                                              block_t const &block) {
+  write_ebml_element_head(out, EBML_ID(KaxBlockGroup), calculate_block_group_size(block));
+
+  // Blocks inside BlockGroups carry neither the key frame nor the
+  // discardable flag.
+  render_block(out, EBML_ID(KaxBlock), block, 0x00);
+
+  for (auto reference : { block.past_block, block.forw_block })
+    if (0 <= reference) {
+      auto value = (reference - block.timecode) / block.timecode_scale;
+      write_ebml_int_element(out, EBML_ID(KaxReferenceBlock), value, calculate_bytes_for_int(value));
+    }
+
+  if (-1 != block.duration) {
+    auto value = static_cast<uint64_t>(block.duration / block.timecode_scale);
+    write_ebml_int_element(out, EBML_ID(KaxBlockDuration), value, calculate_bytes_for_uint(value));
+  }
+}
+
+std::vector<cue_point_t>
+direct_cluster_renderer_c::render(mm_io_c &out,
+                                  KaxSegment const &segment,
+                                  bool write_crc32) {
+  auto &cluster_timecode = GetChild<KaxClusterTimecode>(m_cluster);
+  cluster_timecode.SetValue(m_cluster.GlobalTimecode() / m_cluster.GlobalTimecodeScale());
+  cluster_timecode.UpdateSize();
+
+  auto content_size = cluster_timecode.ElementSize() + (write_crc32 ? ebml_crc32_element_size : 0);
+
+  for (auto const &block : m_blocks)
+    content_size += block.block_group ? calculate_element_size(EBML_ID(KaxBlockGroup),  calculate_block_group_size(block))
+                  :                     calculate_element_size(EBML_ID(KaxSimpleBlock), calculate_block_size(block));
+
+  m_cluster.render_head(out, content_size);
+
+  // With CRC-32 elements the content is collected in memory first so
+  // that the checksum can be written in front of it.
+  auto cluster_data_start_pos = out.getFilePointer();
+  std::unique_ptr<mm_positioned_mem_io_c> crc32_content;
+
+  if (write_crc32)
+    crc32_content = std::make_unique<mm_positioned_mem_io_c>(cluster_data_start_pos + ebml_crc32_element_size, content_size);
+
+  auto &content_out = crc32_content ? static_cast<mm_io_c &>(*crc32_content) : out;
+
+  cluster_timecode.Render(content_out);
+
+  std::vector<cue_point_t> cue_points;
+  auto cluster_position = segment.GetRelativePosition(m_cluster);
+
+  for (auto const &block : m_blocks) {
+    if (block.add_cue_point)
+      cue_points.push_back({ static_cast<uint64_t>(block.timecode),
+                             block.cue_duration,
+                             cluster_position,
+                             0,
+                             static_cast<uint32_t>(block.track_num),
+                             static_cast<uint32_t>(content_out.getFilePointer() - cluster_data_start_pos) });
+
+    if (block.block_group) {
+      render_block_group(content_out, block);
+      continue;
+    }
+
+    // The flags kax_block_blob_c::add_frame_auto() sets for SimpleBlocks.
+    unsigned char flags = 0x00;
+    if ((-1 == block.past_block) && (-1 == block.forw_block))
+      flags = 0x80;             // key frame
+    else if (   ((-1 != block.forw_block) && (block.forw_block > block.timecode))
+             || ((-1 != block.past_block) && (block.past_block > block.timecode)))
+      flags = 0x01;             // discardable
+
+    render_block(content_out, EBML_ID(KaxSimpleBlock), block, flags);
+  }
+
+  if (crc32_content)
+    write_ebml_crc32_and_content(out, *crc32_content);
+
+  return cue_points;
+}
@@ -0,0 +1,64 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   rendering clusters without libmatroska's element tree
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_MERGE_DIRECT_CLUSTER_RENDERER_H
+#define MTX_MERGE_DIRECT_CLUSTER_RENDERER_H
+
+#include "common/common_pch.h"
+
+#include <matroska/KaxSegment.h>
+#include <matroska/KaxTracks.h>
+
+#include "common/mm_io.h"
+#include "merge/cues.h"
+#include "merge/libmatroska_extensions.h"
+
+// Writes a cluster whose blocks consist of a single frame each. The
+// blocks are described with the same values that
+// kax_block_blob_c::add_frame_auto() and
+// kax_block_blob_c::set_block_duration() receive in the rendering loop
+// of cluster_helper_c::render(). The cluster's timecodes must have been
+// set before rendering.
+class direct_cluster_renderer_c {
+protected:
+  struct block_t {
+    uint64_t track_num;
+    int64_t timecode, past_block, forw_block, duration, timecode_scale;
+    bool block_group, add_cue_point;
+    uint64_t cue_duration;
+    memory_cptr data;
+  };
+
+  kax_cluster_c &m_cluster;
+  std::vector<block_t> m_blocks;
+
+public:
+  direct_cluster_renderer_c(kax_cluster_c &cluster);
+
+  void add_simple_block(KaxTrackEntry const &track, int64_t timecode, memory_cptr const &data, int64_t past_block, int64_t forw_block);
+  // 'duration' is the value passed to set_block_duration(), -1 if
+  // that function isn't called.
+  void add_block_group(KaxTrackEntry const &track, int64_t timecode, memory_cptr const &data, int64_t past_block, int64_t forw_block, int64_t duration);
+  // Creates a cue point for the block added last.
+  void add_cue_point(uint64_t duration);
+
+  std::vector<cue_point_t> render(mm_io_c &out, KaxSegment const &segment, bool write_crc32);
+
+protected:
+  uint64_t calculate_block_size(block_t const &block) const;
+  uint64_t calculate_block_group_size(block_t const &block) const;
+  void render_block(mm_io_c &out, EbmlId const &id, block_t const &block, unsigned char flags);
+  void render_block_group(mm_io_c &out, block_t const &block);
+};
+
+#endif  // MTX_MERGE_DIRECT_CLUSTER_RENDERER_H
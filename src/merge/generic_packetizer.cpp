@@ -63,6 +63,7 @@ generic_packetizer_c::generic_packetizer_c(generic_reader_c *reader,
   , m_free_refs{-1}
   , m_next_free_refs{-1}
   , m_enqueued_bytes{}
+  , m_pipelined_bytes{}
   , m_safety_last_timecode{}
   , m_safety_last_duration{}
   , m_track_entry{}
@@ -167,6 +168,11 @@ generic_packetizer_c::generic_packetizer_c(generic_reader_c *reader,
   else if (mtx::includes(m_ti.m_compression_list, -1))
     m_ti.m_compression = m_ti.m_compression_list[-1];
 
+  if (mtx::includes(m_ti.m_compression_level_list, m_ti.m_id))
+    m_ti.m_compression_level = m_ti.m_compression_level_list[m_ti.m_id];
+  else if (mtx::includes(m_ti.m_compression_level_list, -1))
+    m_ti.m_compression_level = m_ti.m_compression_level_list[-1];
+
   // Let's see if the user has specified a name for this track.
   if (mtx::includes(m_ti.m_track_names, m_ti.m_id))
     m_ti.m_track_name = m_ti.m_track_names[m_ti.m_id];
@@ -763,7 +769,7 @@ generic_packetizer_c::set_headers() {
     GetChild<KaxContentEncodingType >(c_encoding).SetValue(0); // It's a compression.
     GetChild<KaxContentEncodingScope>(c_encoding).SetValue(1); // Only the frame contents have been compresed.
 
-    m_compressor = compressor_c::create(m_hcompression);
+    m_compressor = compressor_c::create(m_hcompression, m_ti.m_compression_level);
     m_compressor->set_track_headers(c_encoding);
   }
 
@@ -997,10 +1003,12 @@ generic_packetizer_c::apply_factory_short_queueing(packet_cptr_di &p_start) {
 
 struct packet_sorter_t {
   int m_index;
-  static std::deque<packet_cptr> *m_packet_queue;
+  std::deque<packet_cptr> const *m_packet_queue;
 
-  packet_sorter_t(int index)
+  packet_sorter_t(int index,
+                  std::deque<packet_cptr> const &packet_queue)
     : m_index(index)
+    , m_packet_queue(&packet_queue)
   {
   }
 
@@ -1009,12 +1017,8 @@ struct packet_sorter_t {
   }
 };
 
-std::deque<packet_cptr> *packet_sorter_t::m_packet_queue = nullptr;
-
 void
 generic_packetizer_c::apply_factory_full_queueing(packet_cptr_di &p_start) {
-  packet_sorter_t::m_packet_queue = &m_packet_queue;
-
   while (m_packet_queue.end() != p_start) {
     // Find the next I frame packet.
     packet_cptr_di p_end = p_start + 1;
@@ -1035,7 +1039,7 @@ generic_packetizer_c::apply_factory_full_queueing(packet_cptr_di &p_start) {
 
     packet_cptr_di p_current;
     for (p_current = p_start; p_current != p_end; ++i, ++p_current) {
-      sorter.push_back(packet_sorter_t(i));
+      sorter.push_back(packet_sorter_t(i, m_packet_queue));
       if (m_packet_queue[i]->timecode < previous_timecode)
         needs_sorting = true;
       previous_timecode = m_packet_queue[i]->timecode;
@@ -1088,7 +1092,7 @@ generic_packetizer_c::connect(generic_packetizer_c *src,
   m_htrack_default_duration    = src->m_htrack_default_duration;
   m_huid                       = src->m_huid;
   m_hcompression               = src->m_hcompression;
-  m_compressor                 = compressor_c::create(m_hcompression);
+  m_compressor                 = compressor_c::create(m_hcompression, src->m_ti.m_compression_level);
   m_last_cue_timecode          = src->m_last_cue_timecode;
   m_timestamp_factory          = src->m_timestamp_factory;
   m_correction_timecode_offset = 0;
@@ -16,6 +16,7 @@
 
 #include "common/common_pch.h"
 
+#include <atomic>
 #include <deque>
 
 #include "common/option_with_source.h"
@@ -51,6 +52,9 @@ protected:
   int m_next_packet_wo_assigned_timecode;
 
   int64_t m_free_refs, m_next_free_refs, m_enqueued_bytes;
+  // Bytes of packets that a reader worker thread has already taken
+  // from the queue but that the main thread hasn't muxed yet.
+  std::atomic<int64_t> m_pipelined_bytes;
   int64_t m_safety_last_timecode, m_safety_last_duration;
 
   KaxTrackEntry *m_track_entry;
@@ -106,7 +110,7 @@ public:
   virtual file_status_e read();
 
   inline void add_packet(packet_t *packet) {
-    add_packet(packet_cptr(packet));
+    add_packet(packet_t::own(packet));
   }
   virtual void add_packet(packet_cptr packet);
   virtual void add_packet2(packet_cptr pack);
@@ -122,7 +126,10 @@ public:
     return m_packet_queue.empty() ? 0x0FFFFFFF : m_packet_queue.front()->timecode;
   }
   inline int64_t get_queued_bytes() const {
-    return m_enqueued_bytes;
+    return m_enqueued_bytes + m_pipelined_bytes;
+  }
+  inline void add_pipelined_bytes(int64_t bytes) {
+    m_pipelined_bytes += bytes;
   }
 
   inline void set_free_refs(int64_t free_refs) {
@@ -135,7 +142,7 @@ public:
   virtual void set_headers();
   virtual void fix_headers();
   inline int process(packet_t *packet) {
-    return process(packet_cptr(packet));
+    return process(packet_t::own(packet));
   }
   virtual int process(packet_cptr packet) = 0;
 
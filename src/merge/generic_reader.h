@@ -86,6 +86,7 @@ public:
   virtual file_status_e read(generic_packetizer_c *ptzr, bool force = false) = 0;
   virtual void read_all();
   virtual int get_progress();
+  virtual timestamp_c get_duration() const;
   virtual void set_headers();
   virtual void set_headers_for_track(int64_t tid);
   virtual void identify() = 0;
@@ -123,6 +124,7 @@ public:
   virtual attach_mode_e attachment_requested(int64_t id);
 
   virtual void display_identification_results();
+  virtual nlohmann::json get_identification_results_as_json();
 
 protected:
   virtual bool demuxing_requested(char type, int64_t id, std::string const &language = "");
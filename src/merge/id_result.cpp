@@ -15,6 +15,11 @@
 #include "merge/id_result.h"
 #include "merge/output_control.h"
 
+// Set while a thread identifies a file in batch identification
+// mode. The result for an unsupported container is stored here instead
+// of being output followed by exiting the program.
+static thread_local nlohmann::json *s_captured_unsupported_container = nullptr;
+
 static void
 output_container_unsupported_text(std::string const &filename,
                                   translatable_string_c const &info) {
@@ -29,10 +34,10 @@ output_container_unsupported_text(std::string const &filename,
     mxerror(boost::format(Y("The file '%1%' is a non-supported file type (%2%).\n")) % filename % info);
 }
 
-static void
-output_container_unsupported_json(std::string const &filename,
-                                  translatable_string_c const &info) {
-  auto json = nlohmann::json{
+static nlohmann::json
+container_unsupported_json(std::string const &filename,
+                           translatable_string_c const &info) {
+  return nlohmann::json{
     { "identification_format_version", ID_JSON_FORMAT_VERSION },
     { "file_name",                     filename               },
     { "container", {
@@ -41,8 +46,12 @@ output_container_unsupported_json(std::string const &filename,
         { "type",       info.get_translated() },
       } },
   };
+}
 
-  display_json_output(json);
+static void
+output_container_unsupported_json(std::string const &filename,
+                                  translatable_string_c const &info) {
+  display_json_output(container_unsupported_json(filename, info));
 
   mxexit(0);
 }
@@ -50,8 +59,19 @@ output_container_unsupported_json(std::string const &filename,
 void
 id_result_container_unsupported(std::string const &filename,
                                 translatable_string_c const &info) {
-  if (identification_output_format_e::json == g_identification_output_format)
+  if (s_captured_unsupported_container) {
+    // Only the first report counts; the callers continue after this
+    // function returns.
+    if (s_captured_unsupported_container->is_null())
+      *s_captured_unsupported_container = container_unsupported_json(filename, info);
+
+  } else if (identification_output_format_e::json == g_identification_output_format)
     output_container_unsupported_json(filename, info);
   else
     output_container_unsupported_text(filename, info);
 }
+
+void
+id_result_capture_unsupported_container(nlohmann::json *json) {
+  s_captured_unsupported_container = json;
+}
@@ -63,5 +63,6 @@ struct id_result_t {
 };
 
 void id_result_container_unsupported(std::string const &filename, translatable_string_c const &info);
+void id_result_capture_unsupported_container(nlohmann::json *json);
 
 #endif  // MTX_MERGE_ID_RESULT_H
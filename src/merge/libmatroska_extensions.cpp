@@ -156,3 +156,20 @@ kax_cluster_c::delete_non_blocks() {
 
   RemoveAll();
 }
+
+filepos_t
+kax_cluster_c::render_head(IOCallback &output,
+                           uint64_t content_size) {
+  m_forced_content_size = content_size;
+  return RenderHead(output, false);
+}
+
+filepos_t
+kax_cluster_c::UpdateSize(bool bWithDefault,
+                          bool bForceRender) {
+  if (0 > m_forced_content_size)
+    return KaxCluster::UpdateSize(bWithDefault, bForceRender);
+
+  SetSize_(m_forced_content_size);
+  return m_forced_content_size;
+}
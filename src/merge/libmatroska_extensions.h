@@ -27,13 +27,24 @@ using namespace libebml;
 using namespace libmatroska;
 
 class kax_cluster_c: public KaxCluster {
+protected:
+  int64_t m_forced_content_size;
+
 public:
-  kax_cluster_c(): KaxCluster() {
+  kax_cluster_c()
+    : KaxCluster()
+    , m_forced_content_size{-1}
+  {
     PreviousTimecode = 0;
   }
 
   void delete_non_blocks();
 
+  // Writes only the cluster's head for a content size calculated by
+  // the caller who writes the content directly afterwards.
+  filepos_t render_head(IOCallback &output, uint64_t content_size);
+  virtual filepos_t UpdateSize(bool bWithDefault = false, bool bForceRender = false);
+
   void set_min_timecode(int64_t min_timecode) {
     MinTimecode = min_timecode;
   }
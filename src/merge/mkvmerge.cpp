@@ -28,9 +28,13 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <iostream>
 #include <list>
+#include <mutex>
 #include <sstream>
+#include <thread>
 #include <tuple>
 #include <typeinfo>
 
@@ -40,6 +44,7 @@
 #include <matroska/KaxTag.h>
 #include <matroska/KaxTags.h>
 
+#include "common/at_scope_exit.h"
 #include "common/chapters/chapters.h"
 #include "common/command_line.h"
 #include "common/ebml.h"
@@ -47,6 +52,7 @@
 #include "common/file_types.h"
 #include "common/fs_sys_helpers.h"
 #include "common/iso639.h"
+#include "common/json.h"
 #include "common/kax_analyzer.h"
 #include "common/list_utils.h"
 #include "common/mm_io.h"
@@ -117,12 +123,23 @@ set_usage() {
                   "                           put at most n milliseconds of data into each\n"
                   "                           cluster.\n");
   usage_text += Y("  --no-cues                Do not write the cue data (the index).\n");
+  usage_text += Y("  --cues-before-clusters   Write the cue data in front of the first cluster\n"
+                  "                           so that players can seek without reading the\n"
+                  "                           end of the file first.\n");
   usage_text += Y("  --clusters-in-meta-seek  Write meta seek data for clusters.\n");
+  usage_text += Y("  --crc32-elements         Add CRC-32 elements to the clusters, the segment\n"
+                  "                           info, the track headers, the cues and the tags.\n");
   usage_text += Y("  --disable-lacing         Do not use lacing.\n");
   usage_text += Y("  --enable-durations       Enable block durations for all blocks.\n");
   usage_text += Y("  --timecode-scale <n>     Force the timecode scale factor to n.\n");
   usage_text += Y("  --disable-track-statistics-tags\n"
                   "                           Do not write tags with track statistics.\n");
+  usage_text += Y("  --threaded-readers       Run each source file's reader and packetizers\n"
+                  "                           in a thread of its own.\n");
+  usage_text += Y("  --memory-mapped-input    Read source files via memory mappings.\n");
+  usage_text += Y("  --no-memory-mapped-input Don't use memory mappings, not even for\n"
+                  "                           identification.\n");
+  usage_text += Y("  --write-behind           Write the output file in a thread of its own.\n");
   usage_text +=   "\n";
   usage_text += Y(" File splitting, linking, appending and concatenating (more global options):\n");
   usage_text += Y("  --split <d[K,M,G]|HH:MM:SS|s>\n"
@@ -268,15 +285,22 @@ set_usage() {
                   "                           read as for the conversion to UTF-8.\n");
   usage_text +=   "\n";
   usage_text += Y(" Options that only apply to VobSub subtitle tracks:\n");
-  usage_text += Y("  --compression <TID:method>\n"
+  usage_text += Y("  --compression <TID:method[:level]>\n"
                   "                           Sets the compression method used for the\n"
-                  "                           specified track ('none' or 'zlib').\n");
+                  "                           specified track ('none' or 'zlib'). For 'zlib'\n"
+                  "                           the level (0-9, default 9) can be given, too.\n");
   usage_text +=   "\n\n";
   usage_text += Y(" Other options:\n");
   usage_text += Y("  -i, --identify <file>    Print information about the source file.\n");
   usage_text += Y("  -F, --identification-format <format>\n"
                   "                           Set the identification results format\n"
                   "                           ('text', 'verbose-text', 'json').\n");
+  usage_text += Y("  --identification-file-list <file>\n"
+                  "                           Identify all files listed in this file (one\n"
+                  "                           name per line; JSON format only).\n");
+  usage_text += Y("  --identification-threads <n>\n"
+                  "                           Number of threads used for identifying\n"
+                  "                           several files at once.\n");
   usage_text += Y("  -l, --list-types         Lists supported input file types.\n");
   usage_text += Y("  --list-languages         Lists all ISO639 languages and their\n"
                   "                           ISO639-2 codes.\n");
@@ -372,9 +396,9 @@ list_file_types() {
     mxinfo(boost::format("  %1% [%2%]\n") % file_type.title % file_type.extensions);
 }
 
-static void
-display_unsupported_file_type_json(filelist_t const &file) {
-  auto json = nlohmann::json{
+static nlohmann::json
+unsupported_file_type_json(filelist_t const &file) {
+  return nlohmann::json{
     { "identification_format_version", ID_JSON_FORMAT_VERSION },
     { "file_name",                     file.name              },
     { "container", {
@@ -382,8 +406,11 @@ display_unsupported_file_type_json(filelist_t const &file) {
         { "supported",  false },
       } },
   };
+}
 
-  display_json_output(json);
+static void
+display_unsupported_file_type_json(filelist_t const &file) {
+  display_json_output(unsupported_file_type_json(file));
 
   mxexit(0);
 }
@@ -398,6 +425,21 @@ display_unsupported_file_type(filelist_t const &file) {
           % file.name);
 }
 
+static void
+setup_file_for_identification(filelist_t &file,
+                              std::string file_name) {
+  file.ti = std::make_unique<track_info_c>();
+
+  if ('=' == file_name[0]) {
+    file.ti->m_disable_multi_file = true;
+    file_name                     = file_name.substr(1);
+  }
+
+  file.ti->m_fname = file_name;
+  file.name        = file_name;
+  file.all_names.push_back(file_name);
+}
+
 /** \brief Identify a file type and its contents
 
    This function called for \c --identify. It sets up dummy track info
@@ -405,22 +447,15 @@ display_unsupported_file_type(filelist_t const &file) {
    and calls its identify function.
 */
 static void
-identify(std::string &filename) {
+identify(std::string const &filename) {
   g_files.emplace_back(new filelist_t);
   auto &file = *g_files.back();
-  file.ti    = std::make_unique<track_info_c>();
-
-  if ('=' == filename[0]) {
-    file.ti->m_disable_multi_file = true;
-    filename                      = filename.substr(1);
-  }
 
   verbose             = 0;
   g_suppress_warnings = true;
   g_identifying       = true;
-  file.ti->m_fname    = filename;
-  file.name           = filename;
-  file.all_names.push_back(filename);
+
+  setup_file_for_identification(file, filename);
 
   get_file_type(file);
 
@@ -435,6 +470,172 @@ identify(std::string &filename) {
   g_files.clear();
 }
 
+struct batch_identification_t {
+  nlohmann::json json;
+  std::vector<std::string> warnings, errors;
+};
+
+class batch_identification_error_x: public mtx::exception {
+public:
+  virtual const char *what() const throw() {
+    return "identification failed";
+  }
+};
+
+static thread_local batch_identification_t *s_batch_identification = nullptr;
+
+// Collects the warnings and errors for the file the calling thread
+// identifies. Errors abort that file's identification only.
+static void
+batch_identification_warning_error_handler(unsigned int level,
+                                           std::string const &message) {
+  if (!s_batch_identification) {
+    mxmsg(level, message);
+    if (MXMSG_ERROR == level)
+      mxexit(2);
+    return;
+  }
+
+  if (MXMSG_WARNING == level) {
+    s_batch_identification->warnings.push_back(message);
+    return;
+  }
+
+  s_batch_identification->errors.push_back(message);
+
+  throw batch_identification_error_x{};
+}
+
+static nlohmann::json
+identify_for_batch(std::string const &file_name) {
+  auto result = batch_identification_t{};
+
+  s_batch_identification = &result;
+  id_result_capture_unsupported_container(&result.json);
+
+  at_scope_exit_c reset_capturing{[]() {
+    s_batch_identification = nullptr;
+    id_result_capture_unsupported_container(nullptr);
+  }};
+
+  // Probers catch all exceptions. Therefore errors and unsupported
+  // containers must be checked for after each step.
+  auto done = [&result]() { return !result.json.is_null() || !result.errors.empty(); };
+
+  try {
+    auto file = filelist_t{};
+
+    setup_file_for_identification(file, file_name);
+
+    get_file_type(file);
+
+    if (!done() && (FILE_TYPE_IS_UNKNOWN == file.type))
+      result.json = unsupported_file_type_json(file);
+
+    if (!done())
+      create_reader(file);
+
+    if (!done())
+      file.reader->identify();
+
+    if (!done())
+      result.json = file.reader->get_identification_results_as_json();
+
+  } catch (batch_identification_error_x &) {
+  } catch (mtx::exception &ex) {
+    result.errors.push_back(ex.error());
+  } catch (std::exception &ex) {
+    result.errors.push_back(ex.what());
+  }
+
+  if (result.json.is_null())
+    result.json = nlohmann::json{
+      { "identification_format_version", ID_JSON_FORMAT_VERSION },
+      { "file_name",                     file_name              },
+    };
+
+  result.json["warnings"] = result.warnings;
+  result.json["errors"]   = result.errors;
+
+  return std::move(result.json);
+}
+
+/** \brief Identify several files in one process
+
+   The files are identified by \c num_threads worker threads. One
+   JSON document per file is output on a line of its own in the order
+   the files were given in.
+*/
+static void
+identify_in_batch(std::vector<std::string> const &file_names,
+                  unsigned int num_threads) {
+  verbose             = 0;
+  g_suppress_warnings = true;
+  g_identifying       = true;
+
+  set_mxmsg_handler(MXMSG_WARNING, batch_identification_warning_error_handler);
+  set_mxmsg_handler(MXMSG_ERROR,   batch_identification_warning_error_handler);
+
+  // mtx::json::dump() switches the numeric locale for each call which
+  // must not happen while other threads are running.
+  auto old_locale = std::string{::setlocale(LC_NUMERIC, "C")};
+  at_scope_exit_c restore_locale{ [&]() { ::setlocale(LC_NUMERIC, old_locale.c_str()); } };
+
+  auto results  = std::vector<nlohmann::json>(file_names.size());
+  auto finished = std::vector<bool>(file_names.size(), false);
+  std::atomic<size_t> next_idx{0};
+  std::mutex mutex;
+  std::condition_variable cond;
+
+  auto worker = [&]() {
+    size_t idx;
+
+    while ((idx = next_idx++) < file_names.size()) {
+      auto json = identify_for_batch(file_names[idx]);
+
+      std::lock_guard<std::mutex> lock{mutex};
+      results[idx]  = std::move(json);
+      finished[idx] = true;
+      cond.notify_all();
+    }
+  };
+
+  auto workers = std::vector<std::thread>{};
+  for (auto idx = 0u, num_workers = std::min<unsigned int>(num_threads, file_names.size()); idx < num_workers; ++idx)
+    workers.emplace_back(worker);
+
+  for (auto idx = 0u; idx < file_names.size(); ++idx) {
+    auto json = nlohmann::json{};
+
+    {
+      std::unique_lock<std::mutex> lock{mutex};
+      cond.wait(lock, [&finished, idx]() { return finished[idx]; });
+      json = std::move(results[idx]);
+    }
+
+    mxinfo(boost::format("%1%\n") % json.dump());
+  }
+
+  for (auto &thread : workers)
+    thread.join();
+}
+
+static void
+read_identification_file_list(std::string const &list_file_name,
+                              std::vector<std::string> &file_names) {
+  try {
+    mm_text_io_c in(new mm_file_io_c(list_file_name));
+    auto line = std::string{};
+
+    while (in.getline2(line))
+      if (!line.empty())
+        file_names.push_back(line);
+
+  } catch (mtx::mm_io::exception &ex) {
+    mxerror(boost::format(Y("The file '%1%' could not be opened for reading: %2%.\n")) % list_file_name % ex);
+  }
+}
+
 /** \brief Parse tags and add them to the list of all tags
 
    Also tests the tags for missing mandatory elements.
@@ -1031,6 +1232,7 @@ parse_arg_cues(const std::string &s,
 /** \brief Parse the \c --compression argument
 
    The argument must have the form \c TID:compression, e.g. \c 0:zlib.
+   For zlib the compression level can be appended, e.g. \c 0:zlib:6.
 */
 static void
 parse_arg_compression(const std::string &s,
@@ -1055,8 +1257,16 @@ parse_arg_compression(const std::string &s,
   available_compression_methods.push_back("analyze_header_removal");
 
   ti.m_compression_list[id] = COMPRESSION_UNSPECIFIED;
+  ti.m_compression_level_list.erase(id);
   balg::to_lower(parts[1]);
 
+  auto level     = std::string{};
+  auto level_pos = parts[1].find(':');
+  if (std::string::npos != level_pos) {
+    level = parts[1].substr(level_pos + 1);
+    parts[1].erase(level_pos);
+  }
+
   if (parts[1] == "zlib")
     ti.m_compression_list[id] = COMPRESSION_ZLIB;
 
@@ -1071,6 +1281,15 @@ parse_arg_compression(const std::string &s,
 
   if (ti.m_compression_list[id] == COMPRESSION_UNSPECIFIED)
     mxerror(boost::format(Y("'%1%' is an unsupported argument for --compression. Available compression methods are: %2%\n")) % s % boost::join(available_compression_methods, ", "));
+
+  if (level.empty())
+    return;
+
+  auto level_num = 0;
+  if ((COMPRESSION_ZLIB != ti.m_compression_list[id]) || !parse_number(level, level_num) || (0 > level_num) || (9 < level_num))
+    mxerror(boost::format(Y("Invalid compression level in '--compression %1%'. A level between 0 and 9 can only be given for 'zlib'.\n")) % s);
+
+  ti.m_compression_level_list[id] = level_num;
 }
 
 /** \brief Parse the argument for a couple of options
@@ -1820,7 +2039,9 @@ parse_arg_identification_format(std::vector<std::string>::const_iterator &sit,
 static void
 handle_identification_args(std::vector<std::string> const &args) {
   auto identification_command = boost::optional<std::string>{};
-  auto file_to_identify       = boost::optional<std::string>{};
+  auto files_to_identify      = std::vector<std::string>{};
+  auto file_list_given        = false;
+  auto num_threads            = std::max(std::thread::hardware_concurrency(), 1u);
 
   for (auto const &this_arg : args) {
     if (!mtx::included_in(this_arg, "-i", "--identify", "-I", "--identify-verbose", "--identify-for-mmg", "--identify-for-gui", "-J"))
@@ -1845,6 +2066,7 @@ handle_identification_args(std::vector<std::string> const &args) {
 
   for (auto sit = args.cbegin(), sit_end = args.cend(); sit != sit_end; sit++) {
     auto const &this_arg = *sit;
+    auto next_arg        = sit + 1;
 
     if (mtx::included_in(this_arg, "-i", "--identify", "-I", "--identify-verbose", "--identify-for-mmg", "--identify-for-gui", "-J"))
       continue;
@@ -1852,17 +2074,47 @@ handle_identification_args(std::vector<std::string> const &args) {
     if (mtx::included_in(this_arg, "-F", "--identification-format"))
       parse_arg_identification_format(sit, sit_end);
 
-    else if (file_to_identify)
+    else if (this_arg == "--memory-mapped-input")
+      g_memory_mapped_input = memory_mapped_input_e::always;
+
+    else if (this_arg == "--no-memory-mapped-input")
+      g_memory_mapped_input = memory_mapped_input_e::never;
+
+    else if (this_arg == "--identification-file-list") {
+      if (next_arg == sit_end)
+        mxerror(boost::format(Y("'%1%' lacks its argument.\n")) % this_arg);
+
+      read_identification_file_list(*next_arg, files_to_identify);
+      file_list_given = true;
+      ++sit;
+
+    } else if (this_arg == "--identification-threads") {
+      if (next_arg == sit_end)
+        mxerror(boost::format(Y("'%1%' lacks its argument.\n")) % this_arg);
+
+      if (!parse_number(*next_arg, num_threads) || !num_threads)
+        mxerror(boost::format(Y("Invalid number of threads in '%1% %2%'.\n")) % this_arg % *next_arg);
+      ++sit;
+
+    } else if (!files_to_identify.empty() && (identification_output_format_e::json != g_identification_output_format))
       mxerror(boost::format(Y("The argument '%1%' is not allowed in identification mode.\n")) % this_arg);
 
     else
-      file_to_identify = this_arg;
+      files_to_identify.push_back(this_arg);
   }
 
-  if (!file_to_identify)
+  if (files_to_identify.empty() && !file_list_given)
     mxerror(boost::format(Y("'%1%' lacks its argument.\n")) % *identification_command);
 
-  identify(*file_to_identify);
+  if ((1 == files_to_identify.size()) && !file_list_given)
+    identify(files_to_identify[0]);
+
+  else if (identification_output_format_e::json == g_identification_output_format)
+    identify_in_batch(files_to_identify, num_threads);
+
+  else
+    mxerror(Y("Several files can only be identified at once with the JSON identification format.\n"));
+
   mxexit();
 }
 
@@ -2027,6 +2279,12 @@ parse_args(std::vector<std::string> args) {
     else if (this_arg == "--clusters-in-meta-seek")
       g_write_meta_seek_for_clusters = true;
 
+    else if (this_arg == "--crc32-elements")
+      g_write_crc32_elements = true;
+
+    else if (this_arg == "--cues-before-clusters")
+      g_write_cues_before_clusters = true;
+
     else if (this_arg == "--disable-lacing")
       g_no_lacing = true;
 
@@ -2036,6 +2294,18 @@ parse_args(std::vector<std::string> args) {
     else if (this_arg == "--disable-track-statistics-tags")
       g_no_track_statistics_tags = true;
 
+    else if (this_arg == "--threaded-readers")
+      g_threaded_readers = true;
+
+    else if (this_arg == "--memory-mapped-input")
+      g_memory_mapped_input = memory_mapped_input_e::always;
+
+    else if (this_arg == "--no-memory-mapped-input")
+      g_memory_mapped_input = memory_mapped_input_e::never;
+
+    else if (this_arg == "--write-behind")
+      g_write_behind = true;
+
     else if (this_arg == "--attachment-description") {
       if (no_next_arg)
         mxerror(Y("'--attachment-description' lacks the description.\n"));
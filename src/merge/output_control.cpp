@@ -15,9 +15,12 @@
 
 #include "common/common_pch.h"
 
+#include <atomic>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <cmath>
 #include <iostream>
+#include <queue>
+#include <set>
 #include <typeinfo>
 
 #include <ebml/EbmlHead.h>
@@ -46,6 +49,7 @@
 #include <matroska/KaxTrackVideo.h>
 #include <matroska/KaxVersion.h>
 
+#include "common/at_scope_exit.h"
 #include "common/chapters/chapters.h"
 #include "common/command_line.h"
 #include "common/construct.h"
@@ -55,6 +59,7 @@
 #include "common/ebml.h"
 #include "common/fs_sys_helpers.h"
 #include "common/hacks.h"
+#include "common/mm_write_behind_io.h"
 #include "common/mm_write_buffer_io.h"
 #include "common/strings/formatting.h"
 #include "common/tags/tags.h"
@@ -67,6 +72,7 @@
 #include "merge/generic_packetizer.h"
 #include "merge/generic_reader.h"
 #include "merge/output_control.h"
+#include "merge/reader_worker.h"
 #include "merge/webm.h"
 
 using namespace libmatroska;
@@ -104,7 +110,11 @@ bool g_write_cues                           = true;
 bool g_cue_writing_requested                = false;
 generic_packetizer_c *g_video_packetizer    = nullptr;
 bool g_write_meta_seek_for_clusters         = false;
+bool g_write_crc32_elements                 = false;
+bool g_write_cues_before_clusters           = false;
 bool g_no_lacing                            = false;
+bool g_threaded_readers                     = false;
+bool g_write_behind                         = false;
 bool g_no_linking                           = true;
 bool g_use_durations                        = false;
 bool g_no_track_statistics_tags             = false;
@@ -119,6 +129,8 @@ int g_default_tracks_priority[3]            = { 0, 0, 0, };
 bool g_identifying                                            = false;
 identification_output_format_e g_identification_output_format = identification_output_format_e::text;
 
+memory_mapped_input_e g_memory_mapped_input                   = memory_mapped_input_e::identification_only;
+
 std::unique_ptr<KaxSegment> g_kax_segment;
 std::unique_ptr<KaxTracks> g_kax_tracks;
 KaxTrackEntry *g_kax_last_entry             = nullptr;
@@ -150,6 +162,7 @@ append_mode_e g_append_mode                 = APPEND_MODE_FILE_BASED;
 bool s_appending_files                      = false;
 auto s_debug_appending                      = debugging_option_c{"append|appending"};
 auto s_debug_rerender_track_headers         = debugging_option_c{"rerender|rerender_track_headers"};
+auto s_debug_cues_before_clusters           = debugging_option_c{"cues_before_clusters"};
 
 std::string g_default_language              = "und";
 
@@ -169,6 +182,7 @@ static std::unique_ptr<EbmlVoid> s_kax_sh_void;
 static std::unique_ptr<EbmlVoid> s_kax_chapters_void;
 static int64_t s_max_chapter_size           = 0;
 static std::unique_ptr<EbmlVoid> s_void_after_track_headers;
+static std::unique_ptr<EbmlVoid> s_kax_cues_void;
 
 static std::vector<std::tuple<timestamp_c, std::string, std::string>> s_additional_chapter_atoms;
 
@@ -180,6 +194,43 @@ static int s_display_files_done           = 0;
 static int s_display_path_length          = 1;
 static generic_reader_c *s_display_reader = nullptr;
 
+static std::vector<reader_worker_cptr> s_reader_workers;
+static std::atomic<bool> s_track_headers_rerender_requested{false};
+
+// The packetizers that have a packet are kept in a priority queue
+// ordered by the packets' timecodes. Ties are broken by the
+// packetizer's index so that the order is the same as with a linear
+// scan over all packetizers.
+struct interleaver_entry_t {
+  timestamp_c timestamp;
+  size_t ptzr_idx;
+};
+
+struct interleaver_entry_later_t {
+  bool
+  operator ()(interleaver_entry_t const &a,
+              interleaver_entry_t const &b)
+    const {
+    return (b.timestamp <  a.timestamp)
+        || ((a.timestamp == b.timestamp) && (a.ptzr_idx > b.ptzr_idx));
+  }
+};
+
+struct interleaver_stats_t {
+  int64_t num_packets{}, num_polls{}, num_queue_operations{};
+};
+
+static std::priority_queue<interleaver_entry_t, std::vector<interleaver_entry_t>, interleaver_entry_later_t> s_interleaver_queue;
+static std::set<size_t> s_packetizers_to_poll;
+static interleaver_stats_t s_interleaver_stats;
+static debugging_option_c s_debug_interleaver{"interleaver"};
+
+static void
+mark_all_packetizers_for_polling() {
+  for (auto idx = 0u; idx < g_packetizers.size(); ++idx)
+    s_packetizers_to_poll.insert(idx);
+}
+
 static std::unique_ptr<EbmlHead> s_head;
 
 static std::string s_muxing_app, s_writing_app;
@@ -213,6 +264,20 @@ calculate_file_duration() {
   return std::llround(static_cast<double>(g_cluster_helper->get_duration()) / static_cast<double>(g_timecode_scale));
 }
 
+// Renders a level 1 element with a CRC-32 element as its first child if
+// the user has requested them. Elements that are modified in place
+// later on must be rendered through this function again so that their
+// checksum stays valid.
+static void
+render_level1_element(EbmlMaster &master,
+                      mm_io_c &out,
+                      bool save_default = false) {
+  if (g_write_crc32_elements)
+    render_ebml_master_with_crc32(out, master, [&master, save_default](IOCallback &buffer) { master.Render(buffer, save_default); });
+  else
+    master.Render(out, save_default);
+}
+
 /** \brief Fix the file after mkvmerge has been interrupted
 
    On Unix like systems mkvmerge will install a signal handler. On \c SIGUSR1
@@ -246,6 +311,12 @@ sighandler(int /* signum */) {
   s_kax_duration->SetValue(calculate_file_duration());
   s_kax_duration->Render(*s_out);
   s_out->restore_pos();
+
+  if (g_write_crc32_elements) {
+    s_out->save_pos(s_kax_infos->GetElementPosition());
+    render_level1_element(*s_kax_infos, *s_out, true);
+    s_out->restore_pos();
+  }
   mxinfo(Y(" done\n"));
 
   mxinfo(Y("The file is being fixed, part 3/4..."));
@@ -289,6 +360,12 @@ determine_display_reader() {
   return winner->reader.get();
 }
 
+static reader_worker_c &
+reader_worker_for(generic_reader_c const &reader) {
+  auto file = brng::find_if(g_files, [&reader](filelist_cptr const &f) { return f->reader.get() == &reader; });
+  return *s_reader_workers.at(std::distance(g_files.begin(), file));
+}
+
 /** \brief Selects a reader for displaying its progress information
 */
 static void
@@ -312,7 +389,8 @@ display_progress(bool is_100percent = false) {
     s_display_reader = determine_display_reader();
 
   bool display_progress  = false;
-  int current_percentage = (s_display_reader->get_progress() + s_display_files_done * 100) / s_display_path_length;
+  int reader_progress    = s_reader_workers.empty() ? s_display_reader->get_progress() : reader_worker_for(*s_display_reader).get_progress();
+  int current_percentage = (reader_progress + s_display_files_done * 100) / s_display_path_length;
   int64_t current_time   = mtx::sys::get_current_time_millis();
 
   if (   (-1 == s_previous_percentage)
@@ -661,7 +739,7 @@ render_headers(mm_io_c *out) {
     } else
       set_timecode_scale();
 
-    s_kax_infos->Render(*out, true);
+    render_level1_element(*s_kax_infos, *out, true);
     g_kax_sh_main->IndexThis(*s_kax_infos, *g_kax_segment);
 
     if (!g_packetizers.empty()) {
@@ -669,7 +747,7 @@ render_headers(mm_io_c *out) {
       uint64_t full_header_size = g_kax_tracks->ElementSize(true);
       g_kax_tracks->UpdateSize(false);
 
-      g_kax_tracks->Render(*out, false);
+      render_level1_element(*g_kax_tracks, *out);
       g_kax_sh_main->IndexThis(*g_kax_tracks, *g_kax_segment);
 
       // Reserve some small amount of space for header changes by the
@@ -765,40 +843,48 @@ relocate_written_data(uint64_t data_start_pos,
     relocated += to_copy;
   }
 
-  if (s_kax_as) {
+  if (s_kax_as && (s_kax_as->GetElementPosition() >= data_start_pos)) {
     mxdebug_if(s_debug_rerender_track_headers, boost::format("[rerender]  re-writing attachments; old position %1% new %2%\n") % s_kax_as->GetElementPosition() % (s_kax_as->GetElementPosition() + delta));
     s_out->setFilePointer(s_kax_as->GetElementPosition() + delta);
     s_kax_as->Render(*s_out);
   }
 
-  if (s_kax_chapters_void) {
+  if (s_kax_chapters_void && (s_kax_chapters_void->GetElementPosition() >= data_start_pos)) {
     mxdebug_if(s_debug_rerender_track_headers, boost::format("[rerender]  re-writing chapter placeholder; old position %1% new %2%\n") % s_kax_chapters_void->GetElementPosition() % (s_kax_chapters_void->GetElementPosition() + delta));
     s_out->setFilePointer(s_kax_chapters_void->GetElementPosition() + delta);
     s_kax_chapters_void->Render(*s_out);
   }
 
+  if (s_kax_cues_void && (s_kax_cues_void->GetElementPosition() >= data_start_pos)) {
+    mxdebug_if(s_debug_rerender_track_headers, boost::format("[rerender]  re-writing cues placeholder; old position %1% new %2%\n") % s_kax_cues_void->GetElementPosition() % (s_kax_cues_void->GetElementPosition() + delta));
+    s_out->setFilePointer(s_kax_cues_void->GetElementPosition() + delta);
+    s_kax_cues_void->Render(*s_out);
+  }
+
   s_out->setFilePointer(rel_pos_from_end, seek_end);
 
   adjust_cue_and_seekhead_positions(data_start_pos, delta);
 }
 
-static void
+static std::unique_ptr<EbmlVoid>
 render_void(int64_t new_size) {
-  auto actual_size = new_size;
+  auto actual_size  = new_size;
+  auto void_element = std::make_unique<EbmlVoid>();
 
-  s_void_after_track_headers = std::make_unique<EbmlVoid>();
-  s_void_after_track_headers->SetSize(new_size);
-  s_void_after_track_headers->UpdateSize();
+  void_element->SetSize(new_size);
+  void_element->UpdateSize();
 
-  while (static_cast<int64_t>(s_void_after_track_headers->ElementSize()) > new_size)
-    s_void_after_track_headers->SetSize(--actual_size);
+  while (static_cast<int64_t>(void_element->ElementSize()) > new_size)
+    void_element->SetSize(--actual_size);
 
-  if (static_cast<int64_t>(s_void_after_track_headers->ElementSize()) < new_size)
-    s_void_after_track_headers->SetSizeLength(new_size - actual_size - 1);
+  if (static_cast<int64_t>(void_element->ElementSize()) < new_size)
+    void_element->SetSizeLength(new_size - actual_size - 1);
 
   mxdebug_if(s_debug_rerender_track_headers, boost::format("[rerender] render_void new_size %1% actual_size %2% size_length %3%\n") % new_size % actual_size % (new_size - actual_size - 1));
 
-  s_void_after_track_headers->Render(*s_out);
+  void_element->Render(*s_out);
+
+  return void_element;
 }
 
 static void
@@ -808,8 +894,8 @@ shrink_void_and_rerender_track_headers(int64_t new_void_size) {
 
   s_out->setFilePointer(g_kax_tracks->GetElementPosition());
 
-  g_kax_tracks->Render(*s_out, false);
-  render_void(new_void_size);
+  render_level1_element(*g_kax_tracks, *s_out);
+  s_void_after_track_headers = render_void(new_void_size);
 
   s_out->setFilePointer(0, seek_end);
 
@@ -833,6 +919,16 @@ shrink_void_and_rerender_track_headers(int64_t new_void_size) {
 */
 void
 rerender_track_headers() {
+  // Packetizers running on a reader worker thread must not write to
+  // the output file. The main thread will take care of it before it
+  // muxes the next packet.
+  if (reader_worker_c::is_worker_thread()) {
+    s_track_headers_rerender_requested = true;
+    return;
+  }
+
+  s_track_headers_rerender_requested = false;
+
   g_kax_tracks->UpdateSize(false);
 
   auto position_before    = s_out->getFilePointer();
@@ -1296,6 +1392,75 @@ render_chapter_void_placeholder() {
   s_kax_chapters_void->Render(*s_out);
 }
 
+/** \brief Estimate the size of the cues for the whole output
+
+    The number of cue points is estimated from the longest input
+    file's duration and each track's cue creation strategy. If no
+    reader knows its duration then one cue point per MB of input data
+    is assumed.
+ */
+static uint64_t
+estimate_cues_size() {
+  auto duration = timestamp_c{};
+
+  for (auto const &file : g_files) {
+    auto file_duration = file->reader->get_duration();
+    if (!file_duration.valid())
+      continue;
+
+    if (file->appending && duration.valid())
+      duration += file_duration;
+    else if (!duration.valid() || (file_duration > duration))
+      duration = file_duration;
+  }
+
+  if (!duration.valid())
+    return cues_c::estimate_element_size(g_file_sizes / (1024 * 1024) + 1, 0, g_file_sizes);
+
+  // The number of cue points per ten seconds assumes a key frame
+  // every second for video tracks, ~40 frames per second for audio
+  // tracks and one entry every two seconds for everything else.
+  auto num_points = 0ull;
+  for (auto const &ptzr : g_packetizers) {
+    if (!ptzr.packetizer)
+      continue;
+
+    auto strategy   = ptzr.packetizer->get_cue_creation();
+    auto track_type = ptzr.packetizer->get_track_type();
+
+    if (CUE_STRATEGY_ALL == strategy)
+      num_points += 250;
+
+    else if (CUE_STRATEGY_IFRAMES == strategy)
+      num_points += track_video == track_type ? 10 : track_audio == track_type ? 400 : 5;
+
+    else if ((CUE_STRATEGY_SPARSE == strategy) && (track_audio == track_type) && !g_video_packetizer)
+      num_points += 5;
+  }
+
+  num_points = num_points * duration.to_s() / 10 + 1;
+
+  return cues_c::estimate_element_size(num_points, duration.to_ns(), g_file_sizes);
+}
+
+/** \brief Render an EbmlVoid element as a placeholder for the cues
+
+    With \c --cues-before-clusters the cues are written in front of
+    the first cluster so that players can seek without having to read
+    the end of the file first. Space for them is reserved here and
+    filled in \c finish_file().
+ */
+static void
+render_cues_void_placeholder() {
+  if (!g_write_cues || !g_write_cues_before_clusters || g_packetizers.empty())
+    return;
+
+  auto size       = std::max<uint64_t>(estimate_cues_size(), 1024);
+  s_kax_cues_void = render_void(size);
+
+  mxdebug_if(s_debug_cues_before_clusters, boost::format("cues_before_clusters: reserved %1% bytes at %2%\n") % size % s_kax_cues_void->GetElementPosition());
+}
+
 /** \brief Prepare tag elements for rendering
 
     Adds missing mandatory elements to the tag structures and sorts
@@ -1338,7 +1503,9 @@ create_next_output_file() {
 
   // Open the output file.
   try {
-    s_out = !g_cluster_helper->discarding() ? mm_write_buffer_io_c::open(this_outfile, 20 * 1024 * 1024) : mm_io_cptr{ new mm_null_io_c{this_outfile} };
+    s_out = g_cluster_helper->discarding() ? mm_io_cptr{ new mm_null_io_c{this_outfile} }
+          : g_write_behind                 ? mm_write_behind_io_c::open(this_outfile, 8 * 1024 * 1024, 4)
+          :                                  mm_write_buffer_io_c::open(this_outfile, 20 * 1024 * 1024);
   } catch (mtx::mm_io::exception &ex) {
     mxerror(boost::format(Y("The file '%1%' could not be opened for writing: %2%.\n")) % this_outfile % ex);
   }
@@ -1346,11 +1513,18 @@ create_next_output_file() {
   if (verbose && !g_cluster_helper->discarding())
     mxinfo(boost::format(Y("The file '%1%' has been opened for writing.\n")) % this_outfile);
 
+  // Without splitting the output file will be roughly as big as all
+  // source files together.
+  auto wbh_out = dynamic_cast<mm_write_behind_io_c *>(s_out.get());
+  if (wbh_out && !g_cluster_helper->splitting())
+    wbh_out->preallocate(g_file_sizes);
+
   g_cluster_helper->set_output(s_out.get());
 
   render_headers(s_out.get());
   render_attachments(s_out.get());
   render_chapter_void_placeholder();
+  render_cues_void_placeholder();
   add_tags_from_cue_chapters();
   prepare_tags_for_rendering();
 
@@ -1466,6 +1640,45 @@ set_track_statistics_tags(KaxTags *tags) {
   return tags;
 }
 
+/** \brief Writes the cues into the space reserved in front of the clusters
+
+   If the reserved space is too small then all data written after it
+   is moved towards the end of the file. The remaining space is filled
+   with an EbmlVoid element. It must therefore either be empty or be
+   at least two bytes big.
+*/
+static void
+render_cues_into_void_placeholder() {
+  auto &cues           = cues_c::get();
+  auto needed          = cues.calculate_element_size();
+  auto placeholder_pos = s_kax_cues_void->GetElementPosition();
+  auto available       = s_kax_cues_void->ElementSize();
+
+  if (!needed)
+    return;
+
+  // Relocating the clusters moves their positions which might make
+  // the cues grow slightly. Some slack avoids a second relocation.
+  while ((needed > available) || ((needed + 1) == available)) {
+    auto delta = needed > available ? needed - available + std::max<uint64_t>(needed / 100, 64) : 64;
+
+    mxdebug_if(s_debug_cues_before_clusters, boost::format("cues_before_clusters: needed %1% available %2%; relocating by %3%\n") % needed % available % delta);
+
+    relocate_written_data(placeholder_pos + available, delta);
+
+    available += delta;
+    needed     = cues.calculate_element_size();
+  }
+
+  mxdebug_if(s_debug_cues_before_clusters, boost::format("cues_before_clusters: writing %1% bytes at %2%; %3% bytes left\n") % needed % placeholder_pos % (available - needed));
+
+  s_out->save_pos(placeholder_pos);
+  cues.write(*s_out, *g_kax_sh_main);
+  if (available > needed)
+    render_void(available - needed);
+  s_out->restore_pos();
+}
+
 /** \brief Finishes and closes the current file
 
    Renders the data that is generated during the muxing run. The cues
@@ -1490,15 +1703,24 @@ finish_file(bool last_file,
   if (do_output)
     mxinfo("\n");
 
+  // Render the cues into the space reserved for them. This must happen
+  // before anything else is written after the clusters as that data
+  // might have to be moved.
+  if (s_kax_cues_void && g_write_cues && g_cue_writing_requested) {
+    if (do_output)
+      mxinfo(Y("The cue entries (the index) are being written...\n"));
+    render_cues_into_void_placeholder();
+  }
+
   // Render the track headers a second time if the user has requested that.
   if (hack_engaged(ENGAGE_WRITE_HEADERS_TWICE)) {
     auto second_tracks = clone(g_kax_tracks);
-    second_tracks->Render(*s_out);
+    render_level1_element(*second_tracks, *s_out);
     g_kax_sh_main->IndexThis(*second_tracks, *g_kax_segment);
   }
 
   // Render the cues.
-  if (g_write_cues && g_cue_writing_requested) {
+  if (!s_kax_cues_void && g_write_cues && g_cue_writing_requested) {
     if (do_output)
       mxinfo(Y("The cue entries (the index) are being written...\n"));
     cues_c::get().write(*s_out, *g_kax_sh_main);
@@ -1534,11 +1756,12 @@ finish_file(bool last_file,
       }
   }
 
-  if (0 != changed) {
+  // The segment info's checksum must be updated for the new duration.
+  if ((0 != changed) || g_write_crc32_elements) {
     s_out->setFilePointer(s_kax_infos->GetElementPosition());
     s_kax_infos->UpdateSize(true);
     info_size -= s_kax_infos->ElementSize();
-    s_kax_infos->Render(*s_out, true);
+    render_level1_element(*s_kax_infos, *s_out, true);
     if (2 == changed) {
       if (2 < info_size) {
         EbmlVoid void_after_infos;
@@ -1557,7 +1780,7 @@ finish_file(bool last_file,
 
   // Render the segment info a second time if the user has requested that.
   if (hack_engaged(ENGAGE_WRITE_HEADERS_TWICE)) {
-    s_kax_infos->Render(*s_out);
+    render_level1_element(*s_kax_infos, *s_out);
     g_kax_sh_main->IndexThis(*s_kax_infos, *g_kax_segment);
   }
 
@@ -1591,7 +1814,7 @@ finish_file(bool last_file,
   if (tags_here) {
     mtx::tags::fix_mandatory_elements(tags_here);
     tags_here->UpdateSize();
-    tags_here->Render(*s_out, true);
+    render_level1_element(*tags_here, *s_out, true);
 
     g_kax_sh_main->IndexThis(*tags_here, *g_kax_segment);
     delete tags_here;
@@ -1626,6 +1849,7 @@ finish_file(bool last_file,
   s_kax_sh_void.reset();
   g_kax_sh_main.reset();
   s_void_after_track_headers.reset();
+  s_kax_cues_void.reset();
   g_kax_sh_cues.reset();
   s_head.reset();
 }
@@ -1781,6 +2005,9 @@ append_track(packetizer_t &ptzr,
   ptzr.file                            = amap.src_file_id;
   ptzr.status                          = FILE_STATUS_MOREDATA;
 
+  // Appending changes the status of packetizers from several files.
+  mark_all_packetizers_for_polling();
+
   // If we're dealing with a subtitle track or if the appending file contains
   // chapters then we have to do some magic. During splitting timecodes are
   // offset by a certain amount. This amount is NOT the duration of the
@@ -1909,29 +2136,63 @@ establish_deferred_connections(filelist_t &file) {
   // \todo Select a new file that the subs will defer to.
 }
 
+static void
+pull_packetizer_for_packet(packetizer_t &ptzr) {
+  while (   !ptzr.pack
+         && (FILE_STATUS_MOREDATA == ptzr.status)
+         && !ptzr.packetizer->packet_available())
+    ptzr.status = ptzr.packetizer->read();
+
+  if (   (FILE_STATUS_MOREDATA != ptzr.status)
+         && (FILE_STATUS_MOREDATA == ptzr.old_status))
+    ptzr.packetizer->force_duration_on_last_packet();
+
+  if (!ptzr.pack)
+    ptzr.pack = ptzr.packetizer->get_packet();
+}
+
 static void
 pull_packetizers_for_packets() {
-  for (auto &ptzr : g_packetizers) {
+  // Only packetizers without a packet have to be asked for one:
+  // whichever one won the last round, those that were holding back
+  // and those that haven't been found to be dry yet. Packetizers
+  // marked while this loop is running (e.g. due to deferred
+  // connections being established) are visited in the same pass if
+  // their index is higher than the current one, just like when
+  // iterating over all packetizers.
+  auto idx_itr = s_packetizers_to_poll.begin();
+
+  while (idx_itr != s_packetizers_to_poll.end()) {
+    auto &ptzr    = g_packetizers[*idx_itr];
+    auto had_pack = !!ptzr.pack;
+
+    ++s_interleaver_stats.num_polls;
+
     if (FILE_STATUS_HOLDING == ptzr.status)
       ptzr.status = FILE_STATUS_MOREDATA;
 
     ptzr.old_status = ptzr.status;
 
-    while (   !ptzr.pack
-           && (FILE_STATUS_MOREDATA == ptzr.status)
-           && !ptzr.packetizer->packet_available())
-      ptzr.status = ptzr.packetizer->read();
-
-    if (   (FILE_STATUS_MOREDATA != ptzr.status)
-           && (FILE_STATUS_MOREDATA == ptzr.old_status))
-      ptzr.packetizer->force_duration_on_last_packet();
+    if (s_reader_workers.empty())
+      pull_packetizer_for_packet(ptzr);
 
-    if (!ptzr.pack)
-      ptzr.pack = ptzr.packetizer->get_packet();
+    else if (!ptzr.pack && (FILE_STATUS_DONE_AND_DRY != ptzr.status))
+      ptzr.status = s_reader_workers[ptzr.file]->fetch(ptzr.packetizer, ptzr.pack);
 
     if (!ptzr.pack && (FILE_STATUS_DONE == ptzr.status))
       ptzr.status = FILE_STATUS_DONE_AND_DRY;
 
+    if (!had_pack && ptzr.pack) {
+      s_interleaver_queue.push(interleaver_entry_t{ ptzr.pack->output_order_timecode, *idx_itr });
+      ++s_interleaver_stats.num_queue_operations;
+    }
+
+    // Packetizers that are holding back have to be asked again in the
+    // next round.
+    auto this_itr = idx_itr++;
+    if (ptzr.pack || (FILE_STATUS_HOLDING != ptzr.status))
+      s_packetizers_to_poll.erase(this_itr);
+
     // Has this packetizer changed its status from "data available" to
     // "file done" during this loop? If so then decrease the number of
     // unfinished packetizers in the corresponding file structure.
@@ -1953,24 +2214,85 @@ pull_packetizers_for_packets() {
 
 static packetizer_t *
 select_winning_packetizer() {
-  packetizer_t *winner = nullptr;
+  if (s_interleaver_queue.empty())
+    return nullptr;
 
-  for (auto &ptzr : g_packetizers) {
-    if (!ptzr.pack)
-      continue;
+  return &g_packetizers[s_interleaver_queue.top().ptzr_idx];
+}
+
+static void
+remove_winning_packetizer() {
+  auto ptzr_idx = s_interleaver_queue.top().ptzr_idx;
+
+  s_interleaver_queue.pop();
+  s_packetizers_to_poll.insert(ptzr_idx);
+
+  g_packetizers[ptzr_idx].pack.reset();
 
-    if (!winner || !winner->pack)
-      winner = &ptzr;
+  ++s_interleaver_stats.num_queue_operations;
+  ++s_interleaver_stats.num_packets;
+}
+
+static void
+reset_interleaver() {
+  s_interleaver_queue = decltype(s_interleaver_queue){};
+  s_packetizers_to_poll.clear();
+}
+
+static void
+display_interleaver_stats() {
+  if (!s_debug_interleaver)
+    return;
+
+  auto num_packets = std::max<int64_t>(s_interleaver_stats.num_packets, 1);
+
+  mxdebug(boost::format("interleaver: %1% packets from %2% packetizers; %3% polls (%4% per packet), %5% queue operations (%6% per packet); a linear scan would have visited %7% packetizers\n")
+          % s_interleaver_stats.num_packets % g_packetizers.size()
+          % s_interleaver_stats.num_polls            % (static_cast<double>(s_interleaver_stats.num_polls)            / num_packets)
+          % s_interleaver_stats.num_queue_operations % (static_cast<double>(s_interleaver_stats.num_queue_operations) / num_packets)
+          % (2 * s_interleaver_stats.num_packets * static_cast<int64_t>(g_packetizers.size())));
+}
+
+static void
+start_reader_workers() {
+  for (auto &file : g_files)
+    s_reader_workers.emplace_back(std::make_shared<reader_worker_c>(*file->reader));
+
+  for (auto &worker : s_reader_workers)
+    worker->start();
+}
 
-    else if (ptzr.pack && (ptzr.pack->output_order_timecode < winner->pack->output_order_timecode))
-      winner = &ptzr;
+static void
+stop_reader_workers() {
+  for (auto &worker : s_reader_workers)
+    worker->stop();
+
+  s_reader_workers.clear();
+
+  if (s_track_headers_rerender_requested)
+    rerender_track_headers();
+}
+
+static void
+add_packet_to_cluster(packet_cptr const &pack) {
+  if (s_reader_workers.empty()) {
+    g_cluster_helper->add_packet(pack);
+    return;
   }
 
-  return winner;
+  reader_worker_c::muxing_section_c muxing;
+
+  if (s_track_headers_rerender_requested)
+    rerender_track_headers();
+
+  g_cluster_helper->add_packet(pack);
 }
 
 static void
 discard_queued_packets() {
+  stop_reader_workers();
+  reset_interleaver();
+
   for (auto &ptzr : g_packetizers)
     ptzr.packetizer->discard_queued_packets();
 
@@ -1985,6 +2307,15 @@ discard_queued_packets() {
 */
 void
 main_loop() {
+  // Reading in worker threads is not possible when appending as
+  // packetizers are connected to each other then.
+  if (g_threaded_readers && !s_appending_files)
+    start_reader_workers();
+
+  auto workers_stopper = at_scope_exit_c{[]() { stop_reader_workers(); }};
+
+  mark_all_packetizers_for_polling();
+
   // Let's go!
   while (1) {
     // Step 1: Make sure a packet is available for each output
@@ -2003,9 +2334,9 @@ main_loop() {
 
       // Step 3: Add the winning packet to a cluster. Full clusters will be
       // rendered automatically.
-      g_cluster_helper->add_packet(pack);
+      add_packet_to_cluster(pack);
 
-      winner->pack.reset();
+      remove_winning_packetizer();
 
       // If splitting by parts is active and the last part has been
       // processed fully then we can finish up.
@@ -2022,6 +2353,10 @@ main_loop() {
       break;
   }
 
+  stop_reader_workers();
+  reset_interleaver();
+  display_interleaver_stats();
+
   // Render all remaining packets (if there are any).
   if (g_cluster_helper && (0 < g_cluster_helper->get_packet_count()))
     g_cluster_helper->render();
@@ -2056,4 +2391,6 @@ cleanup() {
   g_kax_info_chap.reset();
   g_forced_seguids.clear();
   g_kax_tracks.reset();
+
+  mtx::mem::pool::report();
 }
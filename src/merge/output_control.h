@@ -124,6 +124,12 @@ enum class identification_output_format_e {
   json,
 };
 
+enum class memory_mapped_input_e {
+  identification_only,
+  always,
+  never,
+};
+
 class family_uids_c: public std::vector<bitvalue_c> {
 public:
   bool add_family_uid(const KaxSegmentFamily &family);
@@ -148,7 +154,7 @@ extern family_uids_c g_segfamily_uids;
 
 extern kax_info_cptr g_kax_info_chap;
 
-extern bool g_write_meta_seek_for_clusters;
+extern bool g_write_meta_seek_for_clusters, g_write_crc32_elements, g_write_cues_before_clusters;
 
 extern std::string g_chapter_file_name;
 extern std::string g_chapter_language;
@@ -173,11 +179,13 @@ extern float g_video_fps;
 extern generic_packetizer_c *g_video_packetizer;
 
 extern bool g_write_cues, g_cue_writing_requested;
-extern bool g_no_lacing, g_no_linking, g_use_durations, g_no_track_statistics_tags;
+extern bool g_no_lacing, g_no_linking, g_use_durations, g_no_track_statistics_tags, g_threaded_readers, g_write_behind;
 
 extern bool g_identifying;
 extern identification_output_format_e g_identification_output_format;
 
+extern memory_mapped_input_e g_memory_mapped_input;
+
 extern int g_file_num;
 extern int64_t g_file_sizes;
 
@@ -48,6 +48,9 @@ public:
 };
 using packet_extension_cptr = std::shared_ptr<packet_extension_c>;
 
+struct packet_t;
+using packet_cptr = std::shared_ptr<packet_t>;
+
 struct packet_t {
   memory_cptr data;
   std::vector<memory_cptr> data_adds;
@@ -148,6 +151,30 @@ struct packet_t {
   ~packet_t() {
   }
 
+  // Packets are created and destroyed for each frame. Take them from
+  // the memory pool instead of the heap.
+  static void *operator new(size_t size) {
+    return mtx::mem::pool::allocate(size);
+  }
+
+  static void operator delete(void *ptr, size_t size) {
+    mtx::mem::pool::release(ptr, size);
+  }
+
+  // Replacements for packet_t::create() and
+  // packet_cptr{new packet_t} that take the shared pointer's control
+  // block from the memory pool as well.
+  template<typename... Args>
+  static packet_cptr
+  create(Args &&... args) {
+    return std::allocate_shared<packet_t>(mtx::mem::pool::allocator_c<packet_t>{}, std::forward<Args>(args)...);
+  }
+
+  static packet_cptr
+  own(packet_t *packet) {
+    return packet_cptr(packet, std::default_delete<packet_t>{}, mtx::mem::pool::allocator_c<packet_t>{});
+  }
+
   bool
   has_timecode()
     const {
@@ -224,6 +251,5 @@ struct packet_t {
 
   void account(track_statistics_c &statistics) const;
 };
-using packet_cptr = std::shared_ptr<packet_t>;
 
 #endif // MTX_PACKET_H
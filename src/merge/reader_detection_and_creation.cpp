@@ -12,7 +12,11 @@
 
 #include "common/common_pch.h"
 
+#include "common/list_utils.h"
+#include "common/mm_mmap_io.h"
 #include "common/mm_mpls_multi_file_io.h"
+#include "common/mm_prefetch_io.h"
+#include "common/mm_probe_buffer_io.h"
 #include "common/mm_read_buffer_io.h"
 #include "common/strings/formatting.h"
 #include "common/xml/xml.h"
@@ -66,16 +70,33 @@ file_names_to_paths(const std::vector<std::string> &file_names) {
   return paths;
 }
 
+static bool
+use_memory_mapped_input() {
+  return (memory_mapped_input_e::always == g_memory_mapped_input)
+      || ((memory_mapped_input_e::identification_only == g_memory_mapped_input) && g_identifying);
+}
+
+// Readers for these types read their files mostly sequentially. They
+// profit from having the data read ahead in a background thread.
+static bool
+reads_sequentially(file_type_e type) {
+  return mtx::included_in(type, FILE_TYPE_AVI, FILE_TYPE_MATROSKA, FILE_TYPE_MPEG_PS, FILE_TYPE_MPEG_TS);
+}
+
 static mm_io_cptr
-open_input_file(filelist_t &file) {
+open_input_file(filelist_t &file,
+                bool read_ahead = false) {
   try {
-    if (file.all_names.size() == 1)
-      return mm_io_cptr(new mm_read_buffer_io_c(new mm_file_io_c(file.name), 1 << 17));
+    if ((file.all_names.size() == 1) && use_memory_mapped_input())
+      return mm_mmap_io_c::open(file.name, 1 << 17);
 
-    else {
-      std::vector<bfs::path> paths = file_names_to_paths(file.all_names);
-      return mm_io_cptr(new mm_read_buffer_io_c(new mm_multi_file_io_c(paths, file.name), 1 << 17));
-    }
+    mm_io_c *in = file.all_names.size() == 1 ? static_cast<mm_io_c *>(new mm_file_io_c(file.name))
+                :                              static_cast<mm_io_c *>(new mm_multi_file_io_c(file_names_to_paths(file.all_names), file.name));
+
+    if (read_ahead && !g_identifying)
+      return mm_io_cptr(new mm_prefetch_io_c(in));
+
+    return mm_io_cptr(new mm_read_buffer_io_c(in, 1 << 17));
 
   } catch (mtx::mm_io::exception &ex) {
     mxerror(boost::format(Y("The file '%1%' could not be opened for reading: %2%.\n")) % file.name % ex);
@@ -100,33 +121,128 @@ open_playlist_file(filelist_t &file,
   return true;
 }
 
+static debugging_option_c &
+debug_file_type_probing() {
+  static auto s_debug = debugging_option_c{"probe_file_type"};
+  return s_debug;
+}
+
+// Runs a single prober and reports how long it took.
+template<typename Treader, typename Tio, typename... Targs>
+static bool
+probe(file_type_e type,
+      Tio *io,
+      int64_t size,
+      Targs... args) {
+  auto start  = std::chrono::steady_clock::now();
+  auto result = !!Treader::probe_file(io, size, args...);
+
+  mxdebug_if(debug_file_type_probing(),
+             boost::format("probe for %1%: result %2% in %3% us\n")
+             % file_type_t::get_name(type).get_untranslated() % result % std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+
+  return result;
+}
+
+struct file_type_signature_t {
+  file_type_e type;
+  size_t offset;
+  std::string magic;
+};
+
+// Determines which of the file types that can be detected
+// unambiguously is the most likely one by looking at the first bytes
+// of the file. That type's prober is tried first.
+static file_type_e
+guess_file_type_from_signature(unsigned char const *head,
+                               size_t head_size) {
+  static std::vector<file_type_signature_t> const s_signatures{
+    { FILE_TYPE_MATROSKA,  0, "\x1a\x45\xdf\xa3" },
+    { FILE_TYPE_QTMP4,     4, "ftyp"             },
+    { FILE_TYPE_QTMP4,     4, "moov"             },
+    { FILE_TYPE_QTMP4,     4, "mdat"             },
+    { FILE_TYPE_QTMP4,     4, "free"             },
+    { FILE_TYPE_QTMP4,     4, "wide"             },
+    { FILE_TYPE_QTMP4,     4, "skip"             },
+    { FILE_TYPE_AVI,       8, "AVI "             },
+    { FILE_TYPE_WAV,       8, "WAVE"             },
+    { FILE_TYPE_WAV,       0, "RF64"             },
+    { FILE_TYPE_CDXA,      8, "CDXA"             },
+    { FILE_TYPE_OGM,       0, "OggS"             },
+    { FILE_TYPE_FLAC,      0, "fLaC"             },
+    { FILE_TYPE_FLV,       0, "FLV"              },
+    { FILE_TYPE_ASF,       0, "\x30\x26\xb2\x75" },
+    { FILE_TYPE_AAC,       0, "ADIF"             },
+    { FILE_TYPE_REAL,      0, ".RMF"             },
+    { FILE_TYPE_TTA,       0, "TTA1"             },
+    { FILE_TYPE_WAVPACK4,  0, "wvpk"             },
+    { FILE_TYPE_IVF,       0, "DKIF"             },
+    { FILE_TYPE_COREAUDIO, 0, "caff"             },
+    { FILE_TYPE_DIRAC,     0, "BBCD"             },
+    { FILE_TYPE_PGSSUP,    0, "PG"               },
+  };
+
+  for (auto const &signature : s_signatures)
+    if (   ((signature.offset + signature.magic.size()) <= head_size)
+        && !std::memcmp(head + signature.offset, signature.magic.c_str(), signature.magic.size()))
+      return signature.type;
+
+  return FILE_TYPE_IS_UNKNOWN;
+}
+
+static bool
+probe_unambiguous_file_type(file_type_e type,
+                            mm_io_c *io,
+                            int64_t size) {
+  switch (type) {
+    case FILE_TYPE_AAC:       return probe<aac_adif_reader_c>( type, io, size);
+    case FILE_TYPE_ASF:       return probe<asf_reader_c>(      type, io, size);
+    case FILE_TYPE_AVI:       return probe<avi_reader_c>(      type, io, size);
+    case FILE_TYPE_CDXA:      return probe<cdxa_reader_c>(     type, io, size);
+    case FILE_TYPE_COREAUDIO: return probe<coreaudio_reader_c>(type, io, size);
+    case FILE_TYPE_DIRAC:     return probe<dirac_es_reader_c>( type, io, size);
+    case FILE_TYPE_FLAC:      return probe<flac_reader_c>(     type, io, size);
+    case FILE_TYPE_FLV:       return probe<flv_reader_c>(      type, io, size);
+    case FILE_TYPE_IVF:       return probe<ivf_reader_c>(      type, io, size);
+    case FILE_TYPE_MATROSKA:  return probe<kax_reader_c>(      type, io, size);
+    case FILE_TYPE_OGM:       return probe<ogm_reader_c>(      type, io, size);
+    case FILE_TYPE_PGSSUP:    return probe<pgssup_reader_c>(   type, io, size);
+    case FILE_TYPE_QTMP4:     return probe<qtmp4_reader_c>(    type, io, size);
+    case FILE_TYPE_REAL:      return probe<real_reader_c>(     type, io, size);
+    case FILE_TYPE_TTA:       return probe<tta_reader_c>(      type, io, size);
+    case FILE_TYPE_WAV:       return probe<wav_reader_c>(      type, io, size);
+    case FILE_TYPE_WAVPACK4:  return probe<wavpack_reader_c>(  type, io, size);
+    default:                  return false;
+  }
+}
+
 static file_type_e
-detect_text_file_formats(filelist_t const &file) {
+detect_text_file_formats(mm_io_c *io) {
   auto text_io = mm_text_io_cptr{};
   try {
-    text_io        = std::make_shared<mm_text_io_c>(new mm_file_io_c(file.name));
+    text_io        = std::make_shared<mm_text_io_c>(io, false);
     auto text_size = text_io->get_size();
 
-    if (webvtt_reader_c::probe_file(text_io.get(), text_size))
+    if (probe<webvtt_reader_c>(FILE_TYPE_WEBVTT, text_io.get(), text_size))
       return FILE_TYPE_WEBVTT;
-    else if (srt_reader_c::probe_file(text_io.get(), text_size))
+    else if (probe<srt_reader_c>(FILE_TYPE_SRT, text_io.get(), text_size))
       return FILE_TYPE_SRT;
-    else if (ssa_reader_c::probe_file(text_io.get(), text_size))
+    else if (probe<ssa_reader_c>(FILE_TYPE_SSA, text_io.get(), text_size))
       return FILE_TYPE_SSA;
-    else if (vobsub_reader_c::probe_file(text_io.get(), text_size))
+    else if (probe<vobsub_reader_c>(FILE_TYPE_VOBSUB, text_io.get(), text_size))
       return FILE_TYPE_VOBSUB;
-    else if (usf_reader_c::probe_file(text_io.get(), text_size))
+    else if (probe<usf_reader_c>(FILE_TYPE_USF, text_io.get(), text_size))
       return FILE_TYPE_USF;
 
     // Unsupported text subtitle formats
-    else if (microdvd_reader_c::probe_file(text_io.get(), text_size))
+    else if (probe<microdvd_reader_c>(FILE_TYPE_MICRODVD, text_io.get(), text_size))
       return FILE_TYPE_MICRODVD;
 
   } catch (mtx::mm_io::exception &ex) {
-    mxerror(boost::format(Y("The file '%1%' could not be opened for reading: %2%.\n")) % file.name % ex);
+    mxerror(boost::format(Y("The file '%1%' could not be opened for reading: %2%.\n")) % io->get_file_name() % ex);
 
   } catch (...) {
-    mxerror(boost::format(Y("The source file '%1%' could not be opened successfully, or retrieving its size by seeking to the end did not work.\n")) % file.name);
+    mxerror(boost::format(Y("The source file '%1%' could not be opened successfully, or retrieving its size by seeking to the end did not work.\n")) % io->get_file_name());
   }
 
   return FILE_TYPE_IS_UNKNOWN;
@@ -136,76 +252,97 @@ detect_text_file_formats(filelist_t const &file) {
 
    Opens the input file and calls the \c probe_file function for each known
    file reader class. Uses \c mm_text_io_c for subtitle probing.
+
+   The start of the file is read on demand into a buffer shared by all
+   probers. The first bytes are used for trying the most likely
+   prober first.
 */
 static std::pair<file_type_e, int64_t>
 get_file_type_internal(filelist_t &file) {
-  mm_io_cptr af_io = open_input_file(file);
-  mm_io_c *io      = af_io.get();
-  int64_t size     = std::min(io->get_size(), static_cast<int64_t>(1 << 25));
+  auto probing_start = std::chrono::steady_clock::now();
+  mm_io_cptr af_io   = open_input_file(file);
+  mm_io_c *io        = af_io.get();
+  int64_t size       = std::min(io->get_size(), static_cast<int64_t>(1 << 25));
 
   auto is_playlist = !file.is_playlist && open_playlist_file(file, io);
   if (is_playlist)
     io = file.playlist_mpls_in.get();
 
+  // Memory-mapped files don't profit from an additional buffer.
+  auto probe_io = std::shared_ptr<mm_probe_buffer_io_c>{};
+  if (!is_playlist && !dynamic_cast<mm_mmap_io_c *>(io)) {
+    probe_io = std::make_shared<mm_probe_buffer_io_c>(io, 2 * 1024 * 1024, false);
+    io       = probe_io.get();
+  }
+
   file_type_e type = FILE_TYPE_IS_UNKNOWN;
 
+  if (probe_io) {
+    auto likely_type = guess_file_type_from_signature(probe_io->get_head(), probe_io->get_head_size());
+    if ((FILE_TYPE_IS_UNKNOWN != likely_type) && probe_unambiguous_file_type(likely_type, io, size))
+      type = likely_type;
+  }
+
+  if (FILE_TYPE_IS_UNKNOWN != type)
+    ;                           // intentional fall-through
+
   // File types that can be detected unambiguously but are not supported
-  if (aac_adif_reader_c::probe_file(io, size))
+  else if (probe<aac_adif_reader_c>(FILE_TYPE_AAC, io, size))
     type = FILE_TYPE_AAC;
-  else if (asf_reader_c::probe_file(io, size))
+  else if (probe<asf_reader_c>(FILE_TYPE_ASF, io, size))
     type = FILE_TYPE_ASF;
-  else if (cdxa_reader_c::probe_file(io, size))
+  else if (probe<cdxa_reader_c>(FILE_TYPE_CDXA, io, size))
     type = FILE_TYPE_CDXA;
-  else if (flv_reader_c::probe_file(io, size))
+  else if (probe<flv_reader_c>(FILE_TYPE_FLV, io, size))
     type = FILE_TYPE_FLV;
-  else if (hdsub_reader_c::probe_file(io, size))
+  else if (probe<hdsub_reader_c>(FILE_TYPE_HDSUB, io, size))
     type = FILE_TYPE_HDSUB;
 
   // File types that can be detected unambiguously
-  else if (avi_reader_c::probe_file(io, size))
+  else if (probe<avi_reader_c>(FILE_TYPE_AVI, io, size))
     type = FILE_TYPE_AVI;
-  else if (kax_reader_c::probe_file(io, size))
+  else if (probe<kax_reader_c>(FILE_TYPE_MATROSKA, io, size))
     type = FILE_TYPE_MATROSKA;
-  else if (wav_reader_c::probe_file(io, size))
+  else if (probe<wav_reader_c>(FILE_TYPE_WAV, io, size))
     type = FILE_TYPE_WAV;
-  else if (ogm_reader_c::probe_file(io, size))
+  else if (probe<ogm_reader_c>(FILE_TYPE_OGM, io, size))
     type = FILE_TYPE_OGM;
-  else if (flac_reader_c::probe_file(io, size))
+  else if (probe<flac_reader_c>(FILE_TYPE_FLAC, io, size))
     type = FILE_TYPE_FLAC;
-  else if (pgssup_reader_c::probe_file(io, size))
+  else if (probe<pgssup_reader_c>(FILE_TYPE_PGSSUP, io, size))
     type = FILE_TYPE_PGSSUP;
-  else if (real_reader_c::probe_file(io, size))
+  else if (probe<real_reader_c>(FILE_TYPE_REAL, io, size))
     type = FILE_TYPE_REAL;
-  else if (qtmp4_reader_c::probe_file(io, size))
+  else if (probe<qtmp4_reader_c>(FILE_TYPE_QTMP4, io, size))
     type = FILE_TYPE_QTMP4;
-  else if (tta_reader_c::probe_file(io, size))
+  else if (probe<tta_reader_c>(FILE_TYPE_TTA, io, size))
     type = FILE_TYPE_TTA;
-  else if (vc1_es_reader_c::probe_file(io, size))
+  else if (probe<vc1_es_reader_c>(FILE_TYPE_VC1, io, size))
     type = FILE_TYPE_VC1;
-  else if (wavpack_reader_c::probe_file(io, size))
+  else if (probe<wavpack_reader_c>(FILE_TYPE_WAVPACK4, io, size))
     type = FILE_TYPE_WAVPACK4;
-  else if (ivf_reader_c::probe_file(io, size))
+  else if (probe<ivf_reader_c>(FILE_TYPE_IVF, io, size))
     type = FILE_TYPE_IVF;
-  else if (coreaudio_reader_c::probe_file(io, size))
+  else if (probe<coreaudio_reader_c>(FILE_TYPE_COREAUDIO, io, size))
     type = FILE_TYPE_COREAUDIO;
-  else if (dirac_es_reader_c::probe_file(io, size))
+  else if (probe<dirac_es_reader_c>(FILE_TYPE_DIRAC, io, size))
     type = FILE_TYPE_DIRAC;
 
   // All text file types (subtitles).
   else
-    type = detect_text_file_formats(file);
+    type = detect_text_file_formats(probe_io ? static_cast<mm_io_c *>(probe_io.get()) : af_io.get());
 
   if (FILE_TYPE_IS_UNKNOWN != type)
     ;                           // intentional fall-through
   // File types that are mis-detected sometimes and that aren't supported
-  else if (dv_reader_c::probe_file(io, size))
+  else if (probe<dv_reader_c>(FILE_TYPE_DV, io, size))
     type = FILE_TYPE_DV;
   // File types that are mis-detected sometimes
-  else if (dts_reader_c::probe_file(io, size, true))
+  else if (probe<dts_reader_c>(FILE_TYPE_DTS, io, size, true))
     type = FILE_TYPE_DTS;
-  else if (mpeg_ts_reader_c::probe_file(io, size))
+  else if (probe<mpeg_ts_reader_c>(FILE_TYPE_MPEG_TS, io, size))
     type = FILE_TYPE_MPEG_TS;
-  else if (mpeg_ps_reader_c::probe_file(io, size))
+  else if (probe<mpeg_ps_reader_c>(FILE_TYPE_MPEG_PS, io, size))
     type = FILE_TYPE_MPEG_PS;
   else {
     // File types which are the same in raw format and in other container formats.
@@ -215,39 +352,39 @@ get_file_type_internal(filelist_t &file) {
 
     int i;
     for (i = 0; (0 != s_probe_sizes[i]) && (FILE_TYPE_IS_UNKNOWN == type); ++i)
-      if (mp3_reader_c::probe_file(io, size, s_probe_sizes[i], s_probe_num_required_consecutive_packets))
+      if (probe<mp3_reader_c>(FILE_TYPE_MP3, io, size, s_probe_sizes[i], s_probe_num_required_consecutive_packets))
         type = FILE_TYPE_MP3;
-      else if (ac3_reader_c::probe_file(io, size, s_probe_sizes[i], s_probe_num_required_consecutive_packets))
+      else if (probe<ac3_reader_c>(FILE_TYPE_AC3, io, size, s_probe_sizes[i], s_probe_num_required_consecutive_packets))
         type = FILE_TYPE_AC3;
-      else if (aac_reader_c::probe_file(io, size, s_probe_sizes[i], s_probe_num_required_consecutive_packets))
+      else if (probe<aac_reader_c>(FILE_TYPE_AAC, io, size, s_probe_sizes[i], s_probe_num_required_consecutive_packets))
         type = FILE_TYPE_AAC;
   }
   // More file types with detection issues.
   if (type != FILE_TYPE_IS_UNKNOWN)
     ;
-  else if (truehd_reader_c::probe_file(io, size))
+  else if (probe<truehd_reader_c>(FILE_TYPE_TRUEHD, io, size))
     type = FILE_TYPE_TRUEHD;
-  else if (dts_reader_c::probe_file(io, size))
+  else if (probe<dts_reader_c>(FILE_TYPE_DTS, io, size))
     type = FILE_TYPE_DTS;
-  else if (vobbtn_reader_c::probe_file(io, size))
+  else if (probe<vobbtn_reader_c>(FILE_TYPE_VOBBTN, io, size))
     type = FILE_TYPE_VOBBTN;
 
   // Try some more of the raw audio formats before trying elementary
   // stream video formats (MPEG 1/2, AVC/h.264, HEVC/h.265; those
   // often enough simply work). However, require that the first frame
   // starts at the beginning of the file.
-  else if (mp3_reader_c::probe_file(io, size, 32 * 1024, 1, true))
+  else if (probe<mp3_reader_c>(FILE_TYPE_MP3, io, size, 32 * 1024, 1, true))
     type = FILE_TYPE_MP3;
-  else if (ac3_reader_c::probe_file(io, size, 32 * 1024, 1, true))
+  else if (probe<ac3_reader_c>(FILE_TYPE_AC3, io, size, 32 * 1024, 1, true))
     type = FILE_TYPE_AC3;
-  else if (aac_reader_c::probe_file(io, size, 32 * 1024, 1, true))
+  else if (probe<aac_reader_c>(FILE_TYPE_AAC, io, size, 32 * 1024, 1, true))
     type = FILE_TYPE_AAC;
 
-  else if (mpeg_es_reader_c::probe_file(io, size))
+  else if (probe<mpeg_es_reader_c>(FILE_TYPE_MPEG_ES, io, size))
     type = FILE_TYPE_MPEG_ES;
-  else if (avc_es_reader_c::probe_file(io, size))
+  else if (probe<avc_es_reader_c>(FILE_TYPE_AVC_ES, io, size))
     type = FILE_TYPE_AVC_ES;
-  else if (hevc_es_reader_c::probe_file(io, size))
+  else if (probe<hevc_es_reader_c>(FILE_TYPE_HEVC_ES, io, size))
     type = FILE_TYPE_HEVC_ES;
   else {
     // File types which are the same in raw format and in other container formats.
@@ -257,14 +394,19 @@ get_file_type_internal(filelist_t &file) {
 
     int i;
     for (i = 0; (0 != s_probe_sizes[i]) && (FILE_TYPE_IS_UNKNOWN == type); ++i)
-      if (mp3_reader_c::probe_file(io, size, s_probe_sizes[i], s_probe_num_required_consecutive_packets))
+      if (probe<mp3_reader_c>(FILE_TYPE_MP3, io, size, s_probe_sizes[i], s_probe_num_required_consecutive_packets))
         type = FILE_TYPE_MP3;
-      else if (ac3_reader_c::probe_file(io, size, s_probe_sizes[i], s_probe_num_required_consecutive_packets))
+      else if (probe<ac3_reader_c>(FILE_TYPE_AC3, io, size, s_probe_sizes[i], s_probe_num_required_consecutive_packets))
         type = FILE_TYPE_AC3;
-      else if (aac_reader_c::probe_file(io, size, s_probe_sizes[i], s_probe_num_required_consecutive_packets))
+      else if (probe<aac_reader_c>(FILE_TYPE_AAC, io, size, s_probe_sizes[i], s_probe_num_required_consecutive_packets))
         type = FILE_TYPE_AAC;
   }
 
+  mxdebug_if(debug_file_type_probing(),
+             boost::format("file type of %1%: %2%; probing took %3% us; bytes read beyond the probe buffer: %4%\n")
+             % file.name % file_type_t::get_name(type).get_untranslated() % std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - probing_start).count()
+             % (probe_io ? probe_io->get_num_bytes_read_through() : 0));
+
   return std::make_pair(type, size);
 }
 
@@ -272,152 +414,163 @@ void
 get_file_type(filelist_t &file) {
   auto result = get_file_type_internal(file);
 
-  g_file_sizes += result.second;
+  // Files may be identified concurrently (see
+  // "--identification-threads"). The sum is only needed for muxing.
+  if (!g_identifying)
+    g_file_sizes += result.second;
 
   file.size     = result.second;
   file.type     = result.first;
 }
 
-/** \brief Creates the file readers
+/** \brief Creates the reader for a single file
 
-   For each file the appropriate file reader class is instantiated.
-   The newly created class must read all track information in its
-   constructor and throw an exception in case of an error. Otherwise
-   it is assumed that the file can be handled.
+   The appropriate file reader class is instantiated for the file's
+   type. The newly created class must read all track information in
+   its constructor and throw an exception in case of an error.
+   Otherwise it is assumed that the file can be handled.
 */
 void
-create_readers() {
+create_reader(filelist_t &file) {
   static auto s_debug_timecode_restrictions = debugging_option_c{"timecode_restrictions"};
 
-  for (auto &file : g_files) {
-    try {
-      mm_io_cptr input_file = file->playlist_mpls_in ? std::static_pointer_cast<mm_io_c>(file->playlist_mpls_in) : open_input_file(*file);
-
-      switch (file->type) {
-        case FILE_TYPE_AAC:
-          file->reader.reset(new aac_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_AC3:
-          file->reader.reset(new ac3_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_AVC_ES:
-          file->reader.reset(new avc_es_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_HEVC_ES:
-          file->reader.reset(new hevc_es_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_AVI:
-          file->reader.reset(new avi_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_COREAUDIO:
-          file->reader.reset(new coreaudio_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_DIRAC:
-          file->reader.reset(new dirac_es_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_DTS:
-          file->reader.reset(new dts_reader_c(*file->ti, input_file));
-          break;
+  try {
+    mm_io_cptr input_file = file.playlist_mpls_in ? std::static_pointer_cast<mm_io_c>(file.playlist_mpls_in) : open_input_file(file, reads_sequentially(file.type));
+
+    switch (file.type) {
+      case FILE_TYPE_AAC:
+        file.reader.reset(new aac_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_AC3:
+        file.reader.reset(new ac3_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_AVC_ES:
+        file.reader.reset(new avc_es_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_HEVC_ES:
+        file.reader.reset(new hevc_es_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_AVI:
+        file.reader.reset(new avi_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_COREAUDIO:
+        file.reader.reset(new coreaudio_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_DIRAC:
+        file.reader.reset(new dirac_es_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_DTS:
+        file.reader.reset(new dts_reader_c(*file.ti, input_file));
+        break;
 #if defined(HAVE_FLAC_FORMAT_H)
-        case FILE_TYPE_FLAC:
-          file->reader.reset(new flac_reader_c(*file->ti, input_file));
-          break;
+      case FILE_TYPE_FLAC:
+        file.reader.reset(new flac_reader_c(*file.ti, input_file));
+        break;
 #endif
-        case FILE_TYPE_FLV:
-          file->reader.reset(new flv_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_IVF:
-          file->reader.reset(new ivf_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_MATROSKA:
-          file->reader.reset(new kax_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_MP3:
-          file->reader.reset(new mp3_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_MPEG_ES:
-          file->reader.reset(new mpeg_es_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_MPEG_PS:
-          file->reader.reset(new mpeg_ps_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_MPEG_TS:
-          file->reader.reset(new mpeg_ts_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_OGM:
-          file->reader.reset(new ogm_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_PGSSUP:
-          file->reader.reset(new pgssup_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_QTMP4:
-          file->reader.reset(new qtmp4_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_REAL:
-          file->reader.reset(new real_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_SSA:
-          file->reader.reset(new ssa_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_SRT:
-          file->reader.reset(new srt_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_TRUEHD:
-          file->reader.reset(new truehd_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_TTA:
-          file->reader.reset(new tta_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_USF:
-          file->reader.reset(new usf_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_VC1:
-          file->reader.reset(new vc1_es_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_VOBBTN:
-          file->reader.reset(new vobbtn_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_VOBSUB:
-          file->reader.reset(new vobsub_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_WAV:
-          file->reader.reset(new wav_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_WAVPACK4:
-          file->reader.reset(new wavpack_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_WEBVTT:
-          file->reader.reset(new webvtt_reader_c(*file->ti, input_file));
-          break;
-        default:
-          mxerror(boost::format(Y("EVIL internal bug! (unknown file type). %1%\n")) % BUGMSG);
-          break;
-      }
-
-      file->reader->read_headers();
-      file->reader->set_timecode_restrictions(file->restricted_timecode_min, file->restricted_timecode_max);
-
-      // Re-calculate file size because the reader might switch to a
-      // multi I/O reader in read_headers().
-      file->size = file->reader->get_file_size();
-
-      mxdebug_if(s_debug_timecode_restrictions,
-                 boost::format("Timecode restrictions for %3%: min %1% max %2%\n") % file->restricted_timecode_min % file->restricted_timecode_max % file->ti->m_fname);
-
-    } catch (mtx::mm_io::open_x &error) {
-      mxerror(boost::format(Y("The demultiplexer for the file '%1%' failed to initialize:\n%2%\n")) % file->ti->m_fname % Y("The file could not be opened for reading, or there was not enough data to parse its headers."));
-
-    } catch (mtx::input::open_x &error) {
-      mxerror(boost::format(Y("The demultiplexer for the file '%1%' failed to initialize:\n%2%\n")) % file->ti->m_fname % Y("The file could not be opened for reading, or there was not enough data to parse its headers."));
-
-    } catch (mtx::input::invalid_format_x &error) {
-      mxerror(boost::format(Y("The demultiplexer for the file '%1%' failed to initialize:\n%2%\n")) % file->ti->m_fname % Y("The file content does not match its format type and was not recognized."));
-
-    } catch (mtx::input::header_parsing_x &error) {
-      mxerror(boost::format(Y("The demultiplexer for the file '%1%' failed to initialize:\n%2%\n")) % file->ti->m_fname % Y("The file headers could not be parsed, e.g. because they're incomplete, invalid or damaged."));
-
-    } catch (mtx::input::exception &error) {
-      mxerror(boost::format(Y("The demultiplexer for the file '%1%' failed to initialize:\n%2%\n")) % file->ti->m_fname % error.error());
+      case FILE_TYPE_FLV:
+        file.reader.reset(new flv_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_IVF:
+        file.reader.reset(new ivf_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_MATROSKA:
+        file.reader.reset(new kax_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_MP3:
+        file.reader.reset(new mp3_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_MPEG_ES:
+        file.reader.reset(new mpeg_es_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_MPEG_PS:
+        file.reader.reset(new mpeg_ps_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_MPEG_TS:
+        file.reader.reset(new mpeg_ts_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_OGM:
+        file.reader.reset(new ogm_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_PGSSUP:
+        file.reader.reset(new pgssup_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_QTMP4:
+        file.reader.reset(new qtmp4_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_REAL:
+        file.reader.reset(new real_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_SSA:
+        file.reader.reset(new ssa_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_SRT:
+        file.reader.reset(new srt_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_TRUEHD:
+        file.reader.reset(new truehd_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_TTA:
+        file.reader.reset(new tta_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_USF:
+        file.reader.reset(new usf_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_VC1:
+        file.reader.reset(new vc1_es_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_VOBBTN:
+        file.reader.reset(new vobbtn_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_VOBSUB:
+        file.reader.reset(new vobsub_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_WAV:
+        file.reader.reset(new wav_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_WAVPACK4:
+        file.reader.reset(new wavpack_reader_c(*file.ti, input_file));
+        break;
+      case FILE_TYPE_WEBVTT:
+        file.reader.reset(new webvtt_reader_c(*file.ti, input_file));
+        break;
+      default:
+        mxerror(boost::format(Y("EVIL internal bug! (unknown file type). %1%\n")) % BUGMSG);
+        break;
     }
+
+    file.reader->read_headers();
+    file.reader->set_timecode_restrictions(file.restricted_timecode_min, file.restricted_timecode_max);
+
+    // Re-calculate file size because the reader might switch to a
+    // multi I/O reader in read_headers().
+    file.size = file.reader->get_file_size();
+
+    mxdebug_if(s_debug_timecode_restrictions,
+               boost::format("Timecode restrictions for %3%: min %1% max %2%\n") % file.restricted_timecode_min % file.restricted_timecode_max % file.ti->m_fname);
+
+  } catch (mtx::mm_io::open_x &error) {
+    mxerror(boost::format(Y("The demultiplexer for the file '%1%' failed to initialize:\n%2%\n")) % file.ti->m_fname % Y("The file could not be opened for reading, or there was not enough data to parse its headers."));
+
+  } catch (mtx::input::open_x &error) {
+    mxerror(boost::format(Y("The demultiplexer for the file '%1%' failed to initialize:\n%2%\n")) % file.ti->m_fname % Y("The file could not be opened for reading, or there was not enough data to parse its headers."));
+
+  } catch (mtx::input::invalid_format_x &error) {
+    mxerror(boost::format(Y("The demultiplexer for the file '%1%' failed to initialize:\n%2%\n")) % file.ti->m_fname % Y("The file content does not match its format type and was not recognized."));
+
+  } catch (mtx::input::header_parsing_x &error) {
+    mxerror(boost::format(Y("The demultiplexer for the file '%1%' failed to initialize:\n%2%\n")) % file.ti->m_fname % Y("The file headers could not be parsed, e.g. because they're incomplete, invalid or damaged."));
+
+  } catch (mtx::input::exception &error) {
+    mxerror(boost::format(Y("The demultiplexer for the file '%1%' failed to initialize:\n%2%\n")) % file.ti->m_fname % error.error());
   }
 }
+
+/** \brief Creates the file readers
+
+   For each file the appropriate file reader class is instantiated.
+*/
+void
+create_readers() {
+  for (auto &file : g_files)
+    create_reader(*file);
+}
@@ -0,0 +1,327 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   running readers and their packetizers on worker threads
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "merge/generic_packetizer.h"
+#include "merge/generic_reader.h"
+#include "merge/reader_worker.h"
+
+// Limits for the amount of data a worker reads ahead of the main
+// thread. If the main thread waits for a packet from a particular
+// packetizer then the worker reads for it regardless of those limits.
+static size_t const s_max_queued_packets = 128;
+static int64_t const s_max_queued_bytes  = 64 * 1024 * 1024;
+
+static thread_local bool s_is_worker_thread = false;
+
+static std::mutex s_muxing_mutex;
+static std::condition_variable s_muxing_cond;
+static unsigned int s_num_active_readers = 0;
+static bool s_muxing_requested           = false;
+
+// Held by a worker while its reader and packetizers are working. The
+// main thread gets preference so that muxing isn't starved by the
+// workers.
+class reading_section_c {
+public:
+  reading_section_c() {
+    std::unique_lock<std::mutex> lock{s_muxing_mutex};
+    s_muxing_cond.wait(lock, []() { return !s_muxing_requested; });
+    ++s_num_active_readers;
+  }
+
+  ~reading_section_c() {
+    std::lock_guard<std::mutex> lock{s_muxing_mutex};
+    --s_num_active_readers;
+    s_muxing_cond.notify_all();
+  }
+};
+
+reader_worker_c::muxing_section_c::muxing_section_c() {
+  std::unique_lock<std::mutex> lock{s_muxing_mutex};
+  s_muxing_requested = true;
+  s_muxing_cond.wait(lock, []() { return !s_num_active_readers; });
+}
+
+reader_worker_c::muxing_section_c::~muxing_section_c() {
+  std::lock_guard<std::mutex> lock{s_muxing_mutex};
+  s_muxing_requested = false;
+  s_muxing_cond.notify_all();
+}
+
+// ------------------------------------------------------------
+
+struct reader_worker_c::slot_t {
+  generic_packetizer_c *ptzr;
+  std::deque<packet_cptr> packets;
+
+  // Number of packets ever put into resp. taken from the queue.
+  int64_t num_pushed{}, num_popped{};
+
+  // Number of packets that had been queued before the reader
+  // signalled the end of data. As long as the reader hasn't returned
+  // a final status for this packetizer the candidate is set whenever
+  // the reader returns a final status for any of its packetizers and
+  // reset whenever it returns FILE_STATUS_MOREDATA for this one.
+  int64_t end_of_data_candidate{-1}, end_of_data{-1};
+
+  bool finished{}, holding{}, end_reported{};
+
+  slot_t(generic_packetizer_c *p_ptzr)
+    : ptzr{p_ptzr}
+  {
+  }
+
+  int64_t
+  num_available_before_end_of_data()
+    const {
+    return finished                    ? end_of_data
+         : (0 <= end_of_data_candidate) ? end_of_data_candidate
+         :                                num_pushed;
+  }
+};
+
+reader_worker_c::reader_worker_c(generic_reader_c &reader)
+  : m_reader(reader)
+  , m_wanted_slot{}
+  , m_queued_bytes{}
+  , m_stop_requested{}
+  , m_finished{}
+  , m_progress{reader.get_progress()}
+{
+  for (auto ptzr : m_reader.m_reader_packetizers) {
+    m_slots.emplace_back(std::make_unique<slot_t>(ptzr));
+    m_slots_by_ptzr[ptzr] = m_slots.back().get();
+  }
+}
+
+reader_worker_c::~reader_worker_c() {
+  stop();
+}
+
+void
+reader_worker_c::start() {
+  m_thread = std::thread{[this]() { run(); }};
+}
+
+void
+reader_worker_c::stop() {
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_stop_requested = true;
+  }
+
+  m_cond_worker.notify_all();
+
+  if (m_thread.joinable())
+    m_thread.join();
+}
+
+bool
+reader_worker_c::is_worker_thread() {
+  return s_is_worker_thread;
+}
+
+int
+reader_worker_c::get_progress()
+  const {
+  return m_progress;
+}
+
+bool
+reader_worker_c::all_slots_finished()
+  const {
+  return std::all_of(m_slots.begin(), m_slots.end(), [](std::unique_ptr<slot_t> const &slot) { return slot->finished; });
+}
+
+reader_worker_c::slot_t *
+reader_worker_c::select_slot_to_read() {
+  if (m_wanted_slot && !m_wanted_slot->finished)
+    return m_wanted_slot;
+
+  if (m_queued_bytes >= s_max_queued_bytes)
+    return nullptr;
+
+  slot_t *selected = nullptr;
+
+  for (auto const &slot : m_slots)
+    if (   !slot->finished
+        && !slot->holding
+        && (slot->packets.size() < s_max_queued_packets)
+        && (!selected || (slot->packets.size() < selected->packets.size())))
+      selected = slot.get();
+
+  return selected;
+}
+
+void
+reader_worker_c::move_packets_from_packetizers() {
+  for (auto const &slot : m_slots)
+    while (slot->ptzr->packet_available()) {
+      auto packet = slot->ptzr->get_packet();
+      auto size   = static_cast<int64_t>(packet->data->get_size());
+
+      slot->ptzr->add_pipelined_bytes(size);
+      slot->packets.push_back(packet);
+      ++slot->num_pushed;
+      m_queued_bytes += size;
+    }
+}
+
+void
+reader_worker_c::handle_read_result(slot_t &slot,
+                                    file_status_e status) {
+  if (FILE_STATUS_HOLDING == status)
+    slot.holding = true;
+
+  else if (FILE_STATUS_MOREDATA == status)
+    slot.end_of_data_candidate = -1;
+
+  else {
+    // Packets queued from now on only exist due to the reader having
+    // reached the end of its data. Their packetizers would have been
+    // told so in serial mode.
+    for (auto const &other_slot : m_slots)
+      if (!other_slot->finished && (0 > other_slot->end_of_data_candidate))
+        other_slot->end_of_data_candidate = other_slot->num_pushed;
+
+    slot.finished    = true;
+    slot.end_of_data = slot.end_of_data_candidate;
+  }
+
+  move_packets_from_packetizers();
+}
+
+void
+reader_worker_c::run() {
+  s_is_worker_thread = true;
+
+  try {
+    while (true) {
+      slot_t *slot = nullptr;
+      auto force   = false;
+
+      {
+        std::unique_lock<std::mutex> lock{m_mutex};
+
+        m_cond_worker.wait(lock, [this, &slot]() -> bool {
+          if (m_stop_requested || all_slots_finished())
+            return true;
+          slot = select_slot_to_read();
+          return !!slot;
+        });
+
+        if (m_stop_requested || !slot)
+          break;
+
+        // The main thread cannot continue without a packet from this
+        // packetizer. Don't let the reader hold back.
+        force = (slot == m_wanted_slot) && slot->holding;
+      }
+
+      reading_section_c reading;
+      auto status = m_reader.read(slot->ptzr, force);
+      m_progress  = m_reader.get_progress();
+
+      {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        handle_read_result(*slot, status);
+      }
+
+      m_cond_main.notify_all();
+    }
+
+  } catch (...) {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_exception = std::current_exception();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_finished = true;
+  }
+
+  m_cond_main.notify_all();
+}
+
+file_status_e
+reader_worker_c::fetch(generic_packetizer_c *ptzr,
+                       packet_cptr &packet) {
+  std::unique_lock<std::mutex> lock{m_mutex};
+
+  auto &slot     = *m_slots_by_ptzr.at(ptzr);
+  auto take_next = [this, &slot, &packet]() {
+    packet = slot.packets.front();
+    slot.packets.pop_front();
+    ++slot.num_popped;
+
+    auto size       = static_cast<int64_t>(packet->data->get_size());
+    m_queued_bytes -= size;
+    slot.ptzr->add_pipelined_bytes(-size);
+
+    // Less data is queued now. Let the reader decide anew whether or
+    // not it has to hold back.
+    for (auto const &other_slot : m_slots)
+      other_slot->holding = false;
+
+    m_cond_worker.notify_all();
+  };
+
+  while (true) {
+    if (m_exception) {
+      m_wanted_slot = nullptr;
+      std::rethrow_exception(m_exception);
+    }
+
+    if (slot.num_popped < slot.num_available_before_end_of_data())
+      break;
+
+    if (slot.finished) {
+      // This is the point at which the serial mode would have called
+      // force_duration_on_last_packet().
+      if (!slot.end_reported && !slot.packets.empty())
+        slot.packets.back()->duration_mandatory = true;
+
+      slot.end_reported = true;
+      m_wanted_slot     = nullptr;
+
+      if (!slot.packets.empty())
+        take_next();
+
+      return FILE_STATUS_DONE;
+    }
+
+    if (slot.holding && slot.packets.empty()) {
+      slot.holding  = false;
+      m_wanted_slot = nullptr;
+      m_cond_worker.notify_all();
+
+      return FILE_STATUS_HOLDING;
+    }
+
+    if (m_finished) {
+      m_wanted_slot = nullptr;
+      return FILE_STATUS_DONE;
+    }
+
+    m_wanted_slot = &slot;
+    m_cond_worker.notify_all();
+    m_cond_main.wait(lock);
+  }
+
+  m_wanted_slot = nullptr;
+  take_next();
+
+  return FILE_STATUS_MOREDATA;
+}
@@ -0,0 +1,99 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   class definition for the reader worker thread
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_MERGE_READER_WORKER_H
+#define MTX_MERGE_READER_WORKER_H
+
+#include "common/common_pch.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "merge/file_status.h"
+#include "merge/packet.h"
+
+class generic_packetizer_c;
+class generic_reader_c;
+
+/* A reader worker runs a reader and all of its packetizers on a thread
+   of its own. Finished packets are moved from the packetizers into
+   bounded per-packetizer queues from which the main thread fetches
+   them via fetch().
+
+   The main thread must not be able to tell the difference between
+   reading in the worker and reading directly. Therefore fetch()
+   emulates the status transitions that pull_packetizers_for_packets()
+   would have observed in serial mode: a packet is only handed out
+   with FILE_STATUS_MOREDATA if it was available before the reader
+   signalled the end of its data for that packetizer, and the duration
+   of the last packet is forced at the same point in the stream at
+   which the serial mode would have forced it.
+
+   Readers and packetizers must not modify data the cluster helper
+   reads while packets are being muxed. Workers therefore only read
+   while holding a shared lock, and the main thread holds the
+   exclusive lock (see muxing_section_c) while it adds packets to the
+   cluster helper. */
+class reader_worker_c {
+protected:
+  struct slot_t;
+
+  generic_reader_c &m_reader;
+  std::vector<std::unique_ptr<slot_t>> m_slots;
+  std::unordered_map<generic_packetizer_c const *, slot_t *> m_slots_by_ptzr;
+
+  std::thread m_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_cond_worker, m_cond_main;
+
+  slot_t *m_wanted_slot;
+  int64_t m_queued_bytes;
+  bool m_stop_requested, m_finished;
+  std::exception_ptr m_exception;
+  std::atomic<int> m_progress;
+
+public:
+  // Blocks the worker threads for as long as an instance exists.
+  class muxing_section_c {
+  public:
+    muxing_section_c();
+    ~muxing_section_c();
+  };
+
+public:
+  reader_worker_c(generic_reader_c &reader);
+  ~reader_worker_c();
+
+  void start();
+  void stop();
+
+  file_status_e fetch(generic_packetizer_c *ptzr, packet_cptr &packet);
+  int get_progress() const;
+
+public:
+  static bool is_worker_thread();
+
+protected:
+  void run();
+  slot_t *select_slot_to_read();
+  void handle_read_result(slot_t &slot, file_status_e status);
+  void move_packets_from_packetizers();
+  bool all_slots_finished() const;
+};
+using reader_worker_cptr = std::shared_ptr<reader_worker_c>;
+
+#endif  // MTX_MERGE_READER_WORKER_H
@@ -164,6 +164,9 @@ public:
   std::map<int64_t, compression_method_e> m_compression_list; // As given on the cmd line
   compression_method_e m_compression; // For this very track
 
+  std::map<int64_t, int> m_compression_level_list; // As given on the cmd line
+  int m_compression_level;             // For this very track; -1 for the compressor's default
+
   std::map<int64_t, std::string> m_track_names; // As given on the command line
   std::string m_track_name;            // For this very track
 
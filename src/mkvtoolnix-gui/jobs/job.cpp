@@ -247,6 +247,12 @@ Job::outputFolder()
   return {};
 }
 
+QStringList
+Job::sourceFileNames()
+  const {
+  return {};
+}
+
 void
 Job::openOutputFolder()
   const {
@@ -95,6 +95,7 @@ public:
   virtual QString displayableType() const = 0;
   virtual QString displayableDescription() const = 0;
   virtual QString outputFolder() const;
+  virtual QStringList sourceFileNames() const;
 
   void setPendingAuto();
   void setPendingManual();
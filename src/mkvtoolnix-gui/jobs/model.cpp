@@ -2,8 +2,12 @@
 
 #include <QAbstractItemView>
 #include <QDebug>
+#include <QFileInfo>
 #include <QMutexLocker>
 #include <QSettings>
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 4, 0))
+# include <QStorageInfo>
+#endif
 #include <QTimer>
 
 #include "common/list_utils.h"
@@ -32,6 +36,7 @@ Model::Model(QObject *parent)
   , m_dontStartJobsNow{}
   , m_running{}
   , m_queueNumDone{}
+  , m_numDoneJobsRemovedFromToBeProcessed{}
 {
   retranslateUi();
 
@@ -212,8 +217,12 @@ Model::removeJobsIf(std::function<bool(Job const &)> predicate) {
     auto job = m_jobsById[idFromRow(row - 1)].get();
 
     if (predicate(*job)) {
+      if (m_toBeProcessed.contains(job) && mtx::included_in(job->status(), Job::DoneOk, Job::DoneWarnings, Job::Failed, Job::Aborted))
+        ++m_numDoneJobsRemovedFromToBeProcessed;
+
       job->removeQueueFile();
       m_jobsById.remove(job->id());
+      m_devicesByJobId.remove(job->id());
       toBeRemoved[job] = true;
       removeRow(row - 1);
     }
@@ -381,26 +390,43 @@ Model::startNextAutoJob() {
   if (!m_started)
     return;
 
-  Job *toStart = nullptr;
+  auto runningJobs = QList<Job *>{};
+  auto pendingJobs = QList<Job *>{};
+
   for (auto row = 0, numRows = rowCount(); row < numRows; ++row) {
     auto job = m_jobsById[idFromRow(row)].get();
 
     if (Job::Running == job->status())
-      return;
-    if (!toStart && (Job::PendingAuto == job->status()))
-      toStart = job;
+      runningJobs << job;
+    else if (Job::PendingAuto == job->status())
+      pendingJobs << job;
   }
 
-  if (toStart) {
-    MainWindow::watchCurrentJobTab()->connectToJob(*toStart);
+  // Only one job is started here. Starting it changes its status which
+  // causes this function to be called again for the next one.
+  if (runningJobs.count() < Util::Settings::get().m_maximumConcurrentJobs) {
+    for (auto const &toStart : pendingJobs) {
+      if (!canRunConcurrently(*toStart, runningJobs))
+        continue;
+
+      // The "current job" output tab shows the first job started while
+      // no other one is running. Other jobs' output can be viewed in
+      // their own tabs.
+      if (runningJobs.isEmpty())
+        MainWindow::watchCurrentJobTab()->connectToJob(*toStart);
 
-    toStart->start();
-    updateJobStats();
-    return;
+      toStart->start();
+      updateJobStats();
+      return;
+    }
   }
 
+  if (!runningJobs.isEmpty() || !pendingJobs.isEmpty())
+    return;
+
   // All jobs are done. Clear total progress.
   m_toBeProcessed.clear();
+  m_numDoneJobsRemovedFromToBeProcessed = 0;
   updateProgress();
   updateJobStats();
 
@@ -410,6 +436,65 @@ Model::startNextAutoJob() {
     emit queueStatusChanged(QueueStatus::Stopped);
 }
 
+// A job may only be run concurrently with the running ones if none of
+// them reads from or writes to one of its devices, unless the user has
+// turned that check off.
+bool
+Model::canRunConcurrently(Job const &job,
+                          QList<Job *> const &runningJobs) {
+  if (runningJobs.isEmpty() || !Util::Settings::get().m_avoidConcurrentJobsOnSameDevice)
+    return true;
+
+  auto const &devices = devicesForJob(job);
+
+  for (auto const &runningJob : runningJobs)
+    if (devicesForJob(*runningJob).intersects(devices))
+      return false;
+
+  return true;
+}
+
+QSet<QString> const &
+Model::devicesForJob(Job const &job) {
+  if (!m_devicesByJobId.contains(job.id())) {
+    auto &devices     = m_devicesByJobId[job.id()];
+    auto outputFolder = job.outputFolder();
+
+    for (auto const &fileName : job.sourceFileNames())
+      devices << deviceForFileName(fileName);
+
+    if (!outputFolder.isEmpty())
+      devices << deviceForFileName(outputFolder);
+  }
+
+  return m_devicesByJobId[job.id()];
+}
+
+QString
+Model::deviceForFileName(QString const &fileName) {
+  // Output files and folders might not exist yet. Use the closest
+  // parent folder that does.
+  auto path = QFileInfo{fileName}.absoluteFilePath();
+
+  while (!QFileInfo{path}.exists()) {
+    auto parent = QFileInfo{path}.path();
+    if (parent == path)
+      break;
+    path = parent;
+  }
+
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 4, 0))
+  auto storage = QStorageInfo{path};
+  if (storage.isValid())
+    return QString::fromLocal8Bit(storage.device());
+#endif
+
+  // Without information about the storage all files with the same
+  // root (e.g. the same drive letter on Windows) are assumed to be on
+  // the same device.
+  return path.section(Q("/"), 0, 0);
+}
+
 void
 Model::startJobImmediately(Job &job) {
   QMutexLocker locked{&m_mutex};
@@ -453,20 +538,30 @@ void
 Model::updateProgress() {
   QMutexLocker locked{&m_mutex};
 
-  if (!(m_toBeProcessed.count() + m_queueNumDone))
+  if (!(m_toBeProcessed.count() + m_queueNumDone + m_numDoneJobsRemovedFromToBeProcessed))
     return;
 
+  // Jobs that have finished since the queue was started are still
+  // contained in m_toBeProcessed and count as done unless they've
+  // been removed from the queue (e.g. by the automatic removal
+  // policy) in the meantime. Those are counted separately so that
+  // the total progress doesn't jump backwards. The progress of all
+  // running jobs is aggregated.
   auto numRunning       = 0;
+  auto numDone          = m_numDoneJobsRemovedFromToBeProcessed;
+  auto numTotal         = m_toBeProcessed.count() + m_numDoneJobsRemovedFromToBeProcessed;
   auto runningProgress  = 0;
 
   for (auto const &job : m_toBeProcessed)
     if (Job::Running == job->status()) {
       ++numRunning;
       runningProgress += job->progress();
-    }
+
+    } else if (mtx::included_in(job->status(), Job::DoneOk, Job::DoneWarnings, Job::Failed, Job::Aborted))
+      ++numDone;
 
   auto progress      = numRunning ? runningProgress / numRunning : 0u;
-  auto totalProgress = (m_queueNumDone * 100 + runningProgress) / (m_toBeProcessed.count() + m_queueNumDone);
+  auto totalProgress = numTotal ? (numDone * 100 + runningProgress) / numTotal : 100;
 
   emit progressChanged(progress, totalProgress);
 }
@@ -566,6 +661,7 @@ Model::loadJobs() {
 
   m_jobsById.clear();
   m_toBeProcessed.clear();
+  m_numDoneJobsRemovedFromToBeProcessed = 0;
   removeRows(0, rowCount());
 
   auto order       = Util::Settings::registry()->value("jobQueue/order").toStringList();
@@ -25,13 +25,14 @@ protected:
   QHash<uint64_t, JobPtr> m_jobsById;
   QSet<Job const *> m_toBeProcessed;
   QHash<uint64_t, bool> m_toBeRemoved;
+  QHash<uint64_t, QSet<QString>> m_devicesByJobId;
   QMutex m_mutex;
   QIcon m_warningsIcon, m_errorsIcon;
 
   bool m_started, m_dontStartJobsNow, m_running;
 
   QDateTime m_queueStartTime;
-  int m_queueNumDone;
+  int m_queueNumDone, m_numDoneJobsRemovedFromToBeProcessed;
 
 public:
   // labels << QY("Status") << QY("Description") << QY("Type") << QY("Progress") << QY("Date added") << QY("Date started") << QY("Date finished");
@@ -115,12 +116,16 @@ protected:
   void updateNumUnacknowledgedWarningsOrErrors();
 
   void processAutomaticJobRemoval(uint64_t id, Job::Status status);
+
+  bool canRunConcurrently(Job const &job, QList<Job *> const &runningJobs);
+  QSet<QString> const &devicesForJob(Job const &job);
   void scheduleJobForRemoval(uint64_t id);
 
   QList<Job *> selectedJobs(QAbstractItemView *view);
 
 public:
   static void convertJobQueueToSeparateIniFiles();
+  static QString deviceForFileName(QString const &fileName);
 };
 
 }}}
@@ -164,6 +164,27 @@ MuxJob::outputFolder()
   return info.dir().path();
 }
 
+QStringList
+MuxJob::sourceFileNames()
+  const {
+  auto fileNames = QStringList{};
+
+  for (auto const &file : m_config->m_files) {
+    fileNames << file->m_fileName;
+
+    for (auto const &additionalPart : file->m_additionalParts)
+      fileNames << additionalPart->m_fileName;
+
+    for (auto const &appendedFile : file->m_appendedFiles)
+      fileNames << appendedFile->m_fileName;
+
+    for (auto const &playlistFile : file->m_playlistFiles)
+      fileNames << playlistFile.filePath();
+  }
+
+  return fileNames;
+}
+
 void
 MuxJob::saveJobInternal(Util::ConfigFile &settings)
   const {
@@ -43,6 +43,7 @@ public:
   virtual QString displayableType() const override;
   virtual QString displayableDescription() const override;
   virtual QString outputFolder() const override;
+  virtual QStringList sourceFileNames() const override;
 
   virtual Merge::MuxConfig const &config() const;
 
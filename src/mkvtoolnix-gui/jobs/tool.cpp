@@ -136,6 +136,7 @@ Tool::setupActions() {
   connect(ui->jobs,                                         &Util::BasicTreeView::deletePressed,              this,    &Tool::onRemove);
 
   connect(mw,                                               &MainWindow::preferencesChanged,                  this,    &Tool::retranslateUi);
+  connect(mw,                                               &MainWindow::preferencesChanged,                  m_model, &Model::startNextAutoJob);
   connect(mw,                                               &MainWindow::aboutToClose,                        m_model, &Model::saveJobs);
 
   connect(MainWindow::watchCurrentJobTab(),                 &WatchJobs::Tab::watchCurrentJobTabCleared,       m_model, &Model::resetTotalProgress);
@@ -25,6 +25,7 @@
 # include "mkvtoolnix-gui/main_window/taskbar_progress.h"
 #endif
 #include "mkvtoolnix-gui/merge/tool.h"
+#include "mkvtoolnix-gui/util/file_identifier.h"
 #include "mkvtoolnix-gui/util/message_box.h"
 #include "mkvtoolnix-gui/util/moving_pixmap_overlay.h"
 #include "mkvtoolnix-gui/util/settings.h"
@@ -123,6 +124,7 @@ MainWindow::setupMenu() {
   connect(ui->actionHelpReportBug,             &QAction::triggered,             this, &MainWindow::visitHelpURL);
 
   connect(this,                                &MainWindow::preferencesChanged, this, &MainWindow::setToolSelectorVisibility);
+  connect(this,                                &MainWindow::preferencesChanged,       &Util::FileIdentifier::clearCache);
 
 #if defined(HAVE_CURL_EASY_H)
   connect(ui->actionHelpCheckForUpdates,       &QAction::triggered,             this, &MainWindow::checkForUpdates);
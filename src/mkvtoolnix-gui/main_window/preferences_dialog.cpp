@@ -55,6 +55,8 @@ PreferencesDialog::PreferencesDialog(QWidget *parent)
   ui->cbGuiResetJobWarningErrorCountersOnExit->setChecked(m_cfg.m_resetJobWarningErrorCountersOnExit);
   ui->cbGuiRemoveOldJobs->setChecked(m_cfg.m_removeOldJobs);
   ui->sbGuiRemoveOldJobsDays->setValue(m_cfg.m_removeOldJobsDays);
+  ui->sbGuiMaximumConcurrentJobs->setValue(m_cfg.m_maximumConcurrentJobs);
+  ui->cbGuiAvoidConcurrentJobsOnSameDevice->setChecked(m_cfg.m_avoidConcurrentJobsOnSameDevice);
   adjustRemoveOldJobsControls();
   setupJobRemovalPolicy();
 
@@ -200,6 +202,11 @@ PreferencesDialog::setupToolTips() {
   Util::setToolTip(ui->cbGuiResetJobWarningErrorCountersOnExit, QY("If enabled the warning and error counters of all jobs and the global counters in the status bar will be reset to 0 when the program exits."));
   Util::setToolTip(ui->cbGuiRemoveOldJobs,                      QY("If enabled the GUI will remove completed jobs older than the configured number of days no matter their status on exit."));
   Util::setToolTip(ui->sbGuiRemoveOldJobsDays,                  QY("If enabled the GUI will remove completed jobs older than the configured number of days no matter their status on exit."));
+  Util::setToolTip(ui->sbGuiMaximumConcurrentJobs,              QY("The number of jobs from the queue that are run at the same time."));
+  Util::setToolTip(ui->cbGuiAvoidConcurrentJobsOnSameDevice,
+                   Q("%1 %2")
+                   .arg(QY("If enabled a job will only be started while other jobs are running if none of them reads from or writes to the same device."))
+                   .arg(QY("Running several jobs on the same hard disk is usually slower than running them one after the other.")));
 
   Util::setToolTip(ui->cbGuiRemoveJobs,
                    Q("%1 %2")
@@ -589,6 +596,8 @@ PreferencesDialog::save() {
   m_cfg.m_jobRemovalPolicy                   = static_cast<Util::Settings::JobRemovalPolicy>(idx);
   m_cfg.m_removeOldJobs                      = ui->cbGuiRemoveOldJobs->isChecked();
   m_cfg.m_removeOldJobsDays                  = ui->sbGuiRemoveOldJobsDays->value();
+  m_cfg.m_maximumConcurrentJobs              = ui->sbGuiMaximumConcurrentJobs->value();
+  m_cfg.m_avoidConcurrentJobsOnSameDevice    = ui->cbGuiAvoidConcurrentJobsOnSameDevice->isChecked();
 
   m_cfg.m_chapterNameTemplate                = ui->leCENameTemplate->text();
   m_cfg.m_defaultChapterLanguage             = ui->cbCEDefaultLanguage->currentData().toString();
@@ -7,6 +7,7 @@
 #include <QList>
 #include <QMenu>
 #include <QMessageBox>
+#include <QPersistentModelIndex>
 #include <QProcess>
 #include <QRegularExpression>
 #include <QSettings>
@@ -1079,17 +1080,44 @@ Tab::addOrAppendFiles(bool append,
     Util::Settings::get().m_lastOpenDir = QFileInfo{fileNames.last()}.path();
 
   auto toIdentify = handleDroppedSpecialFiles(fileNames);
+  if (toIdentify.isEmpty())
+    return;
+
+  // Files are identified in the background. When adding they're put
+  // into the model one by one as soon as their results are available
+  // (in the order they were given in). Appended files all go to the
+  // same source file and are therefore added in one go once all of
+  // them have been identified.
+  auto identifier = new Util::AsyncFileIdentifier{this, toIdentify};
+
+  if (append) {
+    auto identifiedFiles = std::make_shared<QList<SourceFilePtr>>();
+    auto fileToAppendTo  = QPersistentModelIndex{sourceFileIdx};
 
-  QList<SourceFilePtr> identifiedFiles;
-  for (auto &fileName : toIdentify) {
-    Util::FileIdentifier identifier{ this, fileName };
-    if (identifier.identify())
-      identifiedFiles << identifier.file();
+    connect(identifier, &Util::AsyncFileIdentifier::fileIdentified, this, [identifiedFiles](SourceFilePtr const &file) {
+      *identifiedFiles << file;
+    });
+
+    connect(identifier, &Util::AsyncFileIdentifier::finished, this, [this, identifier, identifiedFiles, fileToAppendTo]() {
+      addOrAppendIdentifiedFiles(true, *identifiedFiles, fileToAppendTo);
+      identifier->deleteLater();
+    });
+
+  } else {
+    connect(identifier, &Util::AsyncFileIdentifier::fileIdentified, this, [this](SourceFilePtr const &file) {
+      addOrAppendIdentifiedFiles(false, PlaylistScanner{this}.checkAddingPlaylists(QList<SourceFilePtr>{} << file), QModelIndex{});
+    });
+
+    connect(identifier, &Util::AsyncFileIdentifier::finished, identifier, &Util::AsyncFileIdentifier::deleteLater);
   }
 
-  if (!append)
-    identifiedFiles = PlaylistScanner{this}.checkAddingPlaylists(identifiedFiles);
+  identifier->start();
+}
 
+void
+Tab::addOrAppendIdentifiedFiles(bool append,
+                                QList<SourceFilePtr> const &identifiedFiles,
+                                QModelIndex const &sourceFileIdx) {
   if (identifiedFiles.isEmpty())
     return;
 
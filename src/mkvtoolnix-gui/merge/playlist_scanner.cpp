@@ -6,8 +6,8 @@
 #include "mkvtoolnix-gui/util/file_identifier.h"
 #include "mkvtoolnix-gui/util/settings.h"
 
-#include <QApplication>
 #include <QDir>
+#include <QEventLoop>
 #include <QFileInfo>
 #include <QProgressDialog>
 #include <QString>
@@ -80,24 +80,37 @@ PlaylistScanner::scanForPlaylists(QFileInfoList const &otherFiles)
   QProgressDialog progress{ QY("Scanning directory"), QY("Cancel"), 0, otherFiles.size(), m_parent };
   progress.setWindowModality(Qt::ApplicationModal);
 
-  auto identifiedFiles = QList<SourceFilePtr>{};
-  auto numScanned      = 0u;
+  auto fileNames = QStringList{};
+  for (auto const &otherFile : otherFiles)
+    fileNames << otherFile.filePath();
 
-  for (auto const &otherFile : otherFiles) {
+  auto identifiedFiles = QList<SourceFilePtr>{};
+  auto minimumDuration = Util::Settings::get().m_minimumPlaylistDuration * 1000000000ull;
+  auto updateProgress  = [&progress, &otherFiles](int numScanned) {
     progress.setLabelText(QNY("%1 of %2 file processed", "%1 of %2 files processed", otherFiles.size()).arg(numScanned).arg(otherFiles.size()));
-    progress.setValue(numScanned++);
-
-    qApp->processEvents();
-    if (progress.wasCanceled())
-      return QList<SourceFilePtr>{};
+    progress.setValue(numScanned);
+  };
+
+  // The files are identified in parallel; the local event loop keeps
+  // the progress dialog responsive until all of them are done.
+  Util::AsyncFileIdentifier identifier{m_parent, fileNames};
+  QEventLoop loop;
+
+  QObject::connect(&identifier, &Util::AsyncFileIdentifier::fileProcessed, updateProgress);
+  QObject::connect(&identifier, &Util::AsyncFileIdentifier::finished,      &loop, &QEventLoop::quit);
+  QObject::connect(&progress,   &QProgressDialog::canceled,                &loop, &QEventLoop::quit);
+  QObject::connect(&identifier, &Util::AsyncFileIdentifier::fileIdentified, [&identifiedFiles, minimumDuration](SourceFilePtr const &file) {
+    if (file->isPlaylist() && (file->m_playlistDuration >= minimumDuration))
+      identifiedFiles << file;
+  });
 
-    Util::FileIdentifier identifier{m_parent, otherFile.filePath()};
-    if (!identifier.identify())
-      continue;
+  updateProgress(0);
+  identifier.start();
+  loop.exec();
 
-    auto file = identifier.file();
-    if (file->isPlaylist() && (file->m_playlistDuration >= (Util::Settings::get().m_minimumPlaylistDuration * 1000000000ull)))
-      identifiedFiles << file;
+  if (progress.wasCanceled()) {
+    identifier.cancel();
+    return QList<SourceFilePtr>{};
   }
 
   progress.setValue(otherFiles.size());
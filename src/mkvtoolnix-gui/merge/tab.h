@@ -253,6 +253,7 @@ protected:
   virtual QStringList selectAttachmentsToAdd();
   virtual void addOrAppendFiles(bool append);
   virtual void addOrAppendFiles(bool append, QStringList const &fileNames, QModelIndex const &sourceFileIdx);
+  virtual void addOrAppendIdentifiedFiles(bool append, QList<SourceFilePtr> const &identifiedFiles, QModelIndex const &sourceFileIdx);
   virtual void setDefaultsFromSettingsForAddedFiles(QList<SourceFilePtr> const &files);
   virtual QStringList handleDroppedSpecialFiles(QStringList const &fileNames);
   virtual void enableFilesActions();
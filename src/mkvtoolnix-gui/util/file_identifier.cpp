@@ -1,11 +1,19 @@
 #include "common/common_pch.h"
 
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QHash>
 #include <QMessageBox>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QRegularExpression>
+#include <QRunnable>
 #include <QStringList>
+#include <QThreadPool>
+#include <QVector>
 
 #include "common/json.h"
 #include "common/qt.h"
@@ -23,17 +31,69 @@ class FileIdentifierPrivate {
 
   QWidget *m_parent{};
   int m_exitCode{};
+  bool m_processError{};
   QStringList m_output;
-  QString m_fileName;
+  QString m_fileName, m_mkvmergeExe;
+  bool m_keepLastChapterInMpls{};
   mtx::gui::Merge::SourceFilePtr m_file;
 
   explicit FileIdentifierPrivate(QWidget *parent, QString const &fileName)
     : m_parent{parent}
     , m_fileName{fileName}
   {
+    // Settings must only be read on the GUI thread; runMkvmerge() may
+    // run on a worker thread.
+    auto &cfg               = Settings::get();
+    m_mkvmergeExe           = cfg.actualMkvmergeExe();
+    m_keepLastChapterInMpls = cfg.m_defaultAdditionalMergeOptions.contains(Q("keep_last_chapter_in_mpls"));
   }
 };
 
+namespace {
+
+struct CachedResult {
+  int m_exitCode;
+  QStringList m_output;
+};
+
+// Identification results keyed on the file's path, size and
+// modification time as well as on the mkvmerge executable used. Only
+// mkvmerge's output is stored so that each user gets its own freshly
+// parsed SourceFile. The cache is cleared whenever the preferences
+// change.
+QMutex s_cacheMutex;
+QHash<QString, CachedResult> s_cache;
+int const s_maxCacheEntries = 2000;
+
+QString
+cacheKey(QString const &fileName,
+         QString const &mkvmergeExe,
+         bool keepLastChapterInMpls) {
+  auto info = QFileInfo{fileName};
+  if (!info.exists())
+    return QString{};
+
+  // Replacing mkvmerge with another version changes its modification
+  // time.
+  auto exeInfo = QFileInfo{mkvmergeExe};
+
+  return Q("%1|%2|%3|%4|%5|%6")
+    .arg(info.absoluteFilePath())
+    .arg(info.size())
+    .arg(info.lastModified().toMSecsSinceEpoch())
+    .arg(exeInfo.absoluteFilePath())
+    .arg(exeInfo.lastModified().toMSecsSinceEpoch())
+    .arg(keepLastChapterInMpls ? 1 : 0);
+}
+
+QThreadPool &
+identificationThreadPool() {
+  static QThreadPool s_pool;
+  return s_pool;
+}
+
+}
+
 using namespace mtx::gui;
 
 FileIdentifier::FileIdentifier(QWidget *parent,
@@ -47,31 +107,84 @@ FileIdentifier::~FileIdentifier() {
 
 bool
 FileIdentifier::identify() {
+  runMkvmerge();
+  return parseResult();
+}
+
+// Doesn't touch any GUI element and can therefore be run on a worker
+// thread.
+bool
+FileIdentifier::runMkvmerge() {
   Q_D(FileIdentifier);
 
+  d->m_processError = false;
+  d->m_exitCode     = 0;
+  d->m_output.clear();
+
   if (d->m_fileName.isEmpty())
     return false;
 
-  auto &cfg = Settings::get();
+  auto key = cacheKey(d->m_fileName, d->m_mkvmergeExe, d->m_keepLastChapterInMpls);
+
+  if (!key.isEmpty()) {
+    QMutexLocker locked{&s_cacheMutex};
+
+    auto itr = s_cache.constFind(key);
+    if (itr != s_cache.constEnd()) {
+      d->m_exitCode = itr->m_exitCode;
+      d->m_output   = itr->m_output;
+      return true;
+    }
+  }
 
   auto args = QStringList{} << "--output-charset" << "utf-8" << "--identification-format" << "json" << "--identify" << d->m_fileName;
 
-  if (cfg.m_defaultAdditionalMergeOptions.contains(Q("keep_last_chapter_in_mpls")))
+  if (d->m_keepLastChapterInMpls)
     args << "--engage" << "keep_last_chapter_in_mpls";
 
-  auto process  = Process::execute(cfg.actualMkvmergeExe(), args);
+  auto process  = Process::execute(d->m_mkvmergeExe, args);
   d->m_exitCode = process->process().exitCode();
 
   if (process->hasError()) {
-    Util::MessageBox::critical(d->m_parent)->title(QY("Error executing mkvmerge")).text(QY("The mkvmerge executable was not found.")).exec();
+    d->m_processError = true;
     return false;
   }
 
   d->m_output = process->output();
 
+  if (!key.isEmpty()) {
+    QMutexLocker locked{&s_cacheMutex};
+
+    if (s_cache.size() >= s_maxCacheEntries)
+      s_cache.clear();
+
+    s_cache.insert(key, CachedResult{ d->m_exitCode, d->m_output });
+  }
+
+  return true;
+}
+
+bool
+FileIdentifier::parseResult() {
+  Q_D(FileIdentifier);
+
+  if (d->m_fileName.isEmpty())
+    return false;
+
+  if (d->m_processError) {
+    Util::MessageBox::critical(d->m_parent)->title(QY("Error executing mkvmerge")).text(QY("The mkvmerge executable was not found.")).exec();
+    return false;
+  }
+
   return parseOutput();
 }
 
+void
+FileIdentifier::clearCache() {
+  QMutexLocker locked{&s_cacheMutex};
+  s_cache.clear();
+}
+
 QString const &
 FileIdentifier::fileName()
   const {
@@ -279,4 +392,184 @@ FileIdentifier::parseTrack(QVariantMap const &obj) {
   track->setDefaults();
 }
 
+// ------------------------------------------------------------
+
+namespace {
+
+// State shared between an AsyncFileIdentifier and its runnables. The
+// receiver is reset when the AsyncFileIdentifier is destroyed so that
+// runnables still in the pool don't post to a deleted object.
+struct AsyncIdentificationState {
+  QMutex m_mutex;
+  QObject *m_receiver{};
+  bool m_cancelled{};
+};
+
+using AsyncIdentificationStatePtr = std::shared_ptr<AsyncIdentificationState>;
+
+class IdentificationRunnable: public QRunnable {
+private:
+  std::shared_ptr<FileIdentifier> m_identifier;
+  AsyncIdentificationStatePtr m_state;
+  int m_idx;
+
+public:
+  IdentificationRunnable(std::shared_ptr<FileIdentifier> const &identifier,
+                         AsyncIdentificationStatePtr const &state,
+                         int idx)
+    : m_identifier{identifier}
+    , m_state{state}
+    , m_idx{idx}
+  {
+  }
+
+  virtual void
+  run() override {
+    {
+      QMutexLocker locked{&m_state->m_mutex};
+      if (m_state->m_cancelled)
+        return;
+    }
+
+    m_identifier->runMkvmerge();
+
+    QMutexLocker locked{&m_state->m_mutex};
+    if (!m_state->m_cancelled && m_state->m_receiver)
+      QMetaObject::invokeMethod(m_state->m_receiver, "onMkvmergeFinished", Qt::QueuedConnection, Q_ARG(int, m_idx));
+  }
+};
+
+}
+
+class AsyncFileIdentifierPrivate {
+  friend class AsyncFileIdentifier;
+
+  QWidget *m_parent{};
+  QList<std::shared_ptr<FileIdentifier>> m_identifiers;
+  QVector<bool> m_mkvmergeFinished;
+  int m_numProcessed{}, m_nextToEmit{};
+  bool m_emitting{}, m_finished{};
+  AsyncIdentificationStatePtr m_state;
+
+  explicit AsyncFileIdentifierPrivate(QWidget *parent, QStringList const &fileNames)
+    : m_parent{parent}
+    , m_mkvmergeFinished(fileNames.size(), false)
+    , m_state{std::make_shared<AsyncIdentificationState>()}
+  {
+    for (auto const &fileName : fileNames)
+      m_identifiers << std::make_shared<FileIdentifier>(parent, fileName);
+  }
+};
+
+AsyncFileIdentifier::AsyncFileIdentifier(QWidget *parent,
+                                         QStringList const &fileNames)
+  : QObject{parent}
+  , d_ptr{new AsyncFileIdentifierPrivate{parent, fileNames}}
+{
+  Q_D(AsyncFileIdentifier);
+
+  d->m_state->m_receiver = this;
+}
+
+AsyncFileIdentifier::AsyncFileIdentifier(AsyncFileIdentifierPrivate &d,
+                                         QWidget *parent)
+  : QObject{parent}
+  , d_ptr{&d}
+{
+  d.m_state->m_receiver = this;
+}
+
+AsyncFileIdentifier::~AsyncFileIdentifier() {
+  Q_D(AsyncFileIdentifier);
+
+  QMutexLocker locked{&d->m_state->m_mutex};
+  d->m_state->m_receiver  = nullptr;
+  d->m_state->m_cancelled = true;
+}
+
+void
+AsyncFileIdentifier::start() {
+  Q_D(AsyncFileIdentifier);
+
+  if (d->m_identifiers.isEmpty()) {
+    QMetaObject::invokeMethod(this, "finished", Qt::QueuedConnection);
+    return;
+  }
+
+  auto &pool = identificationThreadPool();
+
+  for (auto idx = 0, numFiles = d->m_identifiers.size(); idx < numFiles; ++idx)
+    pool.start(new IdentificationRunnable{d->m_identifiers[idx], d->m_state, idx});
+}
+
+void
+AsyncFileIdentifier::cancel() {
+  Q_D(AsyncFileIdentifier);
+
+  QMutexLocker locked{&d->m_state->m_mutex};
+  d->m_state->m_cancelled = true;
+}
+
+int
+AsyncFileIdentifier::numFiles()
+  const {
+  Q_D(const AsyncFileIdentifier);
+
+  return d->m_identifiers.size();
+}
+
+int
+AsyncFileIdentifier::numProcessed()
+  const {
+  Q_D(const AsyncFileIdentifier);
+
+  return d->m_numProcessed;
+}
+
+void
+AsyncFileIdentifier::onMkvmergeFinished(int idx) {
+  Q_D(AsyncFileIdentifier);
+
+  if ((0 > idx) || (idx >= d->m_identifiers.size()) || d->m_mkvmergeFinished[idx])
+    return;
+
+  d->m_mkvmergeFinished[idx] = true;
+  ++d->m_numProcessed;
+
+  emit fileProcessed(d->m_numProcessed);
+
+  emitFinishedFiles();
+}
+
+void
+AsyncFileIdentifier::emitFinishedFiles() {
+  Q_D(AsyncFileIdentifier);
+
+  // Parsing may show message boxes, and receivers may open dialogs;
+  // both spin nested event loops that can deliver further results.
+  // Only the outermost call emits so that the order is kept.
+  if (d->m_emitting)
+    return;
+
+  d->m_emitting = true;
+
+  while ((d->m_nextToEmit < d->m_identifiers.size()) && d->m_mkvmergeFinished[d->m_nextToEmit]) {
+    auto identifier = d->m_identifiers[d->m_nextToEmit++];
+
+    if (identifier->parseResult())
+      emit fileIdentified(identifier->file());
+
+    // Release the output as early as possible.
+    d->m_identifiers[d->m_nextToEmit - 1].reset();
+  }
+
+  d->m_emitting = false;
+
+  if ((d->m_nextToEmit < d->m_identifiers.size()) || d->m_finished)
+    return;
+
+  d->m_finished = true;
+  emit finished();
+}
+
 }}}
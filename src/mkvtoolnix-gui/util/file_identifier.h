@@ -28,6 +28,8 @@ public:
   virtual ~FileIdentifier();
 
   virtual bool identify();
+  virtual bool runMkvmerge();
+  virtual bool parseResult();
 
   virtual QString const &fileName() const;
   virtual void setFileName(QString const &fileName);
@@ -45,6 +47,46 @@ protected:
   virtual void parseGlobalTags(QVariantMap const &obj);
   virtual void parseTrackTags(QVariantMap const &obj);
   virtual void parseTrack(QVariantMap const &obj);
+
+public:
+  static void clearCache();
+};
+
+// Identifies several files on a pool of worker threads. Only running
+// mkvmerge happens in the background; parsing its output and showing
+// error messages is done on the GUI thread. fileIdentified() is
+// emitted in the order the file names were given in.
+class AsyncFileIdentifierPrivate;
+class AsyncFileIdentifier: public QObject {
+  Q_OBJECT;
+
+protected:
+  Q_DECLARE_PRIVATE(AsyncFileIdentifier);
+
+  QScopedPointer<AsyncFileIdentifierPrivate> const d_ptr;
+
+  explicit AsyncFileIdentifier(AsyncFileIdentifierPrivate &d, QWidget *parent);
+
+public:
+  AsyncFileIdentifier(QWidget *parent, QStringList const &fileNames);
+  virtual ~AsyncFileIdentifier();
+
+  virtual void start();
+  virtual void cancel();
+
+  virtual int numFiles() const;
+  virtual int numProcessed() const;
+
+signals:
+  void fileIdentified(mtx::gui::Merge::SourceFilePtr const &file);
+  void fileProcessed(int numProcessed);
+  void finished();
+
+protected slots:
+  void onMkvmergeFinished(int idx);
+
+protected:
+  virtual void emitFinishedFiles();
 };
 
 }}}
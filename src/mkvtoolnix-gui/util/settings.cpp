@@ -209,6 +209,8 @@ Settings::load() {
   m_jobRemovalPolicy                   = static_cast<JobRemovalPolicy>(reg.value("jobRemovalPolicy", static_cast<int>(JobRemovalPolicy::Never)).toInt());
   m_removeOldJobs                      = reg.value("removeOldJobs",                                  true).toBool();
   m_removeOldJobsDays                  = reg.value("removeOldJobsDays",                              14).toInt();
+  m_maximumConcurrentJobs              = std::max(reg.value("maximumConcurrentJobs",                 1).toInt(), 1);
+  m_avoidConcurrentJobsOnSameDevice    = reg.value("avoidConcurrentJobsOnSameDevice",                true).toBool();
 
   m_disableAnimations                  = reg.value("disableAnimations", false).toBool();
   m_showToolSelector                   = reg.value("showToolSelector", true).toBool();
@@ -371,6 +373,8 @@ Settings::save()
   reg.setValue("jobRemovalPolicy",                   static_cast<int>(m_jobRemovalPolicy));
   reg.setValue("removeOldJobs",                      m_removeOldJobs);
   reg.setValue("removeOldJobsDays",                  m_removeOldJobsDays);
+  reg.setValue("maximumConcurrentJobs",              m_maximumConcurrentJobs);
+  reg.setValue("avoidConcurrentJobsOnSameDevice",    m_avoidConcurrentJobsOnSameDevice);
 
   reg.setValue("disableAnimations",                  m_disableAnimations);
   reg.setValue("showToolSelector",                   m_showToolSelector);
@@ -126,7 +126,8 @@ public:
 
   JobRemovalPolicy m_jobRemovalPolicy;
   bool m_removeOldJobs;
-  int m_removeOldJobsDays;
+  int m_removeOldJobsDays, m_maximumConcurrentJobs;
+  bool m_avoidConcurrentJobsOnSameDevice;
   bool m_useDefaultJobDescription, m_showOutputOfAllJobs, m_switchToJobOutputAfterStarting, m_resetJobWarningErrorCountersOnExit;
 
   bool m_checkForUpdates;
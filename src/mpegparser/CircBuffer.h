@@ -90,6 +90,18 @@ public:
     return read_ptr;
   }
 
+  //Returns a pointer to the byte at position i and the number of bytes
+  //that can be accessed from there on without wrapping around.
+  const binary* GetContiguousPtr(uint32_t i, uint32_t &numBytes){
+    uint32_t bbw = bytes_before_wrap_read();
+    if(i < bbw){
+      numBytes = std::min(bbw, bytes_in_buf) - i;
+      return read_ptr + i;
+    }
+    numBytes = bytes_in_buf - i;
+    return m_buf + (i - bbw);
+  }
+
   binary& operator[](unsigned int i){
     if(i > bytes_in_buf){
       return read_ptr[0];
@@ -25,6 +25,8 @@
 #include "MPEGVideoBuffer.h"
 #include <cstring>
 
+#include "common/mpeg.h"
+
 MPEG2SequenceHeader::MPEG2SequenceHeader() {
   memset(this, 0, sizeof(*this));
 }
@@ -44,29 +46,52 @@ int32_t MPEGVideoBuffer::FindStartCode(uint32_t startPos){
   if(window < 4) //Make sure we have enough bytes to search.
     return -1;
 
-  for(unsigned int i = startPos; i < (startPos + window - 3); i++){
-    CircBuffer& buf = *myBuffer;
-    binary a,b,c,d;
-    a = buf[i];
-    b = buf[i+1];
-    c = buf[i+2];
-    d = buf[i+3];
-    if((a == 0x00) && (b == 0x00) && (c == 0x01)){
-      switch(d){
-        case MPEG_VIDEO_SEQUENCE_START_CODE:
-        case MPEG_VIDEO_GOP_START_CODE:
-        case MPEG_VIDEO_PICTURE_START_CODE:
-          return i;  //Return our position if we found
-          //one of the codes we want
+  uint32_t end = startPos + window;
+  uint32_t i = startPos;
+  CircBuffer& buf = *myBuffer;
 
-      }
+  while(i < (end - 3)){
+    uint32_t contiguous;
+    const binary* ptr = buf.GetContiguousPtr(i, contiguous);
+    contiguous = std::min(contiguous, end - i);
+
+    if(contiguous < 4){
+      //Start codes wrapping around the end of the buffer are checked
+      //byte by byte.
+      if((buf[i] == 0x00) && (buf[i+1] == 0x00) && (buf[i+2] == 0x01) && IsWantedStartCode(buf[i+3]))
+        return i;
+      i++;
+      continue;
+    }
+
+    //The last byte of the contiguous region is only needed as the
+    //start code's type.
+    const binary* found = mtx::mpeg::find_start_code(ptr, ptr + contiguous - 1);
+    if(found == (ptr + contiguous - 1)){
+      i += contiguous - 3;
+      continue;
     }
+
+    if(IsWantedStartCode(found[3]))
+      return i + (found - ptr);  //Return our position if we found
+                                 //one of the codes we want
+    i += (found - ptr) + 1;
   }
 
   //If we get here we have no _wanted_ start code found.
   return -1;
 }
 
+bool MPEGVideoBuffer::IsWantedStartCode(binary type){
+  switch(type){
+    case MPEG_VIDEO_SEQUENCE_START_CODE:
+    case MPEG_VIDEO_GOP_START_CODE:
+    case MPEG_VIDEO_PICTURE_START_CODE:
+      return true;
+  }
+  return false;
+}
+
 void MPEGVideoBuffer::UpdateState(){
   assert(myBuffer);
   int32_t test = 0;
@@ -135,6 +135,7 @@ private:
   int32_t chunkEnd;
   void UpdateState();
   int32_t FindStartCode(uint32_t startPos = 0);
+  bool IsWantedStartCode(binary type);
 public:
   MPEGVideoBuffer(uint32_t size){
     myBuffer = new CircBuffer(size);
@@ -156,7 +156,7 @@ dts_packetizer_c::process_available_packets() {
     auto samples_in_packet = header_and_packet.first.get_packet_length_in_core_samples();
     auto new_timecode      = m_timestamp_calculator.get_next_timecode(samples_in_packet);
 
-    add_packet(std::make_shared<packet_t>(header_and_packet.second, new_timecode.to_ns(), header_and_packet.first.get_packet_length_in_nanoseconds().to_ns()));
+    add_packet(packet_t::create(header_and_packet.second, new_timecode.to_ns(), header_and_packet.first.get_packet_length_in_nanoseconds().to_ns()));
   }
 
   m_queued_packets.clear();
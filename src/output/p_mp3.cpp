@@ -188,7 +188,7 @@ mp3_packetizer_c::process(packet_cptr packet) {
 
   while ((mp3_packet = get_mp3_packet(&mp3header))) {
     auto new_timecode = m_timestamp_calculator.get_next_timecode(m_samples_per_frame);
-    auto packet       = std::make_shared<packet_t>(memory_c::clone(mp3_packet, mp3header.framesize), new_timecode.to_ns(), m_packet_duration);
+    auto packet       = packet_t::create(memory_c::clone(mp3_packet, mp3header.framesize), new_timecode.to_ns(), m_packet_duration);
 
     packet->add_extensions(m_packet_extensions);
 
@@ -304,4 +304,83 @@ TEST(BitReader, ExceptionOnReadingBeyondEOF) {
   EXPECT_THROW(b.get_bytes(target, 2), mtx::mm_io::end_of_file_x);
 }
 
+void
+put_unsigned_golomb(bit_writer_c &w,
+                    unsigned int value) {
+  auto code   = value + 1;
+  auto length = 0u;
+
+  while ((code >> length) > 1)
+    ++length;
+
+  w.put_bits(length, 0);
+  w.put_bits(length + 1, code);
+}
+
+void
+put_signed_golomb(bit_writer_c &w,
+                  int value) {
+  put_unsigned_golomb(w, 0 < value ? 2 * value - 1 : -2 * value);
+}
+
+TEST(BitReader, GolombCodesAcrossCacheRefills) {
+  std::vector<unsigned char> buffer(4096, 0);
+  auto w = bit_writer_c{buffer.data(), buffer.size()};
+
+  auto values = std::vector<unsigned int>{};
+  for (auto idx = 0u; idx < 600; ++idx)
+    values.push_back(((idx * 2654435761u) >> (idx % 31)) & 0xfffff);
+
+  for (auto idx = 0u; idx < values.size(); ++idx) {
+    put_unsigned_golomb(w, values[idx]);
+    put_signed_golomb(w, idx % 2 ? -static_cast<int>(idx) : static_cast<int>(idx));
+    w.put_bits(idx % 9, idx);
+  }
+
+  auto num_bytes = (w.get_bit_position() + 7) / 8;
+  auto b         = bit_reader_c{buffer.data(), static_cast<std::size_t>(num_bytes)};
+
+  for (auto idx = 0u; idx < values.size(); ++idx) {
+    ASSERT_EQ(values[idx], static_cast<unsigned int>(b.get_unsigned_golomb())) << "index " << idx;
+    ASSERT_EQ(idx % 2 ? -static_cast<int>(idx) : static_cast<int>(idx), b.get_signed_golomb()) << "index " << idx;
+    ASSERT_EQ(idx & ((1u << (idx % 9)) - 1), b.get_bits(idx % 9)) << "index " << idx;
+  }
+
+  EXPECT_LT(b.get_remaining_bits(), 8);
+}
+
+TEST(BitReader, GolombCodesAtEndOfData) {
+  unsigned char value[2];
+
+  // 0000 0000 0001 0101: eleven leading zeros, only four more bits
+  put_uint16_be(value, 0x0015);
+  auto b = bit_reader_c{value, 2};
+  EXPECT_THROW(b.get_unsigned_golomb(), mtx::mm_io::end_of_file_x);
+  EXPECT_TRUE(b.eof());
+
+  // 0000 0001 0101 0101: seven leading zeros, 254 + 0x2a
+  put_uint16_be(value, 0x0155);
+  b = bit_reader_c{value, 2};
+  EXPECT_EQ(0x7f + 0x2a, b.get_unsigned_golomb());
+  EXPECT_EQ(1, b.get_remaining_bits());
+  EXPECT_TRUE(b.get_bit());
+  EXPECT_FALSE(b.eof());
+}
+
+TEST(BitReader, SixtyFourBits) {
+  unsigned char value[10];
+  put_uint64_be(&value[0], 0x0123456789abcdefull);
+  put_uint16_be(&value[8], 0xf00f);
+  auto b = bit_reader_c{value, 10};
+
+  EXPECT_EQ(0x0123456789abcdefull, b.peek_bits(64));
+  EXPECT_EQ(0,                     b.get_bit_position());
+  EXPECT_EQ(0x0,                   b.get_bits(4));
+  EXPECT_EQ(0x123456789abcdeff,    b.get_bits(64));
+  EXPECT_EQ(68,                    b.get_bit_position());
+  EXPECT_THROW(b.peek_bits(13), mtx::mm_io::end_of_file_x);
+  EXPECT_EQ(0x00f,                 b.get_bits(12));
+  EXPECT_EQ(0,                     b.get_remaining_bits());
+}
+
 }
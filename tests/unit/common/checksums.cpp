@@ -134,4 +134,35 @@ TEST_F(ChecksumTest, FileChunked1000) {
   EXPECT_EQ(*m_data_md5, *calculate_bin(mtx::checksum::algorithm_e::md5,                       1000));
 }
 
+TEST_F(ChecksumTest, CRCAllInOneEqualsByteByByte) {
+  // Adding a single byte at a time only ever uses the byte-by-byte
+  // code path. Larger buffers use the sliced or hardware-accelerated
+  // code paths. All of them must yield the same results for all
+  // lengths and alignments.
+  auto algorithms = std::vector<mtx::checksum::algorithm_e>{
+    mtx::checksum::algorithm_e::crc8_atm,
+    mtx::checksum::algorithm_e::crc16_ansi,
+    mtx::checksum::algorithm_e::crc16_ccitt,
+    mtx::checksum::algorithm_e::crc32_ieee,
+    mtx::checksum::algorithm_e::crc32_ieee_le,
+  };
+
+  auto data = std::vector<unsigned char>(5000);
+  for (auto idx = 0u; idx < data.size(); ++idx)
+    data[idx] = (idx * 7) ^ (idx >> 5);
+
+  for (auto algorithm : algorithms)
+    for (auto offset : std::vector<size_t>{ 0, 1, 3, 8 })
+      for (auto size : std::vector<size_t>{ 0, 1, 7, 8, 15, 16, 17, 63, 64, 65, 79, 80, 127, 128, 129, 188, 1000, 4096, 4991 }) {
+        auto byte_by_byte = mtx::checksum::for_algorithm(algorithm, 0xffffffff);
+        for (auto idx = 0u; idx < size; ++idx)
+          byte_by_byte->add(&data[offset + idx], 1);
+        byte_by_byte->finish();
+
+        auto expected = dynamic_cast<mtx::checksum::uint_result_c &>(*byte_by_byte).get_result_as_uint();
+
+        EXPECT_EQ(expected, mtx::checksum::calculate_as_uint(algorithm, &data[offset], size, 0xffffffff)) << "algorithm " << static_cast<int>(algorithm) << " offset " << offset << " size " << size;
+      }
+}
+
 }
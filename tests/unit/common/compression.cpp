@@ -0,0 +1,70 @@
+#include "common/common_pch.h"
+
+#include "common/compression.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+memory_cptr
+make_frame(size_t size,
+           unsigned int seed) {
+  auto frame = memory_c::alloc(size);
+  auto data  = frame->get_buffer();
+
+  for (auto idx = 0u; idx < size; ++idx)
+    data[idx] = static_cast<unsigned char>(((idx / 7) * seed) ^ (idx % 13));
+
+  return frame;
+}
+
+TEST(Compression, ZlibRoundTripReusingStreams) {
+  auto compressor = compressor_c::create(COMPRESSION_ZLIB);
+
+  ASSERT_TRUE(!!compressor);
+
+  for (auto size : std::vector<size_t>{ 1, 100, 4000, 4001, 100000, 3 * 1024 * 1024 }) {
+    auto frame        = make_frame(size, size % 251);
+    auto compressed   = compressor->compress(frame->clone());
+    auto decompressed = compressor->decompress(compressed);
+
+    ASSERT_EQ(frame->get_size(), decompressed->get_size());
+    EXPECT_TRUE(*frame == *decompressed);
+  }
+}
+
+TEST(Compression, ZlibLevel) {
+  auto frame = make_frame(100000, 3);
+  auto best  = compressor_c::create(COMPRESSION_ZLIB);
+  auto none  = compressor_c::create(COMPRESSION_ZLIB, 0);
+
+  auto compressed_best = best->compress(frame->clone());
+  auto compressed_none = none->compress(frame->clone());
+
+  EXPECT_LT(compressed_best->get_size(), compressed_none->get_size());
+  EXPECT_GE(compressed_none->get_size(), frame->get_size());
+
+  EXPECT_TRUE(*frame == *best->decompress(compressed_none));
+  EXPECT_TRUE(*frame == *none->decompress(compressed_best));
+}
+
+TEST(Compression, ZlibStrings) {
+  auto compressor = compressor_c::create(COMPRESSION_ZLIB);
+  auto text       = std::string{"Hello, hello, hello, is there anybody in there?"};
+
+  EXPECT_EQ(text, compressor->decompress(compressor->compress(text)));
+  EXPECT_EQ(text, compressor->decompress(compressor->compress(text)));
+}
+
+TEST(Compression, ZlibInvalidData) {
+  auto compressor = compressor_c::create(COMPRESSION_ZLIB);
+  auto garbage    = make_frame(1000, 7);
+
+  EXPECT_THROW(compressor->decompress(garbage), mtx::compression_x);
+
+  // The stream must still be usable afterwards.
+  auto frame = make_frame(1000, 5);
+  EXPECT_TRUE(*frame == *compressor->decompress(compressor->compress(frame->clone())));
+}
+
+}
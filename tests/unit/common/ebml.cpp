@@ -0,0 +1,53 @@
+#include "common/common_pch.h"
+
+#include <ebml/EbmlCrc32.h>
+#include <matroska/KaxInfo.h>
+#include <matroska/KaxInfoData.h>
+
+#include "gtest/gtest.h"
+
+#include "common/ebml.h"
+#include "common/endian.h"
+#include "common/strings/utf8.h"
+
+namespace {
+
+TEST(Ebml, Crc32) {
+  std::string text{"123456789"};
+
+  EXPECT_EQ(0xcbf43926u, calculate_ebml_crc32(reinterpret_cast<unsigned char const *>(text.c_str()), text.size()));
+  EXPECT_EQ(0x00000000u, calculate_ebml_crc32(nullptr, 0));
+}
+
+TEST(Ebml, RenderMasterWithCrc32) {
+  mm_mem_io_c out{nullptr, 0, 1024};
+  out.write(std::string{"0123456789"});
+
+  KaxInfo info;
+  GetChild<KaxTimecodeScale>(info).SetValue(1000000);
+  GetChild<KaxMuxingApp>(info).SetValue(to_utfstring("unit test"));
+  GetChild<KaxWritingApp>(info).SetValue(to_utfstring("unit test"));
+
+  render_ebml_master_with_crc32(out, info, [&info](IOCallback &buffer) { info.Render(buffer, true); });
+
+  ASSERT_TRUE(!!FindChild<EbmlCrc32>(info));
+  EXPECT_EQ(info[0], FindChild<EbmlCrc32>(info));
+  EXPECT_EQ(10u, info.GetElementPosition());
+  EXPECT_EQ(10u + info.ElementSize(true), out.getFilePointer());
+
+  auto content         = out.get_buffer() + 10 + info.HeadSize();
+  auto content_size    = info.GetSize() - ebml_crc32_element_size;
+  auto &timecode_scale = GetChild<KaxTimecodeScale>(info);
+
+  EXPECT_EQ(0xbf, content[0]);
+  EXPECT_EQ(0x84, content[1]);
+  EXPECT_EQ(calculate_ebml_crc32(content + ebml_crc32_element_size, content_size), get_uint32_le(&content[2]));
+  EXPECT_EQ(calculate_ebml_crc32(content + ebml_crc32_element_size, content_size), static_cast<EbmlCrc32 *>(info[0])->GetCrc32());
+
+  // Children must know their positions in 'out', not in the temporary
+  // buffer.
+  EXPECT_EQ(10u + info.HeadSize() + ebml_crc32_element_size, info[1]->GetElementPosition());
+  EXPECT_EQ(0x2a, out.get_buffer()[timecode_scale.GetElementPosition()]);
+}
+
+}
@@ -194,4 +194,22 @@ TEST(Endian, PutUIntXYLE) {
   EXPECT_EQ(0, std::memcmp(buffer, resle8, 8));
 }
 
+TEST(Endian, GetUInt32BEArray) {
+  unsigned char buffer[13] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0xfe, 0xdc, 0xba, 0x98, 0x42 };
+  uint32_t values[4]       = { 0, 0, 0, 0x12345678u };
+
+  get_uint32_be_array(values, buffer, 3);
+
+  EXPECT_EQ(0x01234567u, values[0]);
+  EXPECT_EQ(0x89abcdefu, values[1]);
+  EXPECT_EQ(0xfedcba98u, values[2]);
+  EXPECT_EQ(0x12345678u, values[3]);
+
+  get_uint32_be_array(values, buffer + 1, 1);
+  EXPECT_EQ(0x23456789u, values[0]);
+
+  get_uint32_be_array(values, nullptr, 0);
+  EXPECT_EQ(0x23456789u, values[0]);
+}
+
 }
@@ -0,0 +1,103 @@
+#include "common/common_pch.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(Memory, View) {
+  auto backing = memory_c::clone("0123456789", 10);
+  auto view    = memory_c::view(backing, 2, 5);
+
+  EXPECT_EQ(backing->get_buffer() + 2, view->get_buffer());
+  EXPECT_EQ(5u,                        view->get_size());
+  EXPECT_EQ(std::string{"23456"},      view->to_string());
+  EXPECT_FALSE(view->is_free());
+}
+
+TEST(Memory, ViewKeepsBackingAlive) {
+  auto backing                         = memory_c::clone("0123456789", 10);
+  std::weak_ptr<memory_c> weak_backing = backing;
+  auto view                            = memory_c::view(backing, 4, 3);
+
+  backing.reset();
+
+  EXPECT_FALSE(weak_backing.expired());
+  EXPECT_EQ(std::string{"456"}, view->to_string());
+
+  view.reset();
+
+  EXPECT_TRUE(weak_backing.expired());
+}
+
+TEST(Memory, ResizingViewCopies) {
+  auto backing = memory_c::clone("0123456789", 10);
+  auto view    = memory_c::view(backing, 4, 3);
+
+  view->resize(4);
+  view->get_buffer()[3] = 'x';
+
+  EXPECT_NE(backing->get_buffer() + 4,  view->get_buffer());
+  EXPECT_EQ(std::string{"456x"},        view->to_string());
+  EXPECT_EQ(std::string{"0123456789"}, backing->to_string());
+}
+
+TEST(Memory, PoolSizeClasses) {
+  EXPECT_EQ(32u,              mtx::mem::pool::capacity_for(0));
+  EXPECT_EQ(32u,              mtx::mem::pool::capacity_for(32));
+  EXPECT_EQ(40u,              mtx::mem::pool::capacity_for(33));
+  EXPECT_EQ(1024u,            mtx::mem::pool::capacity_for(1000));
+  EXPECT_EQ(1280u,            mtx::mem::pool::capacity_for(1025));
+  EXPECT_EQ(4u * 1024 * 1024, mtx::mem::pool::capacity_for(4 * 1024 * 1024));
+  EXPECT_EQ(0u,               mtx::mem::pool::capacity_for(4 * 1024 * 1024 + 1));
+}
+
+TEST(Memory, PoolRecyclesBuffers) {
+  auto mem    = memory_c::alloc(1000);
+  auto buffer = mem->get_buffer();
+
+  mem.reset();
+  mem = memory_c::clone(std::string(1010, 'x'));
+
+  EXPECT_EQ(buffer,                 mem->get_buffer());
+  EXPECT_EQ(std::string(1010, 'x'), mem->to_string());
+}
+
+TEST(Memory, PoolAccountingAfterLock) {
+  auto mem         = memory_c::alloc(1000);
+  auto before_lock = mtx::mem::pool::get_bytes_in_use();
+
+  mem->lock();
+  EXPECT_EQ(before_lock - 1024, mtx::mem::pool::get_bytes_in_use());
+
+  auto buffer = mem->get_buffer();
+  mem.reset();
+  free(buffer);
+
+  EXPECT_GT(before_lock - 1024, mtx::mem::pool::get_bytes_in_use());
+}
+
+TEST(Memory, ResizingWithinPoolCapacity) {
+  auto mem    = memory_c::clone("0123456789", 10);
+  auto buffer = mem->get_buffer();
+
+  mem->add(reinterpret_cast<unsigned char const *>("abc"), 3);
+  EXPECT_EQ(buffer,                       mem->get_buffer());
+  EXPECT_EQ(std::string{"0123456789abc"}, mem->to_string());
+
+  mem->resize(1000);
+  EXPECT_EQ(std::string{"0123456789abc"}, mem->to_string().substr(0, 13));
+  EXPECT_EQ(1000u,                        mem->get_size());
+}
+
+TEST(Memory, LockingPooledBuffer) {
+  auto mem    = memory_c::clone("0123456789", 10);
+  auto buffer = mem->get_buffer();
+
+  mem->lock();
+  mem.reset();
+
+  EXPECT_EQ(std::string{"0123456789"}, std::string(reinterpret_cast<char *>(buffer), 10));
+  free(buffer);
+}
+
+}
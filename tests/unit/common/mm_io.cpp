@@ -4,6 +4,10 @@
 #include "tests/unit/util.h"
 
 #include "common/mm_io_x.h"
+#include "common/mm_mmap_io.h"
+#include "common/mm_prefetch_io.h"
+#include "common/mm_probe_buffer_io.h"
+#include "common/mm_write_behind_io.h"
 
 namespace {
 
@@ -16,4 +20,273 @@ TEST(MmIo, Slurp) {
   ASSERT_THROW(mm_file_io_c::slurp("doesnotexist"), mtx::mm_io::exception);
 }
 
+TEST(MmIo, MemoryMapped) {
+  mm_mmap_io_cptr in;
+
+  ASSERT_NO_THROW(in = std::make_shared<mm_mmap_io_c>("tests/unit/data/text/chunky_bacon.txt"));
+  EXPECT_EQ(13, in->get_size());
+
+  std::string buffer;
+  EXPECT_EQ(6u, in->read(buffer, 6));
+  EXPECT_EQ(std::string{"Chunky"}, buffer);
+  EXPECT_EQ(6u, in->getFilePointer());
+
+  auto direct = in->get_direct_pointer(7);
+  ASSERT_NE(nullptr, direct);
+  EXPECT_EQ(std::string{" Bacon\n"}, std::string(reinterpret_cast<char const *>(direct), 7));
+  EXPECT_EQ(nullptr, in->get_direct_pointer(8));
+  EXPECT_EQ(6u, in->getFilePointer());
+
+  EXPECT_FALSE(in->eof());
+  EXPECT_EQ(7u, in->read(buffer, 10));
+  EXPECT_TRUE(in->eof());
+
+  in->setFilePointer(-6, seek_end);
+  EXPECT_FALSE(in->eof());
+  EXPECT_EQ('B', in->read_uint8());
+
+  ASSERT_THROW(mm_mmap_io_c{"doesnotexist"}, mtx::mm_io::exception);
+}
+
+TEST(MmIo, MemoryMappedReadDirect) {
+  mm_mmap_io_c in{"tests/unit/data/text/chunky_bacon.txt"};
+
+  auto size   = size_t{7};
+  auto direct = in.read_direct(size);
+  ASSERT_NE(nullptr, direct);
+  EXPECT_EQ(7u, size);
+  EXPECT_EQ(std::string{"Chunky "}, std::string(reinterpret_cast<char const *>(direct), size));
+  EXPECT_EQ(7u, in.getFilePointer());
+
+  size   = 100;
+  direct = in.read_direct(size);
+  ASSERT_NE(nullptr, direct);
+  EXPECT_EQ(6u, size);
+  EXPECT_EQ(std::string{"Bacon\n"}, std::string(reinterpret_cast<char const *>(direct), size));
+  EXPECT_EQ(13u, in.getFilePointer());
+
+  size = 1;
+  EXPECT_EQ(nullptr, in.read_direct(size));
+  EXPECT_EQ(0u, size);
+  EXPECT_EQ(13u, in.getFilePointer());
+}
+
+TEST(MmIo, Prefetch) {
+  std::vector<unsigned char> content(10000);
+  for (auto idx = 0u; idx < content.size(); ++idx)
+    content[idx] = idx * 7;
+
+  mm_prefetch_io_c in{new mm_mem_io_c{&content[0], content.size()}, 1000, 3};
+  EXPECT_EQ(10000, in.get_size());
+
+  std::vector<unsigned char> buffer(2500);
+  EXPECT_EQ(2500u, in.read(&buffer[0], 2500));
+  EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(), content.begin()));
+  EXPECT_EQ(2500u, in.getFilePointer());
+
+  in.setFilePointer(-2000, seek_current);
+  EXPECT_EQ(content[500], in.read_uint8());
+
+  in.setFilePointer(9000);
+  EXPECT_EQ(1000u, in.read(&buffer[0], 2500));
+  EXPECT_TRUE(std::equal(buffer.begin(), buffer.begin() + 1000, content.begin() + 9000));
+  EXPECT_TRUE(in.eof());
+
+  in.setFilePointer(20000);
+  EXPECT_FALSE(in.eof());
+  EXPECT_EQ(0u, in.read(&buffer[0], 1));
+  EXPECT_TRUE(in.eof());
+
+  in.setFilePointer(1234);
+  EXPECT_EQ(content[1234], in.read_uint8());
+}
+
+TEST(MmIo, WriteBehind) {
+  std::vector<unsigned char> content(2500);
+  for (auto idx = 0u; idx < content.size(); ++idx)
+    content[idx] = idx * 7;
+
+  mm_mem_io_c mem{nullptr, 0, 1000};
+  mm_write_behind_io_c out{&mem, 1000, 2, false};
+
+  EXPECT_EQ(2500u, out.write(&content[0], 2500));
+  EXPECT_EQ(2500u, out.getFilePointer());
+  EXPECT_EQ(2500, out.get_size());
+
+  // Overwrite data that may still be waiting to be written.
+  out.setFilePointer(10);
+  out.write_uint32_be(0x01020304);
+  EXPECT_EQ(14u, out.getFilePointer());
+  std::memcpy(&content[10], "\x01\x02\x03\x04", 4);
+
+  out.setFilePointer(-100, seek_end);
+  EXPECT_EQ(2400u, out.getFilePointer());
+  EXPECT_EQ(150u, out.write(&content[0], 150));
+  EXPECT_EQ(2550, out.get_size());
+  auto tail = std::vector<unsigned char>(content.begin(), content.begin() + 150);
+  content.resize(2400);
+  content.insert(content.end(), tail.begin(), tail.end());
+
+  out.setFilePointer(8);
+  EXPECT_EQ(content[8],  out.read_uint8());
+  EXPECT_EQ(content[9],  out.read_uint8());
+  EXPECT_EQ(0x01020304u, out.read_uint32_be());
+  EXPECT_EQ(14u,         out.getFilePointer());
+
+  out.close();
+
+  ASSERT_EQ(2550, mem.get_size());
+  EXPECT_TRUE(std::equal(content.begin(), content.end(), mem.get_buffer()));
+}
+
+class failing_mem_io_c: public mm_mem_io_c {
+public:
+  failing_mem_io_c()
+    : mm_mem_io_c{nullptr, 0, 1000}
+  {
+  }
+
+protected:
+  virtual size_t _write(const void *, size_t) {
+    return 0;
+  }
+};
+
+class write_behind_io_c: public mm_write_behind_io_c {
+public:
+  write_behind_io_c(mm_io_c *out)
+    : mm_write_behind_io_c{out, 16, 2, false}
+  {
+  }
+
+  void wait_for_failure() {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_cond_caller.wait(lock, [this]() { return !!m_exception; });
+  }
+};
+
+TEST(MmIo, WriteBehindWriteError) {
+  std::vector<unsigned char> content(20, 42);
+  failing_mem_io_c mem;
+
+  {
+    write_behind_io_c out{&mem};
+
+    // The first full buffer is handed over to the writer thread which
+    // fails. The error is reported by the next call while data is
+    // still buffered.
+    EXPECT_EQ(20u, out.write(&content[0], 20));
+    out.wait_for_failure();
+    EXPECT_THROW(out.close(), mtx::mm_io::insufficient_space_x);
+  }
+
+  {
+    write_behind_io_c out{&mem};
+
+    EXPECT_EQ(20u, out.write(&content[0], 20));
+    out.wait_for_failure();
+    EXPECT_THROW(out.flush(), mtx::mm_io::insufficient_space_x);
+  }
+
+  {
+    // Closing and cleaning up must not crash when only the destructor
+    // encounters the error.
+    write_behind_io_c out{&mem};
+
+    EXPECT_EQ(20u, out.write(&content[0], 20));
+    out.wait_for_failure();
+  }
+}
+
+TEST(MmIo, ProbeBuffer) {
+  std::vector<unsigned char> content(3000);
+  for (auto idx = 0u; idx < content.size(); ++idx)
+    content[idx] = idx * 7;
+
+  mm_mem_io_c mem{&content[0], content.size()};
+  mm_probe_buffer_io_c in{&mem, 1000, false};
+  EXPECT_EQ(3000, in.get_size());
+  EXPECT_EQ(1000u, in.get_head_size());
+  EXPECT_EQ(0u, in.getFilePointer());
+
+  std::vector<unsigned char> buffer(1500);
+  EXPECT_EQ(500u, in.read(&buffer[0], 500));
+  EXPECT_TRUE(std::equal(buffer.begin(), buffer.begin() + 500, content.begin()));
+  EXPECT_EQ(0u, in.get_num_bytes_read_through());
+
+  // Partially from the buffer, partially from the file
+  in.setFilePointer(800);
+  EXPECT_EQ(1500u, in.read(&buffer[0], 1500));
+  EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(), content.begin() + 800));
+  EXPECT_EQ(2300u, in.getFilePointer());
+  EXPECT_EQ(1300u, in.get_num_bytes_read_through());
+
+  in.setFilePointer(-100, seek_end);
+  EXPECT_FALSE(in.eof());
+  EXPECT_EQ(100u, in.read(&buffer[0], 1500));
+  EXPECT_TRUE(in.eof());
+
+  in.setFilePointer(10);
+  EXPECT_FALSE(in.eof());
+  EXPECT_EQ(content[10], in.read_uint8());
+  EXPECT_EQ(1400u, in.get_num_bytes_read_through());
+
+  ASSERT_THROW(in.setFilePointer(-20, seek_current), mtx::mm_io::seek_x);
+}
+
+TEST(MmIo, ProbeBufferGrowsOnDemand) {
+  std::vector<unsigned char> content(200000);
+  for (auto idx = 0u; idx < content.size(); ++idx)
+    content[idx] = idx * 7;
+
+  mm_mem_io_c mem{&content[0], content.size()};
+  mm_probe_buffer_io_c in{&mem, 150000, false};
+  EXPECT_EQ(0u, mem.getFilePointer());
+
+  std::vector<unsigned char> buffer(100);
+  EXPECT_EQ(10u, in.read(&buffer[0], 10));
+  EXPECT_EQ(65536u, in.get_head_size());
+
+  // Reaching the end of the buffer grows it.
+  in.setFilePointer(65530);
+  EXPECT_EQ(100u, in.read(&buffer[0], 100));
+  EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(), content.begin() + 65530));
+  EXPECT_EQ(131072u, in.get_head_size());
+  EXPECT_EQ(0u, in.get_num_bytes_read_through());
+
+  // Reads further in don't fill the gap.
+  in.setFilePointer(140000);
+  EXPECT_EQ(100u, in.read(&buffer[0], 100));
+  EXPECT_EQ(131072u, in.get_head_size());
+  EXPECT_EQ(100u, in.get_num_bytes_read_through());
+
+  // Growth is limited by the maximum size.
+  in.setFilePointer(131072);
+  EXPECT_EQ(100u, in.read(&buffer[0], 100));
+  EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(), content.begin() + 131072));
+  EXPECT_EQ(150000u, in.get_head_size());
+  EXPECT_EQ(100u, in.get_num_bytes_read_through());
+}
+
+TEST(MmIo, PositionedMemory) {
+  mm_positioned_mem_io_c out{1000, 16};
+
+  EXPECT_EQ(1000u, out.getFilePointer());
+  EXPECT_EQ(0u,    out.get_content_size());
+
+  out.write(std::string{"Chunky Bacon"});
+  EXPECT_EQ(1012u, out.getFilePointer());
+  EXPECT_EQ(12u,   out.get_content_size());
+
+  out.setFilePointer(1007);
+  out.write(std::string{"Cream"});
+  EXPECT_EQ(1012u, out.getFilePointer());
+  EXPECT_EQ(std::string{"Chunky Cream"}, out.get_content());
+
+  out.setFilePointer(-5, seek_current);
+  EXPECT_EQ(1007u, out.getFilePointer());
+
+  ASSERT_THROW(out.setFilePointer(999), mtx::mm_io::seek_x);
+}
+
 }
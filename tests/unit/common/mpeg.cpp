@@ -0,0 +1,106 @@
+#include "common/common_pch.h"
+
+#include "common/mpeg.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+unsigned char const *
+find_start_code_naively(unsigned char const *begin,
+                        unsigned char const *end) {
+  for (auto ptr = begin; (ptr + 2) < end; ++ptr)
+    if (!ptr[0] && !ptr[1] && (1 == ptr[2]))
+      return ptr;
+
+  return end;
+}
+
+TEST(Mpeg, FindStartCode) {
+  unsigned char buffer[] = { 0x00, 0x00, 0x01, 0x09, 0x00, 0x00, 0x00, 0x01, 0x67, 0x00, 0x00 };
+  auto end               = buffer + sizeof(buffer);
+
+  EXPECT_EQ(buffer,      mtx::mpeg::find_start_code(buffer,     end));
+  EXPECT_EQ(buffer +  5, mtx::mpeg::find_start_code(buffer + 1, end));
+  EXPECT_EQ(end,         mtx::mpeg::find_start_code(buffer + 6, end));
+  EXPECT_EQ(buffer +  2, mtx::mpeg::find_start_code(buffer,     buffer + 2));
+  EXPECT_EQ(end,         mtx::mpeg::find_start_code(end,        end));
+}
+
+TEST(Mpeg, FindStartCodeInLargeBuffers) {
+  std::vector<unsigned char> buffer(1000);
+
+  // Cover every position relative to the vector width as well as the
+  // tail that's handled byte by byte.
+  for (auto idx = 0u; idx < buffer.size(); ++idx)
+    buffer[idx] = (idx % 7) ? 0x00 : 0x02;
+
+  auto begin = &buffer[0];
+  auto end   = begin + buffer.size();
+
+  for (auto pos = 0u; (pos + 2) < buffer.size(); pos += 13) {
+    auto saved      = buffer[pos + 2];
+    buffer[pos + 2] = 0x01;
+
+    for (auto start = 0u; start <= pos; start += 5)
+      EXPECT_EQ(find_start_code_naively(begin + start, end), mtx::mpeg::find_start_code(begin + start, end));
+
+    buffer[pos + 2] = saved;
+  }
+}
+
+TEST(Mpeg, FindByteSequence) {
+  unsigned char buffer[] = { 'B', 'B', 'B', 'C', 'D', 'x', 'B', 'B', 'C', 'D' };
+  auto end               = buffer + sizeof(buffer);
+
+  EXPECT_EQ(buffer + 1, mtx::mpeg::find_byte_sequence(buffer,     end, 'B', 'B', 'C'));
+  EXPECT_EQ(buffer + 6, mtx::mpeg::find_byte_sequence(buffer + 2, end, 'B', 'B', 'C'));
+  EXPECT_EQ(end,        mtx::mpeg::find_byte_sequence(buffer + 7, end, 'B', 'B', 'C'));
+}
+
+TEST(Mpeg, CreateNalusWithSize) {
+  auto extra_data = std::vector<memory_cptr>{ memory_c::clone("\x00\x02" "ab", 4) };
+  auto nalus      = std::vector<memory_cptr>{ memory_c::clone("cde", 3), memory_c::clone("f", 1) };
+  auto frame      = mtx::mpeg::create_nalus_with_size(nalus, 2, extra_data);
+
+  EXPECT_EQ(std::string("\x00\x02" "ab" "\x00\x03" "cde" "\x00\x01" "f", 12), frame->to_string());
+
+  EXPECT_THROW(mtx::mpeg::create_nalus_with_size({ memory_c::alloc(256) }, 1, {}), mtx::mpeg::nalu_size_length_x);
+  EXPECT_NO_THROW(mtx::mpeg::create_nalus_with_size({ memory_c::alloc(256) }, 1, {}, true));
+}
+
+TEST(Mpeg, NaluToRbsp) {
+  auto nalu = memory_c::clone(std::string("\x65\x00\x00\x03\x01\x00\x00\x03\x00\x00\x00\x03", 12));
+
+  EXPECT_EQ(std::string("\x65\x00\x00\x01\x00\x00\x00\x00\x00", 9), mtx::mpeg::nalu_to_rbsp(nalu)->to_string());
+  EXPECT_EQ(std::string("\x65\x00\x00\x01",                     4), mtx::mpeg::nalu_to_rbsp(nalu, 4)->to_string());
+
+  unsigned char dest[5];
+  EXPECT_EQ(5u, mtx::mpeg::nalu_to_rbsp(nalu->get_buffer(), nalu->get_size(), dest, sizeof(dest)));
+  EXPECT_EQ(std::string("\x65\x00\x00\x01\x00", 5), std::string(reinterpret_cast<char *>(dest), sizeof(dest)));
+}
+
+TEST(Mpeg, NaluToRbspTruncatedBeforeMarker) {
+  auto nalu = std::string("\x65\x11\x22\x00\x00\x03\x01\x00\x00\x03\x02", 11);
+  auto src  = reinterpret_cast<unsigned char const *>(nalu.c_str());
+  auto rbsp = std::string("\x65\x11\x22\x00\x00\x01\x00\x00\x02", 9);
+
+  // The marker starts right after, at, or before the last byte fitting
+  // into the destination.
+  for (auto dest_size = 1u; dest_size <= rbsp.size(); ++dest_size) {
+    unsigned char dest[9];
+    std::memset(dest, 0xff, sizeof(dest));
+
+    EXPECT_EQ(dest_size, mtx::mpeg::nalu_to_rbsp(src, nalu.size(), dest, dest_size));
+    EXPECT_EQ(rbsp.substr(0, dest_size), std::string(reinterpret_cast<char *>(dest), dest_size)) << "dest_size " << dest_size;
+  }
+}
+
+TEST(Mpeg, RbspToNalu) {
+  auto rbsp = memory_c::clone(std::string("\x65\x00\x00\x01\x00\x00\x00\x00\x00", 9));
+
+  EXPECT_EQ(std::string("\x65\x00\x00\x03\x01\x00\x00\x03\x00\x00\x03\x00", 12), mtx::mpeg::rbsp_to_nalu(rbsp)->to_string());
+  EXPECT_EQ(*rbsp, *mtx::mpeg::nalu_to_rbsp(mtx::mpeg::rbsp_to_nalu(rbsp)));
+}
+
+}
@@ -0,0 +1,99 @@
+#include "common/common_pch.h"
+
+#include "merge/cues.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+class test_cues_c: public cues_c {
+public:
+  using cues_c::sort;
+};
+
+TEST(Cues, AddAndRetrieve) {
+  test_cues_c cues;
+
+  cues.add({ 1000000000, 0,        4711, 0,    1, 12 });
+  cues.add({ 1000000000, 40000000, 4711, 8150, 2, 34 });
+  cues.add({ 2000000000, 0,        9000, 0,    1, 0  });
+
+  ASSERT_EQ(3u, cues.get_num_points());
+
+  auto point = cues.get_point(1);
+  EXPECT_EQ(1000000000u, point.timecode);
+  EXPECT_EQ(40000000u,   point.duration);
+  EXPECT_EQ(4711u,       point.cluster_position);
+  EXPECT_EQ(8150u,       point.codec_state_position);
+  EXPECT_EQ(2u,          point.track_num);
+  EXPECT_EQ(34u,         point.relative_position);
+
+  point = cues.get_point(0);
+  EXPECT_EQ(0u,          point.duration);
+  EXPECT_EQ(0u,          point.codec_state_position);
+
+  point = cues.get_point(2);
+  EXPECT_EQ(2000000000u, point.timecode);
+  EXPECT_EQ(9000u,       point.cluster_position);
+}
+
+TEST(Cues, Sort) {
+  test_cues_c cues;
+
+  cues.add({ 2000000000, 0,        200, 0,   1, 5 });
+  cues.add({ 1000000000, 0,        100, 0,   2, 6 });
+  cues.add({ 1000000000, 20000000, 100, 150, 1, 7 });
+
+  cues.sort();
+
+  ASSERT_EQ(3u, cues.get_num_points());
+
+  EXPECT_EQ(1000000000u, cues.get_point(0).timecode);
+  EXPECT_EQ(1u,          cues.get_point(0).track_num);
+  EXPECT_EQ(20000000u,   cues.get_point(0).duration);
+  EXPECT_EQ(150u,        cues.get_point(0).codec_state_position);
+  EXPECT_EQ(7u,          cues.get_point(0).relative_position);
+
+  EXPECT_EQ(2u,          cues.get_point(1).track_num);
+  EXPECT_EQ(100u,        cues.get_point(1).cluster_position);
+  EXPECT_EQ(0u,          cues.get_point(1).duration);
+
+  EXPECT_EQ(2000000000u, cues.get_point(2).timecode);
+  EXPECT_EQ(200u,        cues.get_point(2).cluster_position);
+  EXPECT_EQ(5u,          cues.get_point(2).relative_position);
+}
+
+TEST(Cues, ElementSize) {
+  test_cues_c cues;
+
+  EXPECT_EQ(0u, cues.calculate_element_size());
+
+  for (auto idx = 0u; idx < 1000; ++idx)
+    cues.add({ idx * 1000000000ull, 0, 1000 + idx * 500000ull, 0, 1, idx * 1000u });
+
+  // Each point: CuePoint (2), CueTime (2 + 1..3), CueTrackPositions
+  // (2), CueTrack (2 + 1), CueClusterPosition (2 + 2..4) and
+  // CueRelativePosition (2 + 1..3) except for the first one.
+  auto element_size = cues.calculate_element_size();
+  EXPECT_GT(element_size, 1000u * 18);
+  EXPECT_LE(element_size, 1000u * 23 + 12);
+
+  EXPECT_GE(cues_c::estimate_element_size(1000, 1000ull * 1000000000, 500000000), element_size);
+  EXPECT_EQ(0u, cues_c::estimate_element_size(0, 1000ull * 1000000000, 500000000));
+}
+
+TEST(Cues, AdjustPositions) {
+  test_cues_c cues;
+
+  cues.add({ 1000000000, 0, 100, 0,   1, 0 });
+  cues.add({ 2000000000, 0, 300, 350, 1, 0 });
+
+  cues.adjust_positions(200, 50);
+
+  EXPECT_EQ(100u, cues.get_point(0).cluster_position);
+  EXPECT_EQ(0u,   cues.get_point(0).codec_state_position);
+  EXPECT_EQ(350u, cues.get_point(1).cluster_position);
+  EXPECT_EQ(400u, cues.get_point(1).codec_state_position);
+}
+
+}
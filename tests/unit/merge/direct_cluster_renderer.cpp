@@ -0,0 +1,197 @@
+#include "common/common_pch.h"
+
+#include <matroska/KaxCues.h>
+#include <matroska/KaxSegment.h>
+#include <matroska/KaxTrackEntryData.h>
+#include <matroska/KaxTracks.h>
+
+#include "gtest/gtest.h"
+
+#include "common/ebml.h"
+#include "common/mm_io.h"
+#include "merge/cues.h"
+#include "merge/direct_cluster_renderer.h"
+#include "merge/libmatroska_extensions.h"
+
+namespace {
+
+int64_t const s_timecode_scale = 1000000;
+
+class DirectClusterRenderer: public ::testing::Test {
+public:
+  struct block_t {
+    KaxTrackEntry *track;
+    int64_t timecode, past_block, forw_block, duration;
+    bool block_group;
+    int64_t cue_duration;
+    memory_cptr data;
+  };
+
+  KaxSegment m_segment;
+  KaxTrackEntry m_video_track, m_audio_track;
+  std::vector<block_t> m_blocks;
+
+  DirectClusterRenderer() {
+    GetChild<KaxTrackNumber>(m_video_track).SetValue(1);
+    m_video_track.EnableLacing(false);
+    m_video_track.SetGlobalTimecodeScale(s_timecode_scale);
+
+    GetChild<KaxTrackNumber>(m_audio_track).SetValue(2);
+    m_audio_track.EnableLacing(true);
+    m_audio_track.SetGlobalTimecodeScale(s_timecode_scale);
+  }
+
+  void
+  add(KaxTrackEntry &track,
+      int64_t timecode_ms,
+      size_t size,
+      int64_t past_block_ms,
+      int64_t forw_block_ms,
+      bool block_group,
+      int64_t duration_ms,
+      int64_t cue_duration_ms) {
+    auto data = memory_c::alloc(size);
+    for (auto idx = 0u; idx < size; ++idx)
+      data->get_buffer()[idx] = (m_blocks.size() + idx) & 0xff;
+
+    auto to_ns = [](int64_t ms) { return -1 == ms ? ms : ms * s_timecode_scale; };
+
+    m_blocks.push_back({ &track, to_ns(timecode_ms), to_ns(past_block_ms), to_ns(forw_block_ms), to_ns(duration_ms), block_group, to_ns(cue_duration_ms), data });
+  }
+
+  void
+  prepare_cluster(kax_cluster_c &cluster) {
+    auto min_timecode = std::numeric_limits<int64_t>::max();
+    auto max_timecode = int64_t{};
+
+    for (auto const &block : m_blocks) {
+      min_timecode = std::min(block.timecode, min_timecode);
+      max_timecode = std::max(block.timecode, max_timecode);
+    }
+
+    cluster.SetParent(m_segment);
+    cluster.SetPreviousTimecode(min_timecode - 1, s_timecode_scale);
+    cluster.set_min_timecode(min_timecode);
+    cluster.set_max_timecode(max_timecode);
+  }
+
+  // The same steps cluster_helper_c::render() takes for blocks with a
+  // single frame each.
+  std::string
+  render_with_libmatroska(bool write_crc32,
+                          std::vector<cue_point_t> &cue_points) {
+    mm_mem_io_c out{nullptr, 0, 1024};
+    out.write(std::string{"0123456789"});
+
+    kax_cluster_c cluster;
+    KaxCues no_cues;
+    std::vector<kax_block_blob_cptr> blobs;
+    std::vector<std::pair<kax_block_blob_c *, int64_t>> cue_blobs;
+
+    prepare_cluster(cluster);
+
+    for (auto const &block : m_blocks) {
+      blobs.push_back(kax_block_blob_cptr(new kax_block_blob_c(block.block_group ? BLOCK_BLOB_NO_SIMPLE : BLOCK_BLOB_ALWAYS_SIMPLE)));
+      auto &blob = *blobs.back();
+
+      cluster.AddBlockBlob(&blob);
+      blob.SetParent(cluster);
+      blob.add_frame_auto(*block.track, block.timecode, *new DataBuffer(block.data->get_buffer(), block.data->get_size()), LACING_AUTO, block.past_block, block.forw_block);
+
+      if (-1 != block.duration)
+        blob.set_block_duration(block.duration);
+
+      if (-1 != block.cue_duration)
+        cue_blobs.emplace_back(&blob, block.cue_duration);
+    }
+
+    if (write_crc32)
+      render_ebml_master_with_crc32(out, cluster, [&cluster, &no_cues](IOCallback &buffer) { cluster.Render(buffer, no_cues); });
+    else
+      cluster.Render(out, no_cues);
+
+    cue_points = create_cue_points_for_block_blobs(m_segment, cluster, cue_blobs);
+
+    cluster.delete_non_blocks();
+
+    return out.get_content();
+  }
+
+  std::string
+  render_directly(bool write_crc32,
+                  std::vector<cue_point_t> &cue_points) {
+    mm_mem_io_c out{nullptr, 0, 1024};
+    out.write(std::string{"0123456789"});
+
+    kax_cluster_c cluster;
+    direct_cluster_renderer_c renderer{cluster};
+
+    prepare_cluster(cluster);
+
+    for (auto const &block : m_blocks) {
+      if (block.block_group)
+        renderer.add_block_group(*block.track, block.timecode, block.data, block.past_block, block.forw_block, block.duration);
+      else
+        renderer.add_simple_block(*block.track, block.timecode, block.data, block.past_block, block.forw_block);
+
+      if (-1 != block.cue_duration)
+        renderer.add_cue_point(block.cue_duration);
+    }
+
+    cue_points = renderer.render(out, m_segment, write_crc32);
+
+    EXPECT_EQ(out.getFilePointer(), cluster.GetElementPosition() + cluster.ElementSize());
+
+    cluster.delete_non_blocks();
+
+    return out.get_content();
+  }
+
+  void
+  compare(bool write_crc32) {
+    std::vector<cue_point_t> libmatroska_cue_points, direct_cue_points;
+
+    auto libmatroska_content = render_with_libmatroska(write_crc32, libmatroska_cue_points);
+    auto direct_content      = render_directly(write_crc32, direct_cue_points);
+
+    EXPECT_EQ(libmatroska_content, direct_content);
+
+    ASSERT_EQ(libmatroska_cue_points.size(), direct_cue_points.size());
+
+    for (auto idx = 0u; idx < direct_cue_points.size(); ++idx) {
+      EXPECT_EQ(libmatroska_cue_points[idx].timecode,             direct_cue_points[idx].timecode);
+      EXPECT_EQ(libmatroska_cue_points[idx].duration,             direct_cue_points[idx].duration);
+      EXPECT_EQ(libmatroska_cue_points[idx].cluster_position,     direct_cue_points[idx].cluster_position);
+      EXPECT_EQ(libmatroska_cue_points[idx].codec_state_position, direct_cue_points[idx].codec_state_position);
+      EXPECT_EQ(libmatroska_cue_points[idx].track_num,            direct_cue_points[idx].track_num);
+      EXPECT_EQ(libmatroska_cue_points[idx].relative_position,    direct_cue_points[idx].relative_position);
+    }
+  }
+};
+
+TEST_F(DirectClusterRenderer, SimpleBlocks) {
+  add(m_video_track, 10000,   200,    -1,    -1, false, -1,  0);
+  add(m_audio_track, 10000,    50,    -1,    -1, false, -1, 24);
+  add(m_audio_track, 10024,    60,    -1,    -1, false, -1, -1);
+  add(m_video_track, 10120, 20000, 10000,    -1, false, -1, -1);
+  add(m_video_track, 10040,   100, 10000, 10120, false, -1, -1);
+  add(m_video_track, 10080,     1, 10000, 10120, false, -1,  0);
+
+  compare(false);
+  compare(true);
+}
+
+TEST_F(DirectClusterRenderer, BlockGroups) {
+  add(m_video_track, 10000,   200,    -1,    -1, true,  40,   0);
+  add(m_audio_track, 10000,    50,    -1,    -1, true,  -1,  24);
+  add(m_audio_track, 10024,   126,    -1,    -1, true,   0,  -1);
+  add(m_video_track, 10120,   127, 10000,    -1, true, 300,  -1);
+  add(m_video_track, 10040, 16384, 10000, 10120, true,  40,  -1);
+  add(m_video_track, 10080,     1,  9700, 10120, true,  -1,  40);
+  add(m_audio_track, 10048,    50,    -1,    -1, false, -1,   0);
+
+  compare(false);
+  compare(true);
+}
+
+}